@@ -0,0 +1,89 @@
+/**
+ * Tests getMore on find cursors with internalQueryGetMorePrefetch enabled: batches keep their
+ * order and size, a prefetch failure is reported by the next getMore with its own error code, and
+ * killCursors interrupts a running prefetch rather than waiting for it.
+ */
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({setParameter: {internalQueryGetMorePrefetch: true}});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    const testDB = conn.getDB("test");
+    const coll = testDB.getmore_prefetch;
+    const kNumDocs = 100;
+
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < kNumDocs; ++i) {
+        bulk.insert({_id: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    function prefetchedBatches() {
+        return testDB.serverStatus().metrics.cursor.prefetch.batches;
+    }
+
+    function setFailPoint(name, mode) {
+        assert.commandWorked(testDB.adminCommand({configureFailPoint: name, mode: mode}));
+    }
+
+    // Every getMore returns the next documents in order, and no more than its own batchSize, even
+    // when the batch prefetched for it was read with a different one.
+    const batchesBefore = prefetchedBatches();
+    let res = assert.commandWorked(
+        testDB.runCommand({find: coll.getName(), sort: {_id: 1}, batchSize: 4}));
+    const cursorId = res.cursor.id;
+    let nextId = res.cursor.firstBatch.length;
+    assert.eq(4, nextId);
+
+    const batchSizes = [3, 10, 1, 25, 7];
+    for (let i = 0; nextId < kNumDocs; ++i) {
+        const batchSize = batchSizes[i % batchSizes.length];
+        res = assert.commandWorked(testDB.runCommand(
+            {getMore: cursorId, collection: coll.getName(), batchSize: batchSize}));
+        const batch = res.cursor.nextBatch;
+        assert.eq(Math.min(batchSize, kNumDocs - nextId), batch.length, tojson(res));
+        for (let doc of batch) {
+            assert.eq(nextId++, doc._id, tojson(res));
+        }
+    }
+    assert.eq(0, res.cursor.id);
+    assert.gt(prefetchedBatches(), batchesBefore);
+
+    // A prefetch that runs out of the cursor's maxTimeMS fails the next getMore with
+    // ExceededTimeLimit, not with an error of its own.
+    res = assert.commandWorked(testDB.runCommand(
+        {find: coll.getName(), sort: {_id: 1}, batchSize: 2, maxTimeMS: 10 * 60 * 1000}));
+    const timedCursorId = res.cursor.id;
+    setFailPoint("hangBeforeGetMorePrefetch", "alwaysOn");
+    assert.commandWorked(
+        testDB.runCommand({getMore: timedCursorId, collection: coll.getName(), batchSize: 2}));
+    setFailPoint("maxTimeAlwaysTimeOut", "alwaysOn");
+    setFailPoint("hangBeforeGetMorePrefetch", "off");
+    assert.commandFailedWithCode(
+        testDB.runCommand({getMore: timedCursorId, collection: coll.getName(), batchSize: 2}),
+        ErrorCodes.ExceededTimeLimit);
+    setFailPoint("maxTimeAlwaysTimeOut", "off");
+
+    // The failed prefetch killed the cursor.
+    assert.commandFailedWithCode(
+        testDB.runCommand({getMore: timedCursorId, collection: coll.getName()}),
+        ErrorCodes.CursorNotFound);
+
+    // killCursors interrupts a prefetch which holds the cursor.
+    res = assert.commandWorked(
+        testDB.runCommand({find: coll.getName(), sort: {_id: 1}, batchSize: 2}));
+    const killedCursorId = res.cursor.id;
+    setFailPoint("hangBeforeGetMorePrefetch", "alwaysOn");
+    assert.commandWorked(
+        testDB.runCommand({getMore: killedCursorId, collection: coll.getName(), batchSize: 2}));
+    res = assert.commandWorked(
+        testDB.runCommand({killCursors: coll.getName(), cursors: [killedCursorId]}));
+    assert.eq([killedCursorId], res.cursorsKilled, tojson(res));
+    setFailPoint("hangBeforeGetMorePrefetch", "off");
+    assert.commandFailedWithCode(
+        testDB.runCommand({getMore: killedCursorId, collection: coll.getName()}),
+        ErrorCodes.CursorNotFound);
+
+    MongoRunner.stopMongod(conn);
+}());
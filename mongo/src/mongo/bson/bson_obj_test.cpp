@@ -640,6 +640,38 @@ TEST(BSONObj, getFieldsWithDuplicates) {
     ASSERT_EQUALS(fields[1].str(), "3");
 }
 
+TEST(BSONObj, getFieldsByCStringReturnsFirstOccurrences) {
+    auto e = BSON("a" << 1 << "a_field_name_longer_than_a_vector" << 2 << "b" << 3 << "a" << 4
+                      << "a_field_name_longer_than_a_vector"
+                      << 5);
+    const char* fieldNames[] = {"a_field_name_longer_than_a_vector", "a", "c"};
+    BSONElement fields[3];
+    e.getFields(3, fieldNames, fields);
+    ASSERT_EQUALS(fields[0].numberInt(), 2);
+    ASSERT_EQUALS(fields[1].numberInt(), 1);
+    ASSERT_TRUE(fields[2].eoo());
+}
+
+TEST(BSONObj, IteratorStepsOverEOOInTheMiddleOfAnObject) {
+    // An object which was not validated, with an EOO before its only field: {<EOO>, a: 1}.
+    const BSONObj field = BSON("a" << 1);
+    const int fieldSize = field.objsize() - 5;
+    std::vector<char> buffer(4);
+    buffer.push_back(EOO);
+    buffer.insert(buffer.end(), field.objdata() + 4, field.objdata() + 4 + fieldSize);
+    buffer.push_back(EOO);
+    const int size = buffer.size();
+    memcpy(buffer.data(), &size, sizeof(size));
+    const BSONObj obj(buffer.data());
+
+    BSONObjIterator it(obj);
+    ASSERT(it.more());
+    ASSERT(it.next().eoo());
+    ASSERT(it.more());
+    ASSERT_EQ(it.next().numberInt(), 1);
+    ASSERT_FALSE(it.more());
+}
+
 TEST(BSONObj, ShareOwnershipWith) {
     BSONObj obj;
     {
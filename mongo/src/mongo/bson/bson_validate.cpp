@@ -35,6 +35,7 @@
 #include "mongo/bson/bson_depth.h"
 #include "mongo/bson/bson_validate.h"
 #include "mongo/bson/oid.h"
+#include "mongo/bson/util/simd_scan.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/platform/decimal128.h"
@@ -89,10 +90,11 @@ public:
      * reading, if it exists. Otherwise, it should be empty.
      */
     Status readCString(StringData elemName, StringData* out) {
-        const void* x = memchr(_buffer + _position, 0, _maxLength - _position);
-        if (!x)
+        const char* const end = _buffer + _maxLength;
+        const char* x = findNulTerminator(_buffer + _position, end);
+        if (x == end)
             return makeError("no end of c-string", _idElem, elemName);
-        uint64_t len = static_cast<uint64_t>(static_cast<const char*>(x) - (_buffer + _position));
+        uint64_t len = static_cast<uint64_t>(x - (_buffer + _position));
 
         StringData data(_buffer + _position, len);
         _position += len + 1;
@@ -43,6 +43,7 @@
 #include "mongo/bson/bsontypes.h"
 #include "mongo/bson/oid.h"
 #include "mongo/bson/timestamp.h"
+#include "mongo/bson/util/simd_scan.h"
 #include "mongo/config.h"
 #include "mongo/platform/decimal128.h"
 #include "mongo/platform/strnlen.h"
@@ -661,7 +662,7 @@ public:
             totalSize = -1;
             fieldNameSize_ = -1;
             if (maxLen != -1) {
-                size_t size = strnlen(fieldName(), maxLen - 1);
+                size_t size = findNulTerminator(fieldName(), data + maxLen) - fieldName();
                 uassert(10333, "Invalid field name", size < size_t(maxLen - 1));
                 fieldNameSize_ = size + 1;
             }
@@ -459,13 +459,21 @@ void BSONObj::dump() const {
 }
 
 void BSONObj::getFields(unsigned n, const char** fieldNames, BSONElement* fields) const {
-    BSONObjIterator i(*this);
-    while (i.more()) {
-        BSONElement e = i.next();
-        const char* p = e.fieldName();
+    // Track which names were found, so that the scan stops as soon as all of them were. More names
+    // than bits in 'found' are looked for until the end of the object.
+    const unsigned kMaxTrackedFields = 64;
+    const uint64_t allFound = n >= kMaxTrackedFields ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+    uint64_t found = 0;
+
+    BSONObjIterator it(*this);
+    while (it.more() && (n > kMaxTrackedFields || found != allFound)) {
+        BSONElement e = it.next();
+        const StringData name = e.fieldNameStringData();
         for (unsigned i = 0; i < n; i++) {
-            if (strcmp(p, fieldNames[i]) == 0) {
+            const uint64_t bit = i < kMaxTrackedFields ? uint64_t(1) << i : 0;
+            if (!(found & bit) && name == fieldNames[i]) {
                 fields[i] = e;
+                found |= bit;
                 break;
             }
         }
@@ -650,7 +650,18 @@ public:
 
     BSONElement next() {
         verify(_pos <= _theend);
-        BSONElement e(_pos);
+        if (*_pos == EOO) {
+            // Step over an EOO in the middle of an object which was not validated, like
+            // BSONElement::size() does, so that iterating over it still ends.
+            return BSONElement(_pos++);
+        }
+
+        // Find the end of the field name within the object, rather than with strlen() when
+        // computing the size of the element.
+        const char* fieldNameEnd = findNulTerminator(_pos + 1, _theend);
+        BSONElement e(_pos,
+                      fieldNameEnd == _theend ? -1 : static_cast<int>(fieldNameEnd - _pos),
+                      BSONElement::FieldNameSizeTag());
         _pos += e.size();
         return e;
     }
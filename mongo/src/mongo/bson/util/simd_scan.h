@@ -0,0 +1,71 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// TODO replace this with #if BOOST_HW_SIMD_X86 >= BOOST_HW_SIMD_X86_SSE2_VERSION in boost 1.60
+#if defined(_M_AMD64) || defined(__amd64__)
+#include <emmintrin.h>
+#define MONGO_HAVE_SSE2_NUL_SCAN
+#endif
+
+#include "mongo/platform/bits.h"
+
+namespace mongo {
+
+/**
+ * Returns a pointer to the first NUL byte in [begin, end), or 'end' if there is none. Never reads
+ * outside of [begin, end).
+ *
+ * Used to find the end of the field names of BSON elements, which are rarely longer than a single
+ * vector, so this is inlined rather than a call to memchr().
+ */
+inline const char* findNulTerminator(const char* begin, const char* end) {
+#if defined(MONGO_HAVE_SSE2_NUL_SCAN)
+    const __m128i zero = _mm_setzero_si128();
+    while (end - begin >= static_cast<std::ptrdiff_t>(sizeof(__m128i))) {
+        // _mm_loadu_si128 accepts unaligned pointers.
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        const uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero));
+        if (mask) {
+            return begin + countTrailingZeros64(mask);
+        }
+        begin += sizeof(__m128i);
+    }
+#endif
+
+    while (begin < end && *begin) {
+        ++begin;
+    }
+    return begin;
+}
+
+}  // namespace mongo
@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/bson/util/simd_scan.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(FindNulTerminator, FindsFirstNulAtEveryPosition) {
+    for (size_t length = 1; length < 70; length++) {
+        for (size_t nulPos = 0; nulPos < length; nulPos++) {
+            std::string buf(length, 'x');
+            buf[nulPos] = '\0';
+            if (nulPos + 1 < length) {
+                buf[length - 1] = '\0';
+            }
+            const char* begin = buf.data();
+            ASSERT_EQ(findNulTerminator(begin, begin + length), begin + nulPos);
+        }
+    }
+}
+
+TEST(FindNulTerminator, ReturnsEndIfThereIsNoNul) {
+    for (size_t length = 0; length < 70; length++) {
+        // The byte at 'end' is a NUL which must not be found.
+        std::string buf(length, 'x');
+        const char* begin = buf.c_str();
+        ASSERT_EQ(findNulTerminator(begin, begin + length), begin + length);
+    }
+}
+
+TEST(FindNulTerminator, FindsNulInUnalignedRange) {
+    std::string buf(64, 'x');
+    buf[40] = '\0';
+    for (size_t offset = 0; offset <= 40; offset++) {
+        const char* begin = buf.data() + offset;
+        ASSERT_EQ(findNulTerminator(begin, buf.data() + buf.size()), buf.data() + 40);
+    }
+}
+
+}  // namespace
+}  // namespace mongo
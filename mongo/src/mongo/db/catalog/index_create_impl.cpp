@@ -32,6 +32,8 @@
 
 #include "mongo/db/catalog/index_create_impl.h"
 
+#include <deque>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/base/init.h"
 #include "mongo/client/dbclientinterface.h"
@@ -47,8 +49,10 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -122,6 +126,180 @@ public:
 
 } exportedMaxIndexBuildMemoryUsageParameter;
 
+/**
+ * Number of threads generating index keys during a foreground index build. The collection is
+ * always scanned on the thread running the build.
+ */
+AtomicInt32 maxIndexBuildThreads(1);
+
+class ExportedMaxIndexBuildThreadsParameter
+    : public ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedMaxIndexBuildThreadsParameter()
+        : ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(), "maxIndexBuildThreads", &maxIndexBuildThreads) {}
+
+    virtual Status validate(const std::int32_t& potentialNewValue) {
+        if (potentialNewValue < 1 || potentialNewValue > 64) {
+            return Status(ErrorCodes::BadValue, "maxIndexBuildThreads must be between 1 and 64");
+        }
+
+        return Status::OK();
+    }
+
+} exportedMaxIndexBuildThreadsParameter;
+
+/**
+ * Generates the index keys of a foreground index build on several threads. The collection scan
+ * stays on the thread running the build, which hands the documents over in batches. Each worker
+ * thread inserts the keys it generates into its own partition of every index's BulkBuilder, so
+ * the workers never share a Sorter. The sorted partitions are merged when the bulk builds are
+ * committed in doneInserting().
+ */
+class MultiIndexBlockImpl::ParallelKeyGenerator {
+    MONGO_DISALLOW_COPYING(ParallelKeyGenerator);
+
+public:
+    ParallelKeyGenerator(std::vector<IndexToBuild>* indexes, size_t numThreads)
+        : _indexes(indexes) {
+        for (size_t i = 0; i < numThreads; i++) {
+            _workers.emplace_back([this, i] { _workerLoop(i); });
+        }
+    }
+
+    ~ParallelKeyGenerator() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _done = true;
+        }
+        _notEmpty.notify_all();
+        for (auto&& worker : _workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * Queues the document to have its keys generated. Blocks while the queue is full. Returns the
+     * error of a worker thread if any failed to generate keys.
+     */
+    Status insert(const BSONObj& doc, const RecordId& loc) {
+        _batch.emplace_back(doc.getOwned(), loc);
+        _batchBytes += doc.objsize();
+        if (_batch.size() < kMaxBatchDocs && _batchBytes < kMaxBatchBytes) {
+            return Status::OK();
+        }
+        return _flush();
+    }
+
+    /**
+     * Waits until the keys of all queued documents have been generated. Returns the first error
+     * encountered by a worker thread.
+     */
+    Status finish() {
+        Status status = _flush();
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _done = true;
+        }
+        _notEmpty.notify_all();
+        for (auto&& worker : _workers) {
+            worker.join();
+        }
+        _workers.clear();
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return status.isOK() ? _status : status;
+    }
+
+private:
+    using Batch = std::vector<std::pair<BSONObj, RecordId>>;
+
+    static const size_t kMaxBatchDocs = 1000;
+    static const size_t kMaxBatchBytes = 16 * 1024 * 1024;
+
+    Status _flush() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _notFull.wait(lk, [&] { return !_status.isOK() || _queue.size() < 2 * _workers.size(); });
+        if (!_status.isOK()) {
+            return _status;
+        }
+
+        if (!_batch.empty()) {
+            _queue.push_back(std::move(_batch));
+            _batch = Batch();
+            _batchBytes = 0;
+            _notEmpty.notify_one();
+        }
+        return Status::OK();
+    }
+
+    void _workerLoop(size_t partition) {
+        Client::initThread("indexBuildKeyGenerator");
+        auto opCtx = cc().makeOperationContext();
+
+        while (true) {
+            Batch batch;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _notEmpty.wait(lk, [&] { return _done || !_queue.empty(); });
+                if (_queue.empty() || !_status.isOK()) {
+                    return;
+                }
+                batch = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            _notFull.notify_one();
+
+            Status status = _generateKeys(opCtx.get(), batch, partition);
+            if (!status.isOK()) {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                if (_status.isOK()) {
+                    _status = status;
+                }
+                _notFull.notify_all();
+                return;
+            }
+        }
+    }
+
+    Status _generateKeys(OperationContext* opCtx, const Batch& batch, size_t partition) {
+        try {
+            for (auto&& doc : batch) {
+                for (auto&& index : *_indexes) {
+                    if (index.filterExpression && !index.filterExpression->matchesBSON(doc.first)) {
+                        continue;
+                    }
+
+                    int64_t unused;
+                    Status status = index.bulkPartitions[partition]->insert(
+                        opCtx, doc.first, doc.second, index.options, &unused);
+                    if (!status.isOK()) {
+                        return status;
+                    }
+                }
+            }
+        } catch (const DBException& e) {
+            return e.toStatus();
+        }
+        return Status::OK();
+    }
+
+    std::vector<IndexToBuild>* const _indexes;
+
+    // Only accessed by the thread running the index build.
+    Batch _batch;
+    size_t _batchBytes = 0;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _notEmpty;
+    stdx::condition_variable _notFull;
+    std::deque<Batch> _queue;
+    bool _done = false;
+    Status _status = Status::OK();
+
+    std::vector<stdx::thread> _workers;
+};
+
 
 /**
  * On rollback sets MultiIndexBlockImpl::_needToCleanup to true.
@@ -333,6 +511,7 @@ db.things.ensureIndex({name:1}, {background:true});
             static_cast<std::size_t>(maxIndexBuildMemoryUsageMegabytes.load()) * 1024 * 1024 /
             indexSpecs.size();
     }
+    _eachIndexBuildMaxMemoryUsageBytes = eachIndexBuildMaxMemoryUsageBytes;
 
     for (size_t i = 0; i < indexSpecs.size(); i++) {
         BSONObj info = indexSpecs[i];
@@ -462,6 +641,24 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
         yieldPolicy = PlanExecutor::WRITE_CONFLICT_RETRY_ONLY;
     }
 
+    // A foreground build only inserts into the BulkBuilders while scanning, so the key generation
+    // can be moved off this thread. Each index gets one BulkBuilder per thread, which share the
+    // memory budget of the index.
+    std::unique_ptr<ParallelKeyGenerator> keyGenerator;
+    const size_t numKeyGeneratorThreads = maxIndexBuildThreads.load();
+    if (!_buildInBackground && numKeyGeneratorThreads > 1 && !_indexes.empty()) {
+        for (auto&& index : _indexes) {
+            invariant(index.bulk);
+            index.bulk.reset();
+            for (size_t i = 0; i < numKeyGeneratorThreads; i++) {
+                index.bulkPartitions.push_back(index.real->initiateBulk(
+                    _eachIndexBuildMaxMemoryUsageBytes / numKeyGeneratorThreads));
+            }
+        }
+        keyGenerator = stdx::make_unique<ParallelKeyGenerator>(&_indexes, numKeyGeneratorThreads);
+        log() << "\t generating index keys on " << numKeyGeneratorThreads << " threads";
+    }
+
 	//ɼӦPlanExecutorҲCollectionScan
     auto exec =
         InternalPlanner::collectionScan(_opCtx, _collection->ns().ns(), _collection, yieldPolicy);
@@ -503,7 +700,8 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
 
             WriteUnitOfWork wunit(_opCtx);
 			//ÿݶӦһKVKVд洢
-            Status ret = insert(objToIndex.value(), loc);
+            Status ret = keyGenerator ? keyGenerator->insert(objToIndex.value(), loc)
+                                      : insert(objToIndex.value(), loc);
             if (_buildInBackground)
                 exec->saveState();
             if (ret.isOK()) {
@@ -566,6 +764,13 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
         invariant(!"the hangAfterStartingIndexBuildUnlocked failpoint can't be turned off");
     }
 
+    if (keyGenerator) {
+        Status status = keyGenerator->finish();
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
     progress->finished();
 
 	
@@ -641,6 +846,21 @@ MultiIndexBlockImpl::insertAllDocumentsInCollection---> |
 ////MultiIndexBlockImpl::insertAllDocumentsInCollection
 Status MultiIndexBlockImpl::doneInserting(std::set<RecordId>* dupsOut) {
     for (size_t i = 0; i < _indexes.size(); i++) {
+        if (!_indexes[i].bulkPartitions.empty()) {
+            LOG(1) << "\t bulk commit starting for index: "
+                   << _indexes[i].block->getEntry()->descriptor()->indexName() << " from "
+                   << _indexes[i].bulkPartitions.size() << " partitions";
+            Status status = _indexes[i].real->commitBulk(_opCtx,
+                                                         std::move(_indexes[i].bulkPartitions),
+                                                         _allowInterruption,
+                                                         _indexes[i].options.dupsAllowed,
+                                                         dupsOut);
+            if (!status.isOK()) {
+                return status;
+            }
+            continue;
+        }
+
         if (_indexes[i].bulk == NULL) //Էbackgroud
             continue;
         LOG(1) << "\t bulk commit starting for index: "
@@ -219,6 +219,7 @@ public:
 private:
     class SetNeedToCleanupOnRollback;
     class CleanupIndexesVectorOnRollback;
+    class ParallelKeyGenerator;
 
     //MultiIndexBlockImpl._indexesΪͣ_indexes
     //MultiIndexBlockImpl::initʼ
@@ -236,6 +237,10 @@ private:
         //ӦBulkBuilder,
         std::unique_ptr<IndexAccessMethod::BulkBuilder> bulk;
 
+        // Replaces 'bulk' when insertAllDocumentsInCollection() generates keys on several threads.
+        // Each thread inserts into its own partition and the partitions are merged on commit.
+        std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> bulkPartitions;
+
         InsertDeleteOptions options;
     };
 
@@ -259,6 +264,9 @@ private:
     bool _ignoreUnique;
 
     bool _needToCleanup;
+
+    // Memory budget of the BulkBuilder of each index, set by init().
+    std::size_t _eachIndexBuildMaxMemoryUsageBytes = 0;
 };
 
 }  // namespace mongo
@@ -45,6 +45,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/cursor_manager.h"
 #include "mongo/db/cursor_server_params.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/repl/repl_client_info.h"
@@ -123,6 +124,7 @@ void ClientCursor::dispose(OperationContext* opCtx) {
     }
 
     _exec->dispose(opCtx, _cursorManager);
+    CursorManager::releasePrefetch(_cursorid).ignore();
     _disposed = true;
 }
 
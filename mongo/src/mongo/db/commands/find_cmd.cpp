@@ -45,6 +45,7 @@
 #include "mongo/db/query/find.h"
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_executor.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/server_parameters.h"
@@ -374,6 +375,8 @@ at src/mongo/db/commands/find_cmd.cpp:311
 
         // Stream query results, adding them to a BSONArray as we go.
         CursorResponseBuilder firstBatch(/*isInitialResponse*/ true, &result);
+        // Allocate the intermediate results of this batch from the operation's arena.
+        OperationArena::Scope batchArenaScope(getBatchArena(opCtx));
         BSONObj obj;
         PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
         long long numResults = 0;
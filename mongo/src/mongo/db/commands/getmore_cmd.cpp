@@ -49,6 +49,7 @@
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/service_context.h"
@@ -56,6 +57,7 @@
 #include "mongo/db/stats/top.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
@@ -67,6 +69,146 @@ namespace {
 
 MONGO_FP_DECLARE(rsStopGetMoreCmd);
 
+// Makes a getMore prefetch wait, with the cursor pinned, until the fail point is disabled or the
+// prefetch is interrupted.
+MONGO_FP_DECLARE(hangBeforeGetMorePrefetch);
+
+// Max number of getMore batches prefetched concurrently.
+const size_t kMaxPrefetchThreads = 4;
+
+/**
+ * Returns the pool running background prefetches of getMore batches. Its threads are created on
+ * demand, so the pool costs nothing unless internalQueryGetMorePrefetch is enabled.
+ */
+ThreadPool* getPrefetchPool() {
+    // Intentionally leaked so that the pool is never destroyed under a running prefetch.
+    static ThreadPool* const pool = [] {
+        ThreadPool::Options options;
+        options.poolName = "GetMorePrefetch";
+        options.threadNamePrefix = "getMorePrefetch";
+        options.minThreads = 0;
+        options.maxThreads = kMaxPrefetchThreads;
+        options.onCreateThread = [](const std::string& threadName) {
+            Client::initThread(threadName);
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+        };
+        auto pool = new ThreadPool(options);
+        pool->startup();
+        return pool;
+    }();
+    return pool;
+}
+
+/**
+ * Builds the next batch of the find cursor 'cursorId' in the background and stashes it in the
+ * cursor's PlanExecutor, where the next getMore picks it up ahead of anything else. Reads at most
+ * 'batchSize' documents, if set, and stops once 'maxBytes' bytes are buffered. The read is bound by
+ * the time left over from the cursor's maxTimeMS, as the next getMore would be.
+ *
+ * The prefetch must have been registered with CursorManager::beginPrefetch(), which makes other
+ * users of the cursor wait until the prefetch has unpinned it. Killing the cursor interrupts the
+ * prefetch. If the prefetch fails, it kills the cursor and leaves the error for the next getMore.
+ */
+void prefetchBatch(const NamespaceString& nss,
+                   CursorId cursorId,
+                   boost::optional<long long> batchSize,
+                   size_t maxBytes) {
+    size_t bytesBuffered = 0;
+    Status status = Status::OK();
+    ON_BLOCK_EXIT([&] { CursorManager::endPrefetch(cursorId, bytesBuffered, status); });
+
+    auto opCtx = cc().makeOperationContext();
+    CursorManager::attachPrefetchOperation(cursorId, opCtx.get());
+    ON_BLOCK_EXIT([&] { CursorManager::attachPrefetchOperation(cursorId, nullptr); });
+
+    // As with a getMore failing here, the cursor stays open and the next getMore sees the error.
+    boost::optional<AutoGetCollectionForRead> readLock;
+    try {
+        readLock.emplace(opCtx.get(), nss);
+    } catch (const DBException& ex) {
+        status = ex.toStatus();
+        return;
+    }
+
+    Collection* collection = readLock->getCollection();
+    if (!collection) {
+        return;
+    }
+
+    auto ccPin = collection->getCursorManager()->pinCursor(opCtx.get(), cursorId);
+    if (!ccPin.isOK()) {
+        return;
+    }
+
+    ClientCursor* cursor = ccPin.getValue().getCursor();
+    PlanExecutor* exec = cursor->getExecutor();
+    exec->reattachToOperationContext(opCtx.get());
+
+    std::vector<BSONObj> batch;
+    size_t batchBytes = 0;
+    try {
+        const Microseconds leftoverMaxTime = cursor->getLeftoverMaxTimeMicros();
+        if (leftoverMaxTime < Microseconds::max()) {
+            opCtx->setDeadlineAfterNowBy(leftoverMaxTime);
+        }
+        while (MONGO_FAIL_POINT(hangBeforeGetMorePrefetch)) {
+            opCtx->sleepFor(Milliseconds(10));
+        }
+        opCtx->checkForInterrupt();
+
+        if (cursor->isReadCommitted()) {
+            uassertStatusOK(opCtx->recoveryUnit()->setReadFromMajorityCommittedSnapshot());
+        }
+        uassertStatusOK(exec->restoreState());
+
+        BSONObj obj;
+        PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+        while ((!batchSize || static_cast<long long>(batch.size()) < *batchSize) &&
+               batchBytes < maxBytes &&
+               PlanExecutor::ADVANCED == (state = exec->getNext(&obj, nullptr))) {
+            batchBytes += obj.objsize();
+            batch.push_back(obj.getOwned());
+        }
+
+        // Fail with the same errors as a getMore reading the batch itself.
+        if (PlanExecutor::FAILURE == state) {
+            uasserted(ErrorCodes::OperationFailed,
+                      str::stream() << "GetMore command executor error: "
+                                    << WorkingSetCommon::toStatusString(obj));
+        } else if (PlanExecutor::DEAD == state) {
+            uasserted(ErrorCodes::QueryPlanKilled,
+                      str::stream() << "PlanExecutor killed: "
+                                    << WorkingSetCommon::toStatusString(obj));
+        }
+
+        exec->saveState();
+        exec->detachFromOperationContext();
+
+        if (leftoverMaxTime < Microseconds::max()) {
+            cursor->setLeftoverMaxTimeMicros(opCtx->getRemainingMaxTimeMicros());
+        }
+    } catch (const DBException& ex) {
+        LOG(1) << "getMore prefetch of cursor " << cursorId << " failed: " << redact(ex);
+        status = ex.toStatus();
+        exec->markAsKilled(status.reason());
+        return;
+    }
+
+    for (const auto& obj : batch) {
+        exec->enqueue(obj);
+    }
+    bytesBuffered = std::min(batchBytes, maxBytes);
+}
+
+/**
+ * Returns true if the next batch of 'cursor' may be prefetched once this getMore is done with it.
+ */
+bool shouldPrefetch(OperationContext* opCtx, const ClientCursor* cursor) {
+    return internalQueryGetMorePrefetch.load() &&
+        !CursorManager::isGloballyManagedCursor(cursor->cursorid()) && !cursor->isTailable() &&
+        !opCtx->getClient()->isInDirectClient();
+}
+
 /**
  * A command for running getMore() against an existing cursor registered with a CursorManager.
  * Used to generate the next batch of results for a ClientCursor.
@@ -168,6 +310,11 @@ public:
             }
         }
 
+        // A prefetch of this cursor's next batch keeps it pinned until the batch is stashed. Wait
+        // for it before taking any locks; the batch is consumed below, so release its budget.
+        CursorManager::waitForPrefetch(opCtx, request.cursorid);
+        const Status prefetchStatus = CursorManager::releasePrefetch(request.cursorid);
+
         // Cursors come in one of two flavors:
         // - Cursors owned by the collection cursor manager, such as those generated via the find
         //   command. For these cursors, we hold the appropriate collection lock for the duration of
@@ -219,6 +366,11 @@ public:
         }
 
         auto ccPin = cursorManager->pinCursor(opCtx, request.cursorid);
+        if (!prefetchStatus.isOK()) {
+            // The prefetch failed, and if it killed the cursor, it also disposed of it. Report
+            // the error instead of the cursor not being found.
+            return appendCommandStatus(result, prefetchStatus);
+        }
         if (!ccPin.isOK()) {
             return appendCommandStatus(result, ccPin.getStatus());
         }
@@ -386,6 +538,10 @@ public:
 
         if (respondWithId) {
             cursorFreer.Dismiss();
+
+            if (shouldPrefetch(opCtx, cursor)) {
+                schedulePrefetch(request, &ccPin.getValue());
+            }
         }
 
         return true;
@@ -408,6 +564,31 @@ public:
         return runParsed(opCtx, request.nss, request, cmdObj, result);
     }
 
+    /**
+     * Unpins the cursor held by 'ccPin' and hands it to a background prefetch of its next batch,
+     * if the prefetch budget allows.
+     */
+    void schedulePrefetch(const GetMoreRequest& request, ClientCursorPin* ccPin) {
+        const size_t maxBytes = CursorManager::beginPrefetch(
+            request.nss, request.cursorid, FindCommon::kMaxBytesToReturnToClientAtOnce);
+        if (!maxBytes) {
+            return;
+        }
+
+        // The prefetch pins the cursor itself once this getMore has let go of it.
+        ccPin->release();
+
+        auto nss = request.nss;
+        auto cursorId = request.cursorid;
+        auto batchSize = request.batchSize;
+        Status status = getPrefetchPool()->schedule([nss, cursorId, batchSize, maxBytes] {
+            prefetchBatch(nss, cursorId, batchSize, maxBytes);
+        });
+        if (!status.isOK()) {
+            CursorManager::endPrefetch(cursorId, 0, Status::OK());
+        }
+    }
+
     /**
      * Uses 'cursor' and 'request' to fill out 'nextBatch' with the batch of result documents to
      * be returned by this getMore.
@@ -426,6 +607,9 @@ public:
                          long long* numResults) {
         PlanExecutor* exec = cursor->getExecutor();
 
+        // Allocate the intermediate results of this batch from the operation's arena.
+        OperationArena::Scope batchArenaScope(getBatchArena(opCtx));
+
         // If an awaitData getMore is killed during this process due to our max time expiring at
         // an interrupt point, we just continue as normal and return rather than reporting a
         // timeout to the user.
@@ -50,6 +50,10 @@ private:
     Status _killCursor(OperationContext* opCtx,
                        const NamespaceString& nss,
                        CursorId cursorId) final {
+        // A cursor cannot be killed while a prefetch of its next batch keeps it pinned, so
+        // interrupt the prefetch and wait for it to unpin the cursor.
+        CursorManager::killPrefetch(opCtx, nss, cursorId);
+
         // Cursors come in one of two flavors:
         // - Cursors owned by the collection cursor manager, such as those generated via the find
         //   command. For these cursors, we hold the appropriate collection lock for the duration of
@@ -54,6 +54,7 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/read_concern.h"
 #include "mongo/db/repl/oplog.h"
@@ -96,6 +97,11 @@ bool handleCursorCommand(OperationContext* opCtx,
 
     CursorResponseBuilder responseBuilder(true, &result);
     BSONObj next;
+
+    // Allocate the intermediate results of this batch from the operation's arena. Blocking stages
+    // such as $group and $sort read their input under an OperationArena::HeapScope, since what
+    // they keep may outlive the batch.
+    OperationArena::Scope batchArenaScope(getBatchArena(opCtx));
     for (int objCount = 0; objCount < batchSize; objCount++) {
         // The initial getNext() on a PipelineProxyStage may be very expensive so we don't
         // do it when batchSize is 0 since that indicates a desire for a fast return.
@@ -501,6 +507,9 @@ Status runAggregate(OperationContext* opCtx,
         // this process uses the correct collation if it does any string comparisons.
         pipeline->optimizePipeline();
 
+        // Run the stages following the cursor on several threads, if enabled.
+        PipelineD::addParallelPipeline(pipeline.get());
+
         // Transfer ownership of the Pipeline to the PipelineProxyStage.
         unownedPipeline = pipeline.get();
         auto ws = make_unique<WorkingSet>();
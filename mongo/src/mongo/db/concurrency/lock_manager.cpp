@@ -41,6 +41,7 @@
 #include "mongo/config.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/locker.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/stringutils.h"
@@ -490,14 +491,28 @@ void LockHead::migratePartitionedLockHeads() {
 //CmdLockInfo::run    db.runCommand({lockInfo: 1})ȡϢ
 const unsigned LockManager::_numLockBuckets(128); //źĬϸֵ128   ȫͰпͻ
 
-// Balance scalability of intent locks against potential added cost of conflicting locks.
-// The exact value doesn't appear very important, but should be power of two
-const unsigned LockManager::_numPartitions = 32;
+namespace {
+// Balance scalability of intent locks against potential added cost of conflicting locks, which
+// have to migrate the intent locks from every partition. The number of partitions is a power of
+// two, at least kMinPartitions and at least twice the number of CPUs, so that lockers running
+// concurrently rarely map to the same partition.
+const unsigned kMinPartitions = 32;
+const unsigned kMaxPartitions = 1024;
+
+unsigned numPartitionsForHost() {
+    const unsigned numCPUs = stdx::thread::hardware_concurrency();
+    unsigned numPartitions = kMinPartitions;
+    while (numPartitions < 2 * numCPUs && numPartitions < kMaxPartitions) {
+        numPartitions *= 2;
+    }
+    return numPartitions;
+}
+}  // namespace
 
 //LockManager::LockManager()  _numLockBucketsĬ128
-LockManager::LockManager() {
+LockManager::LockManager()
+    : _numPartitions(numPartitionsForHost()), _partitions(_numPartitions) {
     _lockBuckets = new LockBucket[_numLockBuckets]; //128
-    _partitions = new Partition[_numPartitions]; //32
 }
 
 LockManager::~LockManager() {
@@ -509,7 +524,6 @@ LockManager::~LockManager() {
     }
 
     delete[] _lockBuckets;
-    delete[] _partitions;
 }
 
 //LockerImpl<>::lockBegin
@@ -33,6 +33,8 @@
 #include <map>
 #include <vector>
 
+#include <boost/align/aligned_allocator.hpp>
+
 #include "mongo/bson/bsonobj.h"
 #include "mongo/config.h"
 #include "mongo/db/concurrency/lock_manager_defs.h"
@@ -42,6 +44,7 @@
 #include "mongo/platform/unordered_map.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/new.h"
 #include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
@@ -161,7 +164,11 @@ private:
     // contention on the regular LockHead in the lock manager.
     //ÿresIdӦһPartitionedLockHeadṹLockManager._partitions[]
     //LockManager._partitions[]λͣοLockManager::lock
-    struct Partition {
+    //
+    // Partitions are aligned to separate cache lines, so that lockers using different partitions
+    // do not contend on the same line when taking the partition mutex. They must therefore be
+    // allocated through an aligned allocator rather than with new[].
+    struct alignas(stdx::hardware_destructive_interference_size) Partition {
         PartitionedLockHead* find(ResourceId resId);
         PartitionedLockHead* findOrInsert(ResourceId resId);
         typedef unordered_map<ResourceId, PartitionedLockHead*> Map;
@@ -237,9 +244,11 @@ private:
     LockBucket* _lockBuckets; //
 
     //_partitions = new Partition[_numPartitions]; //32
-    static const unsigned _numPartitions;
+    // Set from the number of CPUs by the constructor, so that concurrently running lockers
+    // rarely share a partition.
+    const unsigned _numPartitions;
     //ÿresIdӦһPartitionedLockHeadṹLockManager._partitions[]
-    Partition* _partitions; //
+    mutable std::vector<Partition, boost::alignment::aligned_allocator<Partition>> _partitions;
 };
 
 
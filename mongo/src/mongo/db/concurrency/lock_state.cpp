@@ -312,6 +312,9 @@ void CondVarLockGrantNotification::notify(ResourceId resId, LockResult result) {
 //ÿһmodeӦһTicketHolderlinuxsemźʵ
 namespace { //ֵsetGlobalThrottling //WiredTigerKVEngine::WiredTigerKVEngine->Locker::setGlobalThrottling
 TicketHolder* ticketHolders[LockModesCount] = {}; 
+
+// Set by setLongRunningReadThrottling().
+TicketHolder* longRunningReadTicketHolder = nullptr;
 }  // namespace
 
 
@@ -341,6 +344,10 @@ void Locker::setGlobalThrottling(class TicketHolder* reading, class TicketHolder
 	//ticketHolders[MODE_X]Ϊʲôûֵأ︳ֵ   _lockGlobalBeginĶ
 }
 
+void Locker::setLongRunningReadThrottling(class TicketHolder* reading) {
+    longRunningReadTicketHolder = reading;
+}
+
 template <bool IsForMMAPV1>
 LockerImpl<IsForMMAPV1>::LockerImpl()
     : _id(idCounter.addAndFetch(1)), _wuowNestingLevel(0), _threadId(stdx::this_thread::get_id()) {}
@@ -417,6 +424,9 @@ LockResult LockerImpl<IsForMMAPV1>::_lockGlobalBegin(LockMode mode, Milliseconds
         const bool reader = isSharedLockMode(mode);
 		//modeӦticketHolders
         auto holder = ticketHolders[mode]; 
+        if (holder && reader && _hasYielded && longRunningReadTicketHolder) {
+            holder = longRunningReadTicketHolder;
+        }
 		//ѭе
         if (holder) { //modeΪMODE_X ticketHolders[MODE_X]ΪNULLsetGlobalThrottling
             _clientState.store(reader ? kQueuedReader : kQueuedWriter); 
@@ -438,6 +448,7 @@ LockResult LockerImpl<IsForMMAPV1>::_lockGlobalBegin(LockMode mode, Milliseconds
 		//ȡ״̬Ϊactive
         _clientState.store(reader ? kActiveReader : kActiveWriter);
         _modeForTicket = mode;
+        _ticketHolder = holder;
     }
     const LockResult result = lockBegin(resourceIdGlobal, mode);
     if (result == LOCK_OK)
@@ -778,6 +789,7 @@ void LockerImpl<IsForMMAPV1>::restoreLockState(const Locker::LockSnapshot& state
     // We shouldn't be saving and restoring lock state from inside a WriteUnitOfWork.
     invariant(!inAWriteUnitOfWork());
     invariant(_modeForTicket == MODE_NONE);
+    _hasYielded = true;
 
     std::vector<OneLock>::const_iterator it = state.locks.begin();
     // If we locked the PBWM, it must be locked before the resourceIdGlobal resource.
@@ -967,8 +979,9 @@ bool LockerImpl<IsForMMAPV1>::_unlockImpl(LockRequestsMap::Iterator* it) {
     if (globalLockManager.unlock(it->objAddr())) {
         if (it->key() == resourceIdGlobal) {
             invariant(_modeForTicket != MODE_NONE);
-            auto holder = ticketHolders[_modeForTicket];
+            auto holder = _ticketHolder;
             _modeForTicket = MODE_NONE;
+            _ticketHolder = nullptr;
             if (holder) {
                 holder->release();
             }
@@ -242,6 +242,13 @@ private:
     //ֵLockerImpl<IsForMMAPV1>::_lockGlobalBegin
     LockMode _modeForTicket = MODE_NONE;
 
+    // The TicketHolder the ticket was acquired from, if any.
+    TicketHolder* _ticketHolder = nullptr;
+
+    // Whether this locker released its locks with saveLockStateAndUnlock() and restored them,
+    // which makes it get tickets for long running operations.
+    bool _hasYielded = false;
+
     // Indicates whether the client is active reader/writer or is queued.
     //ֵLockerImpl<IsForMMAPV1>::_lockGlobalBegin
     AtomicWord<ClientState> _clientState{kInactive};
@@ -76,6 +76,14 @@ public:
      */
     static void setGlobalThrottling(class TicketHolder* reading, class TicketHolder* writing);
 
+    /**
+     * Require global lock attempts in MODE_S and MODE_IS by lockers which already yielded their
+     * locks to obtain tickets from 'reading' instead, which must have a static lifetime. Operations
+     * which yield are long running, typically scans, so that they cannot use all the tickets for
+     * short reads. Passing nullptr uses the tickets given to setGlobalThrottling() again.
+     */
+    static void setLongRunningReadThrottling(class TicketHolder* reading);
+
     /**
      * State for reporting the number of active and queued reader and writer clients.
      */ 
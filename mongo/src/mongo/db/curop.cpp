@@ -504,6 +504,7 @@ string OpDebug::report(Client* client,
     OPDEBUG_TOSTRING_HELP(keysExamined);
     OPDEBUG_TOSTRING_HELP(docsExamined);
     OPDEBUG_TOSTRING_HELP_BOOL(hasSortStage);
+    OPDEBUG_TOSTRING_HELP(sortSpills);
     OPDEBUG_TOSTRING_HELP_BOOL(fromMultiPlanner);
     OPDEBUG_TOSTRING_HELP_BOOL(replanned);
     OPDEBUG_TOSTRING_HELP(nMatched);
@@ -595,6 +596,7 @@ void OpDebug::append(const CurOp& curop,
     OPDEBUG_APPEND_NUMBER(keysExamined);
     OPDEBUG_APPEND_NUMBER(docsExamined);
     OPDEBUG_APPEND_BOOL(hasSortStage);
+    OPDEBUG_APPEND_NUMBER(sortSpills);
     OPDEBUG_APPEND_BOOL(fromMultiPlanner);
     OPDEBUG_APPEND_BOOL(replanned);
     OPDEBUG_APPEND_NUMBER(nMatched);
@@ -653,6 +655,9 @@ void OpDebug::setPlanSummaryMetrics(const PlanSummaryStats& planSummaryStats) {
     keysExamined = planSummaryStats.totalKeysExamined;
     docsExamined = planSummaryStats.totalDocsExamined;
     hasSortStage = planSummaryStats.hasSortStage;
+    if (planSummaryStats.sortSpills > 0) {
+        sortSpills = planSummaryStats.sortSpills;
+    }
     fromMultiPlanner = planSummaryStats.fromMultiPlanner;
     replanned = planSummaryStats.replanned;
 }
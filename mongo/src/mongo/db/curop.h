@@ -97,6 +97,7 @@ public:
     long long docsExamined{-1};
 
     bool hasSortStage{false};  // true if the query plan involves an in-memory sort
+    long long sortSpills{-1};  // number of sorted runs written to disk by the plan's sort stages
 
     // True if the plan came from the multi-planner (not from the plan cache and not a query with a
     // single solution).
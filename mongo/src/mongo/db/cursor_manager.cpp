@@ -39,6 +39,7 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/cursor_server_params.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/kill_sessions_common.h"
@@ -46,6 +47,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/platform/random.h"
@@ -59,6 +61,157 @@ using std::vector;
 constexpr int CursorManager::kNumPartitions;
 
 namespace {
+
+Counter64 prefetchStatsBatches;
+Counter64 prefetchStatsBufferedBytes;  // gauge
+
+ServerStatusMetricField<Counter64> dPrefetchStatsBatches("cursor.prefetch.batches",
+                                                         &prefetchStatsBatches);
+ServerStatusMetricField<Counter64> dPrefetchStatsBufferedBytes("cursor.prefetch.bufferedBytes",
+                                                               &prefetchStatsBufferedBytes);
+
+/**
+ * Tracks the cursors with a getMore batch prefetched or being prefetched, and the bytes charged
+ * for each of them.
+ */
+class PrefetchRegistry {
+public:
+    size_t begin(const NamespaceString& nss, CursorId id, size_t maxBytes) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        const size_t budget =
+            static_cast<size_t>(std::max(internalQueryGetMorePrefetchMaxBytes.load(), 0));
+        if (_entries.count(id) || _totalBytes >= budget) {
+            return 0;
+        }
+
+        const size_t bytes = std::min(maxBytes, budget - _totalBytes);
+        Entry& entry = _entries[id];
+        entry.nss = nss;
+        entry.inProgress = true;
+        entry.bytes = bytes;
+        _totalBytes += bytes;
+        return bytes;
+    }
+
+    void attach(CursorId id, OperationContext* prefetchOpCtx) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _entries.find(id);
+        invariant(it != _entries.end() && it->second.inProgress);
+
+        it->second.opCtx = prefetchOpCtx;
+        if (prefetchOpCtx && it->second.killRequested) {
+            interrupt(prefetchOpCtx);
+        }
+    }
+
+    void end(CursorId id, size_t bytesBuffered, Status status) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _entries.find(id);
+        invariant(it != _entries.end() && it->second.inProgress);
+        invariant(!it->second.opCtx);
+        invariant(bytesBuffered <= it->second.bytes);
+        invariant(status.isOK() || !bytesBuffered);
+
+        _totalBytes -= it->second.bytes - bytesBuffered;
+        if (bytesBuffered || !status.isOK()) {
+            // Keep the entry until the next getMore claims the batch or the error.
+            it->second.inProgress = false;
+            it->second.bytes = bytesBuffered;
+            it->second.error = std::move(status);
+            it->second.finishDate = Date_t::now();
+            if (bytesBuffered) {
+                prefetchStatsBatches.increment();
+                prefetchStatsBufferedBytes.increment(bytesBuffered);
+            }
+        } else {
+            _entries.erase(it);
+        }
+        _prefetchFinished.notify_all();
+    }
+
+    void wait(OperationContext* opCtx, CursorId id, const NamespaceString* killNss) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        if (killNss) {
+            auto it = _entries.find(id);
+            if (it != _entries.end() && it->second.inProgress && it->second.nss == *killNss) {
+                // If the prefetch has no operation yet, attach() interrupts it.
+                it->second.killRequested = true;
+                if (it->second.opCtx) {
+                    interrupt(it->second.opCtx);
+                }
+            }
+        }
+
+        opCtx->waitForConditionOrInterrupt(_prefetchFinished, lk, [&] {
+            auto it = _entries.find(id);
+            return it == _entries.end() || !it->second.inProgress;
+        });
+    }
+
+    Status release(CursorId id) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _entries.find(id);
+        if (it == _entries.end() || it->second.inProgress) {
+            return Status::OK();
+        }
+
+        Status error = std::move(it->second.error);
+        _totalBytes -= it->second.bytes;
+        prefetchStatsBufferedBytes.decrement(it->second.bytes);
+        _entries.erase(it);
+        return error;
+    }
+
+    /**
+     * Drops the errors of prefetches which finished at least a cursor timeout before 'now'. A
+     * prefetch which fails usually kills its cursor, which then leaves nothing that would drop the
+     * error if no getMore comes to claim it.
+     */
+    size_t timeoutErrors(Date_t now) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        size_t numTimedOut = 0;
+        for (auto it = _entries.begin(); it != _entries.end();) {
+            const Entry& entry = it->second;
+            if (!entry.inProgress && !entry.error.isOK() &&
+                now - entry.finishDate >= Milliseconds(getCursorTimeoutMillis())) {
+                invariant(!entry.bytes);
+                it = _entries.erase(it);
+                ++numTimedOut;
+            } else {
+                ++it;
+            }
+        }
+        return numTimedOut;
+    }
+
+private:
+    struct Entry {
+        NamespaceString nss;
+        bool inProgress = false;
+        size_t bytes = 0;
+
+        // The operation reading the batch, while it runs. Interrupted when the cursor is killed.
+        OperationContext* opCtx = nullptr;
+        bool killRequested = false;
+
+        // Why the prefetch failed, reported by the next getMore.
+        Status error = Status::OK();
+        Date_t finishDate;
+    };
+
+    static void interrupt(OperationContext* prefetchOpCtx) {
+        stdx::lock_guard<Client> lk(*prefetchOpCtx->getClient());
+        prefetchOpCtx->getServiceContext()->killOperation(prefetchOpCtx);
+    }
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _prefetchFinished;
+    stdx::unordered_map<CursorId, Entry> _entries;
+    size_t _totalBytes = 0;
+};
+
+PrefetchRegistry prefetchRegistry;
+
 uint32_t idFromCursorId(CursorId id) {
     uint64_t x = static_cast<uint64_t>(id);
     x = x >> 32;
@@ -204,6 +357,9 @@ bool GlobalCursorIdCache::eraseCursor(OperationContext* opCtx, CursorId id, bool
         }
     }
 
+    // A cursor cannot be killed while a prefetch keeps it pinned.
+    CursorManager::killPrefetch(opCtx, nss, id);
+
     // If this cursor is owned by the global cursor manager, ask it to erase the cursor for us.
     if (CursorManager::isGloballyManagedCursor(id)) {
         Status eraseStatus = globalCursorManager->eraseCursor(opCtx, id, checkAuth);
@@ -236,6 +392,8 @@ bool GlobalCursorIdCache::eraseCursor(OperationContext* opCtx, CursorId id, bool
 std::size_t GlobalCursorIdCache::timeoutCursors(OperationContext* opCtx, Date_t now) {
     size_t totalTimedOut = 0;
 
+    CursorManager::timeoutPrefetchErrors(now);
+
     // Time out the cursors from the global cursor manager.
     totalTimedOut += globalCursorManager->timeoutCursors(opCtx, now);
 
@@ -496,6 +654,36 @@ void CursorManager::deregisterExecutor(PlanExecutor* exec) {
     }
 }
 
+size_t CursorManager::beginPrefetch(const NamespaceString& nss, CursorId id, size_t maxBytes) {
+    return prefetchRegistry.begin(nss, id, maxBytes);
+}
+
+void CursorManager::attachPrefetchOperation(CursorId id, OperationContext* prefetchOpCtx) {
+    prefetchRegistry.attach(id, prefetchOpCtx);
+}
+
+void CursorManager::endPrefetch(CursorId id, size_t bytesBuffered, Status status) {
+    prefetchRegistry.end(id, bytesBuffered, std::move(status));
+}
+
+void CursorManager::waitForPrefetch(OperationContext* opCtx, CursorId id) {
+    prefetchRegistry.wait(opCtx, id, nullptr);
+}
+
+void CursorManager::killPrefetch(OperationContext* opCtx,
+                                 const NamespaceString& nss,
+                                 CursorId id) {
+    prefetchRegistry.wait(opCtx, id, &nss);
+}
+
+Status CursorManager::releasePrefetch(CursorId id) {
+    return prefetchRegistry.release(id);
+}
+
+std::size_t CursorManager::timeoutPrefetchErrors(Date_t now) {
+    return prefetchRegistry.timeoutErrors(now);
+}
+
 StatusWith<ClientCursorPin> CursorManager::pinCursor(OperationContext* opCtx, CursorId id) {
     auto lockedPartition = _cursorMap->lockOnePartition(id);
     auto it = lockedPartition->find(id);
@@ -228,6 +228,57 @@ public:
      */
     static std::size_t timeoutCursorsGlobal(OperationContext* opCtx, Date_t now);
 
+    //
+    // Background prefetching of getMore batches. The prefetching operation keeps the cursor pinned
+    // while it runs, so operations which need the cursor must call waitForPrefetch() before
+    // pinning or killing it. Prefetched bytes are charged against the server-wide budget
+    // internalQueryGetMorePrefetchMaxBytes until the batch is claimed or the cursor is disposed.
+    //
+
+    /**
+     * Registers a prefetch for cursor 'id' on 'nss' and returns how many bytes it may buffer, at
+     * most 'maxBytes'. Returns 0 if the budget is used up or 'id' already has prefetched documents,
+     * in which case the caller must not prefetch.
+     */
+    static std::size_t beginPrefetch(const NamespaceString& nss,
+                                     CursorId id,
+                                     std::size_t maxBytes);
+
+    /**
+     * Records 'prefetchOpCtx' as the operation running the prefetch registered for 'id', so that
+     * killPrefetch() can interrupt it. Must be reset to nullptr before the operation is destroyed.
+     */
+    static void attachPrefetchOperation(CursorId id, OperationContext* prefetchOpCtx);
+
+    /**
+     * Marks the prefetch registered for 'id' as finished after buffering 'bytesBuffered' bytes.
+     * A non-OK 'status' is kept for the next releasePrefetch() to return.
+     */
+    static void endPrefetch(CursorId id, std::size_t bytesBuffered, Status status);
+
+    /**
+     * Blocks until no prefetch is running for 'id'. Throws if 'opCtx' is interrupted.
+     */
+    static void waitForPrefetch(OperationContext* opCtx, CursorId id);
+
+    /**
+     * Like waitForPrefetch(), but first interrupts the prefetch running for 'id', if the cursor
+     * belongs to 'nss'. The caller must be authorized to kill cursors on 'nss'.
+     */
+    static void killPrefetch(OperationContext* opCtx, const NamespaceString& nss, CursorId id);
+
+    /**
+     * Returns the bytes charged for documents prefetched for 'id' to the budget, and the error the
+     * prefetch failed with, if any. A no-op returning OK if a prefetch is still running.
+     */
+    static Status releasePrefetch(CursorId id);
+
+    /**
+     * Drops the errors of failed prefetches which no getMore claimed within a cursor timeout.
+     * Returns how many were dropped. Called by timeoutCursorsGlobal().
+     */
+    static std::size_t timeoutPrefetchErrors(Date_t now);
+
 private:
     static constexpr int kNumPartitions = 16;
     friend class ClientCursorPin;
@@ -151,6 +151,8 @@ bool DBDirectClient::call(Message& toSend, Message& response, bool assertOk, str
     auto dbResponse = loopbackBuildResponse(_opCtx, &_lastError, toSend);
     invariant(!dbResponse.response.empty());
     response = std::move(dbResponse.response);
+    // Direct clients parse the reply in place.
+    response.flatten();
 
     return true;
 }
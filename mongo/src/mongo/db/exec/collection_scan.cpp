@@ -38,6 +38,7 @@
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
@@ -104,6 +105,10 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
     _specificStats.maxTs = params.maxTs;
     invariant(!_params.shouldTrackLatestOplogTimestamp || _params.collection->ns().isOplog());
 
+    if (_filter && internalQueryEnableColumnarMatcher.load()) {
+        _columnarMatcher = ColumnarMatcher::compile(_filter);
+    }
+
     if (params.maxTs) {
         _endConditionBSON = BSON("$gte" << *(params.maxTs));
         _endCondition = stdx::make_unique<GTEMatchExpression>();
@@ -285,9 +290,13 @@ PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID* out) {
     ++_specificStats.docsTested;
 
-    if (Filter::passes(member, _filter)) {
+    // Members produced by this stage always hold the document.
+    const bool passes = _columnarMatcher ? _columnarMatcher->matches(member->obj.value())
+                                         : Filter::passes(member, _filter);
+    if (passes) {
         if (_params.stopApplyingFilterAfterFirstMatch) {
             _filter = nullptr;
+            _columnarMatcher.reset();
         }
         *out = memberID;
         return PlanStage::ADVANCED;
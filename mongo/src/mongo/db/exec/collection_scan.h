@@ -32,6 +32,7 @@
 
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/matcher/columnar_matcher.h"
 #include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/record_id.h"
 
@@ -102,6 +103,9 @@ private:
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
+    // Compiled form of '_filter', if enabled and '_filter' can be compiled.
+    std::unique_ptr<ColumnarMatcher> _columnarMatcher;
+
     // If a document does not pass '_filter' but passes '_endCondition', stop scanning and return
     // IS_EOF.
     BSONObj _endConditionBSON;
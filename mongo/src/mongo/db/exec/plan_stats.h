@@ -620,7 +620,7 @@ struct ProjectionStats : public SpecificStats {
 };
 
 struct SortStats : public SpecificStats {
-    SortStats() : forcedFetches(0), memUsage(0), memLimit(0) {}
+    SortStats() : forcedFetches(0), memUsage(0), memLimit(0), spills(0) {}
 
     SpecificStats* clone() const final {
         SortStats* specific = new SortStats(*this);
@@ -636,6 +636,9 @@ struct SortStats : public SpecificStats {
     // What's our memory limit?
     size_t memLimit;
 
+    // How many sorted runs were written to disk after the memory limit was exceeded?
+    size_t spills;
+
     // The number of results to return from the sort.
     size_t limit;
 
@@ -43,6 +43,7 @@
 #include "mongo/db/query/query_planner.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -67,6 +68,25 @@ bool SortStage::WorkingSetComparator::operator()(const SortableDataItem& lhs,
     return lhs.recordId < rhs.recordId;
 }
 
+SortStage::SpillComparator::SpillComparator(BSONObj p) : pattern(p) {}
+
+int SortStage::SpillComparator::operator()(const SpillSorter::Data& lhs,
+                                           const SpillSorter::Data& rhs) const {
+    // Same ordering as WorkingSetComparator: sort key first, then RecordId.
+    BSONObjIterator lhsIt(lhs.first);
+    BSONObjIterator rhsIt(rhs.first);
+    const BSONElement lhsKey = lhsIt.next();
+    const BSONElement rhsKey = rhsIt.next();
+    int result = lhsKey.embeddedObject().woCompare(rhsKey.embeddedObject(), pattern, false);
+    if (0 != result) {
+        return result;
+    }
+
+    const long long lhsRecordId = lhsIt.next().numberLong();
+    const long long rhsRecordId = rhsIt.next().numberLong();
+    return lhsRecordId < rhsRecordId ? -1 : (lhsRecordId > rhsRecordId ? 1 : 0);
+}
+
 SortStage::SortStage(OperationContext* opCtx,
                      const SortStageParams& params,
                      WorkingSet* ws,
@@ -76,6 +96,8 @@ SortStage::SortStage(OperationContext* opCtx,
       _ws(ws),
       _pattern(params.pattern),
       _limit(params.limit),
+      _allowDiskUse(params.allowDiskUse),
+      _tempDir(params.tempDir),
       _sorted(false),
       _resultIterator(_data.end()),
       _memUsage(0) {
@@ -97,19 +119,30 @@ SortStage::~SortStage() {}
 bool SortStage::isEOF() {
     // We're done when our child has no more results, we've sorted the child's results, and
     // we've returned all sorted results.
+    if (_sorter) {
+        return child()->isEOF() && _sorted && !_spillIterator->more();
+    }
     return child()->isEOF() && _sorted && (_data.end() == _resultIterator);
 }
 
 PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
     const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
 	//һѯĵڴ
-	if (_memUsage > maxBytes) {
-        mongoutils::str::stream ss;
-        ss << "Sort operation used more than the maximum " << maxBytes
-           << " bytes of RAM. Add an index, or specify a smaller limit.";
-        Status status(ErrorCodes::OperationFailed, ss);
-        *out = WorkingSetCommon::allocateStatusMember(_ws, status);
-        return PlanStage::FAILURE;
+    if (_memUsage > maxBytes) {
+        Status status = Status::OK();
+        if (_allowDiskUse) {
+            status = spill();
+        } else {
+            mongoutils::str::stream ss;
+            ss << "Sort operation used more than the maximum " << maxBytes
+               << " bytes of RAM. Add an index, or specify a smaller limit.";
+            status = Status(ErrorCodes::OperationFailed, ss);
+        }
+
+        if (!status.isOK()) {
+            *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+            return PlanStage::FAILURE;
+        }
     }
 
     if (isEOF()) {
@@ -151,14 +184,26 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
                 item.recordId = member->recordId;
             }
 
-            addToBuffer(item);
+            if (_sorter) {
+                Status status = addToSorter(item);
+                if (!status.isOK()) {
+                    *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+                    return PlanStage::FAILURE;
+                }
+            } else {
+                addToBuffer(item);
+            }
 
             return PlanStage::NEED_TIME;
         } else if (PlanStage::IS_EOF == code) {
             // TODO: We don't need the lock for this.  We could ask for a yield and do this work
             // unlocked.  Also, this is performing a lot of work for one call to work(...)
-            sortBuffer();
-            _resultIterator = _data.begin();
+            if (_sorter) {
+                _spillIterator.reset(_sorter->done());
+            } else {
+                sortBuffer();
+                _resultIterator = _data.begin();
+            }
             _sorted = true;
             return PlanStage::NEED_TIME;
         } else if (PlanStage::FAILURE == code || PlanStage::DEAD == code) {
@@ -181,6 +226,12 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
     }
 
     // Returning results.
+    if (_sorter) {
+        verify(_sorted);
+        *out = nextSpilledResult();
+        return PlanStage::ADVANCED;
+    }
+
     verify(_resultIterator != _data.end());
     verify(_sorted);
     *out = _resultIterator->wsid;
@@ -224,7 +275,8 @@ unique_ptr<PlanStageStats> SortStage::getStats() {
     _commonStats.isEOF = isEOF();
     const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
     _specificStats.memLimit = maxBytes;
-    _specificStats.memUsage = _memUsage;
+    _specificStats.memUsage = _sorter ? _sorter->memUsed() : _memUsage;
+    _specificStats.spills = _sorter ? _sorter->numFiles() : 0;
     _specificStats.limit = _limit;
     _specificStats.sortPattern = _pattern.getOwned();
 
@@ -344,4 +396,77 @@ void SortStage::sortBuffer() {
     }
 }
 
+Status SortStage::spill() {
+    invariant(!_sorter);
+    invariant(!_sorted);
+
+    const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
+    SortOptions opts;
+    opts.limit = _limit;
+    opts.maxMemoryUsageBytes = maxBytes;
+    opts.extSortAllowed = true;
+    opts.tempDir = _tempDir;
+    _sorter.reset(SpillSorter::make(opts, SpillComparator(_sortKeyComparator->pattern)));
+
+    std::vector<SortableDataItem> buffered;
+    if (_dataSet) {
+        buffered.assign(_dataSet->begin(), _dataSet->end());
+        _dataSet->clear();
+    } else {
+        buffered.swap(_data);
+    }
+    _memUsage = 0;
+
+    LOG(1) << "Sort operation exceeded " << maxBytes << " bytes of RAM, spilling "
+           << buffered.size() << " buffered results to disk";
+
+    for (const auto& item : buffered) {
+        Status status = addToSorter(item);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    return Status::OK();
+}
+
+Status SortStage::addToSorter(const SortableDataItem& item) {
+    WorkingSetMember* member = _ws->get(item.wsid);
+    if (member->hasComputed(WSM_COMPUTED_TEXT_SCORE) ||
+        member->hasComputed(WSM_COMPUTED_GEO_DISTANCE) || member->hasComputed(WSM_INDEX_KEY) ||
+        member->hasComputed(WSM_GEO_NEAR_POINT)) {
+        return Status(ErrorCodes::OperationFailed,
+                      str::stream() << "Sort operation used more than the maximum "
+                                    << internalQueryExecMaxBlockingSortBytes.load()
+                                    << " bytes of RAM and cannot spill results that carry "
+                                       "text score, geo or index key metadata. Add an index, "
+                                       "or specify a smaller limit.");
+    }
+
+    _sorter->add(BSON("k" << item.sortKey << "r" << item.recordId.repr()),
+                 member->obj.value().getOwned());
+
+    if (member->hasRecordId()) {
+        _wsidByRecordId.erase(member->recordId);
+    }
+    _ws->free(item.wsid);
+    return Status::OK();
+}
+
+WorkingSetID SortStage::nextSpilledResult() {
+    SpillSorter::Data next = _spillIterator->next();
+
+    WorkingSetID id = _ws->allocate();
+    WorkingSetMember* member = _ws->get(id);
+    member->obj = Snapshotted<BSONObj>(SnapshotId(), next.second.getOwned());
+    member->transitionToOwnedObj();
+
+    // Stages above us, such as a projection of the sort key for a merging mongos, may still need
+    // the sort key.
+    member->addComputed(new SortKeyComputedData(next.first.firstElement().embeddedObject()));
+    return id;
+}
+
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <set>
+#include <string>
 #include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
@@ -37,6 +38,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/platform/unordered_map.h"
 
 namespace mongo {
@@ -46,7 +48,7 @@ class BtreeKeyGenerator;
 // Parameters that must be provided to a SortStage
 class SortStageParams {
 public:
-    SortStageParams() : collection(NULL), limit(0) {}
+    SortStageParams() : collection(NULL), limit(0), allowDiskUse(false) {}
 
     // Used for resolving RecordIds to BSON
     const Collection* collection;
@@ -56,6 +58,13 @@ public:
 
     // Equal to 0 for no limit.
     size_t limit;
+
+    // If true, the stage writes its buffered data to 'tempDir' instead of failing once it uses
+    // more than internalQueryExecMaxBlockingSortBytes.
+    bool allowDiskUse;
+
+    // Directory for the sorted runs written when spilling.
+    std::string tempDir;
 };
 
 /**
@@ -65,6 +74,10 @@ public:
  *   -- For each field in 'pattern', all inputs in the child must handle a getFieldDotted for that
  *   field.
  *   -- All WSMs produced by the child stage must have the sort key available as WSM computed data.
+ *
+ * When disk use is allowed and the buffered data outgrows the memory limit, the stage moves it into
+ * an external Sorter and returns the results from there. Spilled results come back as owned
+ * objects without a RecordId, the same state an invalidated member is left in.
  */
 class SortStage final : public PlanStage {
 public:
@@ -106,6 +119,10 @@ private:
     // Equal to 0 for no limit.
     size_t _limit;
 
+    bool _allowDiskUse;
+
+    std::string _tempDir;
+
     //
     // Data storage
     //
@@ -152,6 +169,35 @@ private:
      */
     void sortBuffer();
 
+    /**
+     * Moves the buffered data into '_sorter', which takes over the memory accounting and writes
+     * sorted runs to disk as needed. Fails if a buffered member carries computed data other than
+     * its sort key, since that would be lost when spilled.
+     */
+    Status spill();
+
+    /**
+     * Adds one item to '_sorter' and frees its working set member.
+     */
+    Status addToSorter(const SortableDataItem& item);
+
+    /**
+     * Returns the next spilled result as a new owned-object working set member.
+     */
+    WorkingSetID nextSpilledResult();
+
+    // Spilled data is keyed on {k: <sort key>, r: <RecordId>} so that RecordId still breaks
+    // ties, and the value is the document itself.
+    typedef Sorter<BSONObj, BSONObj> SpillSorter;
+
+    struct SpillComparator {
+        explicit SpillComparator(BSONObj p);
+
+        int operator()(const SpillSorter::Data& lhs, const SpillSorter::Data& rhs) const;
+
+        BSONObj pattern;
+    };
+
     // Comparator for data buffer
     // Initialization follows sort key generator
     std::unique_ptr<WorkingSetComparator> _sortKeyComparator;
@@ -170,6 +216,11 @@ private:
     // Iterates through _data post-sort returning it.
     std::vector<SortableDataItem>::iterator _resultIterator;
 
+    // Set once the stage has spilled. From then on all input goes to the sorter and the results
+    // are read back through _spillIterator instead of _data.
+    std::unique_ptr<SpillSorter> _sorter;
+    std::unique_ptr<SpillSorter::Iterator> _spillIterator;
+
     // We buffer a lot of data and we want to look it up by RecordId quickly upon invalidation.
     typedef unordered_map<RecordId, WorkingSetID, RecordId::Hasher> DataMap;
     DataMap _wsidByRecordId;
@@ -39,11 +39,14 @@
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/query/collation/collator_factory_mock.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
+#include "mongo/util/scopeguard.h"
 
 using namespace mongo;
 
@@ -154,6 +157,58 @@ public:
         }
     }
 
+    /**
+     * Sorts 'numDocs' documents of the form {a: <int>, pad: <string>} on 'a' with a memory limit
+     * small enough for the stage to exceed it. Appends the values of 'a' that were returned to
+     * 'out' and the number of spills to 'spills', and returns the final stage state.
+     */
+    PlanStage::StageState runSortOverMemoryLimit(int numDocs,
+                                                 bool allowDiskUse,
+                                                 std::vector<int>* out,
+                                                 size_t* spills) {
+        const int oldMaxBytes = internalQueryExecMaxBlockingSortBytes.load();
+        internalQueryExecMaxBlockingSortBytes.store(4 * 1024);
+        ON_BLOCK_EXIT([&] { internalQueryExecMaxBlockingSortBytes.store(oldMaxBytes); });
+        unittest::TempDir tempDir("sort_stage_test");
+
+        WorkingSet ws;
+        auto queuedDataStage = stdx::make_unique<QueuedDataStage>(getOpCtx(), &ws);
+        for (int i = 0; i < numDocs; ++i) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* wsm = ws.get(id);
+            // Visit the values of 'a' out of order.
+            BSONObj obj = BSON("a" << (i * 37) % numDocs << "pad" << std::string(64, 'x'));
+            wsm->obj = Snapshotted<BSONObj>(SnapshotId(), obj);
+            wsm->transitionToOwnedObj();
+            queuedDataStage->pushBack(id);
+        }
+
+        SortStageParams params;
+        params.pattern = BSON("a" << 1);
+        params.allowDiskUse = allowDiskUse;
+        params.tempDir = tempDir.path();
+
+        auto sortKeyGen = stdx::make_unique<SortKeyGeneratorStage>(
+            getOpCtx(), queuedDataStage.release(), &ws, params.pattern, nullptr);
+        SortStage sort(getOpCtx(), params, &ws, sortKeyGen.release());
+
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        while (state == PlanStage::NEED_TIME || state == PlanStage::ADVANCED) {
+            state = sort.work(&id);
+            if (state == PlanStage::ADVANCED) {
+                WorkingSetMember* member = ws.get(id);
+                ASSERT_TRUE(member->hasComputed(WSM_SORT_KEY));
+                out->push_back(member->obj.value()["a"].numberInt());
+                ws.free(id);
+            }
+        }
+
+        auto stats = sort.getStats();
+        *spills = static_cast<const SortStats*>(stats->specific.get())->spills;
+        return state;
+    }
+
 private:
     OperationContext* _opCtx;
 
@@ -300,4 +355,31 @@ TEST_F(SortStageTest, SortDescendingWithCollation) {
              "{input: [{a: 'ba'}, {a: 'aa'}, {a: 'ab'}]}",
              "{output: [{a: 'ab'}, {a: 'ba'}, {a: 'aa'}]}");
 }
+
+//
+// Memory limit
+//
+
+TEST_F(SortStageTest, SortFailsOverMemoryLimitWithoutDiskUse) {
+    std::vector<int> results;
+    size_t spills = 0;
+    ASSERT_EQUALS(PlanStage::FAILURE,
+                  runSortOverMemoryLimit(1000, false /* allowDiskUse */, &results, &spills));
+    ASSERT_TRUE(results.empty());
+    ASSERT_EQUALS(0U, spills);
+}
+
+TEST_F(SortStageTest, SortSpillsToDiskOverMemoryLimit) {
+    const int numDocs = 1000;
+    std::vector<int> results;
+    size_t spills = 0;
+    ASSERT_EQUALS(PlanStage::IS_EOF,
+                  runSortOverMemoryLimit(numDocs, true /* allowDiskUse */, &results, &spills));
+    ASSERT_GT(spills, 0U);
+
+    ASSERT_EQUALS(static_cast<size_t>(numDocs), results.size());
+    for (int i = 0; i < numDocs; ++i) {
+        ASSERT_EQUALS(i, results[i]);
+    }
+}
 }  // namespace
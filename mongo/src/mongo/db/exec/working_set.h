@@ -36,6 +36,7 @@
 #include "mongo/db/storage/snapshot.h"
 #include "mongo/platform/unordered_set.h"
 #include "mongo/stdx/unordered_set.h"
+#include "mongo/util/operation_arena.h"
 
 namespace mongo {
 
@@ -261,6 +262,13 @@ public:
     WorkingSetMember();
     ~WorkingSetMember();
 
+    void* operator new(size_t size) {
+        return OperationArena::allocate(size);
+    }
+    void operator delete(void* ptr) {
+        OperationArena::deallocate(ptr);
+    }
+
     /**
      * Reset to an "empty" state.
      */
@@ -48,6 +48,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/storage_options.h"
@@ -483,7 +484,8 @@ IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
           SortOptions()
               .TempDir(storageGlobalParams.dbpath + "/_tmp")
               .ExtSortAllowed()
-              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
+              .MaxMemoryUsageBytes(maxMemoryUsageBytes)
+              .Parallelism(std::max(1, internalSorterMaxThreads.load())),
           BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
       _real(index) {}
 
@@ -559,17 +561,57 @@ Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
                                      bool mayInterrupt,
                                      bool dupsAllowed,
                                      set<RecordId>* dupsToDrop) {
+    std::vector<std::unique_ptr<BulkBuilder>> bulks;
+    bulks.push_back(std::move(bulk));
+    return commitBulk(opCtx, std::move(bulks), mayInterrupt, dupsAllowed, dupsToDrop);
+}
+
+Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
+                                     std::vector<std::unique_ptr<BulkBuilder>> bulks,
+                                     bool mayInterrupt,
+                                     bool dupsAllowed,
+                                     set<RecordId>* dupsToDrop) {
     Timer timer;
+    invariant(!bulks.empty());
+
+    int64_t keysInserted = 0;
+    bool everGeneratedMultipleKeys = false;
+    MultikeyPaths indexMultikeyPaths;
+    for (auto&& bulk : bulks) {
+        keysInserted += bulk->_keysInserted;
+        everGeneratedMultipleKeys = everGeneratedMultipleKeys || bulk->_everGeneratedMultipleKeys;
+        if (indexMultikeyPaths.empty()) {
+            indexMultikeyPaths = bulk->_indexMultikeyPaths;
+        } else if (!bulk->_indexMultikeyPaths.empty()) {
+            invariant(indexMultikeyPaths.size() == bulk->_indexMultikeyPaths.size());
+            for (size_t j = 0; j < indexMultikeyPaths.size(); ++j) {
+                indexMultikeyPaths[j].insert(bulk->_indexMultikeyPaths[j].begin(),
+                                             bulk->_indexMultikeyPaths[j].end());
+            }
+        }
+    }
 
 	//IndexAccessMethod::BulkBuilder::insertдbulkȡʹ
-    std::unique_ptr<BulkBuilder::Sorter::Iterator> i(bulk->_sorter->done());
+    std::unique_ptr<BulkBuilder::Sorter::Iterator> i;
+    if (bulks.size() == 1) {
+        i.reset(bulks.front()->_sorter->done());
+    } else {
+        std::vector<std::shared_ptr<BulkBuilder::Sorter::Iterator>> iters;
+        for (auto&& bulk : bulks) {
+            iters.emplace_back(bulk->_sorter->done());
+        }
+        i.reset(BulkBuilder::Sorter::Iterator::merge(
+            iters,
+            SortOptions(),
+            BtreeExternalSortComparison(_descriptor->keyPattern(), _descriptor->version())));
+    }
 
     stdx::unique_lock<Client> lk(*opCtx->getClient());
 	//2021-03-14T14:24:29.000+0800 I - [conn167]   Index: (2/3) BTree Bottom Up Progress: 17232100/54386432 31%
     ProgressMeterHolder pm(
         CurOp::get(opCtx)->setMessage_inlock("Index Bulk Build: (2/3) btree bottom up",
                                              "Index: (2/3) BTree Bottom Up Progress",
-                                             bulk->_keysInserted,
+                                             keysInserted,
                                              //10ӡһ
                                              10));
     lk.unlock();
@@ -580,8 +622,8 @@ Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
     writeConflictRetry(opCtx, "setting index multikey flag", "", [&] {
         WriteUnitOfWork wunit(opCtx);
 
-        if (bulk->_everGeneratedMultipleKeys || isMultikeyFromPaths(bulk->_indexMultikeyPaths)) {
-            _btreeState->setMultikey(opCtx, bulk->_indexMultikeyPaths);
+        if (everGeneratedMultipleKeys || isMultikeyFromPaths(indexMultikeyPaths)) {
+            _btreeState->setMultikey(opCtx, indexMultikeyPaths);
         }
 
         builder.reset(_newInterface->getBulkBuilder(opCtx, dupsAllowed));
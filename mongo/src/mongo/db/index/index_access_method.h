@@ -290,6 +290,17 @@ public:
                       bool dupsAllowed,
                       std::set<RecordId>* dups);
 
+    /**
+     * Like above, but merges the sorted keys of several BulkBuilders into the index. This allows
+     * the keys to be generated by several threads, each inserting into its own BulkBuilder. Each
+     * document must have been inserted into only one of the BulkBuilders.
+     */
+    Status commitBulk(OperationContext* opCtx,
+                      std::vector<std::unique_ptr<BulkBuilder>> bulks,
+                      bool mayInterrupt,
+                      bool dupsAllowed,
+                      std::set<RecordId>* dups);
+
     /**
      * Specifies whether getKeys should relax the index constraints or not.
      */
@@ -0,0 +1,296 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/columnar_matcher.h"
+
+#include <algorithm>
+
+#include "mongo/db/field_ref.h"
+#include "mongo/stdx/memory.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * Returns true for the path leaves whose result on a non-array element is given by
+ * matchesSingleElement() alone.
+ */
+bool isSupportedLeaf(MatchExpression::MatchType type) {
+    switch (type) {
+        case MatchExpression::EQ:
+        case MatchExpression::LTE:
+        case MatchExpression::LT:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::REGEX:
+        case MatchExpression::MOD:
+        case MatchExpression::EXISTS:
+        case MatchExpression::MATCH_IN:
+        case MatchExpression::BITS_ALL_SET:
+        case MatchExpression::BITS_ALL_CLEAR:
+        case MatchExpression::BITS_ANY_SET:
+        case MatchExpression::BITS_ANY_CLEAR:
+        case MatchExpression::TYPE_OPERATOR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+ColumnarMatcher::ColumnarMatcher(const MatchExpression* expr) : _expr(expr), _paths(1) {}
+
+std::unique_ptr<ColumnarMatcher> ColumnarMatcher::compile(const MatchExpression* expr) {
+    std::unique_ptr<ColumnarMatcher> matcher(new ColumnarMatcher(expr));
+    if (!matcher->compileNode(expr, &matcher->_root)) {
+        return nullptr;
+    }
+    matcher->_seen.resize(matcher->_paths.size());
+    return matcher;
+}
+
+bool ColumnarMatcher::compileNode(const MatchExpression* expr, Node* node) {
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+        case MatchExpression::OR:
+        case MatchExpression::NOR: {
+            Node* parent = node;
+            if (expr->matchType() == MatchExpression::NOR) {
+                node->type = Node::kNot;
+                node->children.resize(1);
+                parent = &node->children[0];
+            }
+            parent->type = expr->matchType() == MatchExpression::AND ? Node::kAnd : Node::kOr;
+            parent->children.resize(expr->numChildren());
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                if (!compileNode(expr->getChild(i), &parent->children[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case MatchExpression::NOT:
+            node->type = Node::kNot;
+            node->children.resize(1);
+            return compileNode(expr->getChild(0), &node->children[0]);
+        case MatchExpression::ALWAYS_TRUE:
+            node->type = Node::kAlwaysTrue;
+            return true;
+        case MatchExpression::ALWAYS_FALSE:
+            node->type = Node::kAlwaysFalse;
+            return true;
+        default:
+            if (!isSupportedLeaf(expr->matchType()) || expr->path().empty()) {
+                return false;
+            }
+            node->type = Node::kLeaf;
+            node->leaf = expr;
+            node->column = addPath(expr->path());
+            return true;
+    }
+}
+
+size_t ColumnarMatcher::addPath(StringData path) {
+    FieldRef fieldRef(path);
+    size_t current = 0;
+    for (size_t part = 0; part < fieldRef.numParts(); ++part) {
+        const StringData fieldName = fieldRef.getPart(part);
+        size_t next = 0;
+        for (size_t child : _paths[current].children) {
+            if (_paths[child].fieldName == fieldName) {
+                next = child;
+                break;
+            }
+        }
+        if (next == 0) {
+            next = _paths.size();
+            _paths.emplace_back();
+            _paths.back().fieldName = fieldName.toString();
+            _paths[current].children.push_back(next);
+        }
+        current = next;
+    }
+
+    if (_paths[current].column < 0) {
+        _paths[current].column = static_cast<int>(_numColumns++);
+    }
+    return static_cast<size_t>(_paths[current].column);
+}
+
+bool ColumnarMatcher::extract(const BSONObj& obj, const PathNode& node, size_t doc) {
+    size_t remaining = node.children.size();
+    BSONObjIterator it(obj);
+    while (remaining > 0 && it.more()) {
+        const BSONElement elem = it.next();
+        const StringData fieldName = elem.fieldNameStringData();
+        for (size_t child : node.children) {
+            const PathNode& childNode = _paths[child];
+            if (_seen[child] || childNode.fieldName != fieldName) {
+                continue;
+            }
+            _seen[child] = true;
+            --remaining;
+
+            if (elem.type() == Array) {
+                return false;
+            }
+            if (childNode.column >= 0) {
+                _columns[childNode.column * _batchSize + doc] = elem;
+            }
+            // Paths through a scalar are missing, as getFieldDottedOrArray() would report.
+            if (!childNode.children.empty() && elem.type() == Object &&
+                !extract(elem.embeddedObject(), childNode, doc)) {
+                return false;
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+bool ColumnarMatcher::extractDocument(const BSONObj& obj, size_t doc) {
+    for (size_t column = 0; column < _numColumns; ++column) {
+        _columns[column * _batchSize + doc] = BSONElement();
+    }
+    std::fill(_seen.begin(), _seen.end(), 0);
+    return extract(obj, _paths[0], doc);
+}
+
+void ColumnarMatcher::matchBatch(const std::vector<BSONObj>& docs, std::vector<char>* results) {
+    _batchSize = docs.size();
+    _columns.resize(_numColumns * _batchSize);
+    results->assign(docs.size(), 0);
+
+    std::vector<size_t> selection;
+    selection.reserve(docs.size());
+    for (size_t doc = 0; doc < docs.size(); ++doc) {
+        if (extractDocument(docs[doc], doc)) {
+            selection.push_back(doc);
+        } else {
+            (*results)[doc] = _expr->matchesBSON(docs[doc]);
+        }
+    }
+
+    if (!selection.empty()) {
+        evaluate(_root, selection, results);
+    }
+}
+
+bool ColumnarMatcher::matches(const BSONObj& doc) {
+    _batchSize = 1;
+    _columns.resize(_numColumns);
+    if (!extractDocument(doc, 0)) {
+        return _expr->matchesBSON(doc);
+    }
+    return evaluateOne(_root);
+}
+
+void ColumnarMatcher::evaluate(const Node& node,
+                               const std::vector<size_t>& selection,
+                               std::vector<char>* results) const {
+    switch (node.type) {
+        case Node::kLeaf: {
+            const BSONElement* column = &_columns[node.column * _batchSize];
+            for (size_t doc : selection) {
+                (*results)[doc] = node.leaf->matchesSingleElement(column[doc]);
+            }
+            return;
+        }
+        case Node::kAnd:
+        case Node::kOr: {
+            // A document is decided by the first child that returns 'decidingResult'. The others
+            // stay in 'open' for the next child.
+            const char decidingResult = node.type == Node::kOr;
+            for (size_t doc : selection) {
+                (*results)[doc] = !decidingResult;
+            }
+
+            std::vector<size_t> open(selection);
+            for (const Node& child : node.children) {
+                if (open.empty()) {
+                    break;
+                }
+                evaluate(child, open, results);
+                open.erase(std::remove_if(open.begin(),
+                                          open.end(),
+                                          [&](size_t doc) {
+                                              return (*results)[doc] == decidingResult;
+                                          }),
+                           open.end());
+            }
+            return;
+        }
+        case Node::kNot:
+            evaluate(node.children[0], selection, results);
+            for (size_t doc : selection) {
+                (*results)[doc] = !(*results)[doc];
+            }
+            return;
+        case Node::kAlwaysTrue:
+        case Node::kAlwaysFalse:
+            for (size_t doc : selection) {
+                (*results)[doc] = node.type == Node::kAlwaysTrue;
+            }
+            return;
+    }
+    MONGO_UNREACHABLE;
+}
+
+bool ColumnarMatcher::evaluateOne(const Node& node) const {
+    switch (node.type) {
+        case Node::kLeaf:
+            return node.leaf->matchesSingleElement(element(node.column, 0));
+        case Node::kAnd:
+            for (const Node& child : node.children) {
+                if (!evaluateOne(child)) {
+                    return false;
+                }
+            }
+            return true;
+        case Node::kOr:
+            for (const Node& child : node.children) {
+                if (evaluateOne(child)) {
+                    return true;
+                }
+            }
+            return false;
+        case Node::kNot:
+            return !evaluateOne(node.children[0]);
+        case Node::kAlwaysTrue:
+            return true;
+        case Node::kAlwaysFalse:
+            return false;
+    }
+    MONGO_UNREACHABLE;
+}
+
+}  // namespace mongo
@@ -0,0 +1,144 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+/**
+ * Evaluates a MatchExpression over batches of BSON documents one column at a time.
+ *
+ * Each document is scanned once to gather the elements of all the paths the expression refers to
+ * into a column buffer. Each leaf predicate then runs in a tight loop over its column, and the
+ * $and/$or nodes pass only the documents whose result is still open on to their next child.
+ *
+ * Only trees of $and, $or, $nor and $not over comparison, $in, $exists, $type, $regex, $mod and
+ * bit test leaves can be compiled. The matcher does not traverse arrays: a document in which a
+ * referenced path runs into an array is handed to MatchExpression::matchesBSON() instead. The
+ * results are therefore always the same as those of the expression itself.
+ */
+class ColumnarMatcher {
+    MONGO_DISALLOW_COPYING(ColumnarMatcher);
+
+public:
+    /**
+     * Returns a matcher for 'expr', or nullptr if 'expr' uses an operator the matcher cannot
+     * evaluate. 'expr' is not owned and must outlive the matcher.
+     */
+    static std::unique_ptr<ColumnarMatcher> compile(const MatchExpression* expr);
+
+    /**
+     * Sets (*results)[i] to whether docs[i] matches. 'results' is resized to docs.size().
+     */
+    void matchBatch(const std::vector<BSONObj>& docs, std::vector<char>* results);
+
+    /**
+     * Returns whether 'doc' matches. This is a batch of one without the selection vectors.
+     */
+    bool matches(const BSONObj& doc);
+
+private:
+    // A node of the trie of referenced paths. Node 0 is the root document.
+    struct PathNode {
+        std::string fieldName;
+        std::vector<size_t> children;
+        // Column holding the element at this path, or -1 if the path is only a prefix.
+        int column = -1;
+    };
+
+    // A node of the compiled tree. $nor is compiled as $not over $or.
+    struct Node {
+        enum Type { kLeaf, kAnd, kOr, kNot, kAlwaysTrue, kAlwaysFalse };
+
+        Type type = kLeaf;
+        const MatchExpression* leaf = nullptr;
+        size_t column = 0;
+        std::vector<Node> children;
+    };
+
+    explicit ColumnarMatcher(const MatchExpression* expr);
+
+    bool compileNode(const MatchExpression* expr, Node* node);
+
+    /**
+     * Returns the column for 'path', adding it to the trie if needed.
+     */
+    size_t addPath(StringData path);
+
+    /**
+     * Stores the elements of the paths below 'node' found in 'obj' in the columns of document
+     * 'doc'. Returns false if one of them runs into an array.
+     */
+    bool extract(const BSONObj& obj, const PathNode& node, size_t doc);
+
+    /**
+     * Resets the columns of document 'doc' and fills them from 'obj'.
+     */
+    bool extractDocument(const BSONObj& obj, size_t doc);
+
+    /**
+     * Sets (*results)[doc] for every document in 'selection'.
+     */
+    void evaluate(const Node& node,
+                  const std::vector<size_t>& selection,
+                  std::vector<char>* results) const;
+
+    bool evaluateOne(const Node& node) const;
+
+    const BSONElement& element(size_t column, size_t doc) const {
+        return _columns[column * _batchSize + doc];
+    }
+
+    const MatchExpression* const _expr;
+
+    Node _root;
+
+    std::vector<PathNode> _paths;
+    size_t _numColumns = 0;
+
+    // Whether a field of the current document was already matched against each path node. Only
+    // the first occurrence of a field name counts, as in BSONObj::getField().
+    std::vector<char> _seen;
+
+    // Column-major buffer of the current batch: the element of column 'c' for document 'd' is
+    // _columns[c * _batchSize + d]. Missing paths are EOO.
+    std::vector<BSONElement> _columns;
+    size_t _batchSize = 0;
+};
+
+}  // namespace mongo
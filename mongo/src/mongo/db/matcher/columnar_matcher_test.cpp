@@ -0,0 +1,143 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/columnar_matcher.h"
+
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::unique_ptr<MatchExpression> parse(const char* query) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto result = MatchExpressionParser::parse(fromjson(query), expCtx);
+    ASSERT_OK(result.getStatus());
+    return std::move(result.getValue());
+}
+
+std::vector<BSONObj> testDocuments() {
+    return {fromjson("{}"),
+            fromjson("{a: 1, b: 'x'}"),
+            fromjson("{a: 5, b: 'y', c: {d: 3}}"),
+            fromjson("{a: null, c: {d: 10, e: {f: true}}}"),
+            fromjson("{a: 2.5, c: 4}"),
+            fromjson("{b: 'xyz', c: {d: 'str'}}"),
+            fromjson("{a: [1, 7], b: 'x'}"),
+            fromjson("{a: 3, c: [{d: 3}, {d: 4}]}"),
+            fromjson("{a: 3, c: {d: [10, 11]}}"),
+            fromjson("{a: 9, a: 1, c: {d: 1}}"),
+            fromjson("{c: {d: {$numberLong: '3'}}, a: {x: 1}}"),
+            fromjson("{a: 4, b: 12, c: {e: {f: false}}}")};
+}
+
+/**
+ * Checks that both matchBatch() and matches() agree with MatchExpression::matchesBSON() for every
+ * test document.
+ */
+void assertSameResults(const char* query) {
+    auto expr = parse(query);
+    auto matcher = ColumnarMatcher::compile(expr.get());
+    ASSERT(matcher) << query;
+
+    const auto docs = testDocuments();
+    std::vector<char> results;
+    matcher->matchBatch(docs, &results);
+    ASSERT_EQ(docs.size(), results.size());
+
+    for (size_t i = 0; i < docs.size(); ++i) {
+        const bool expected = expr->matchesBSON(docs[i]);
+        ASSERT_EQ(expected, static_cast<bool>(results[i])) << query << " on " << docs[i];
+        ASSERT_EQ(expected, matcher->matches(docs[i])) << query << " on " << docs[i];
+    }
+}
+
+TEST(ColumnarMatcherTest, Comparisons) {
+    assertSameResults("{a: 1}");
+    assertSameResults("{a: {$gt: 2}}");
+    assertSameResults("{a: {$gte: 2, $lt: 5}}");
+    assertSameResults("{a: {$lte: 3}, b: 'x'}");
+    assertSameResults("{a: null}");
+    assertSameResults("{'c.d': 3}");
+    assertSameResults("{'c.d': {$gt: 2}, a: {$ne: 5}}");
+    assertSameResults("{'c.e.f': true}");
+}
+
+TEST(ColumnarMatcherTest, OtherLeaves) {
+    assertSameResults("{a: {$in: [1, 3, null]}}");
+    assertSameResults("{a: {$nin: [1, 3]}}");
+    assertSameResults("{b: {$exists: true}}");
+    assertSameResults("{'c.d': {$exists: false}}");
+    assertSameResults("{a: {$type: 'number'}}");
+    assertSameResults("{c: {$type: 'object'}}");
+    assertSameResults("{b: /^x/}");
+    assertSameResults("{a: {$mod: [2, 1]}}");
+    assertSameResults("{b: {$bitsAllSet: [2, 3]}}");
+}
+
+TEST(ColumnarMatcherTest, LogicalOperators) {
+    assertSameResults("{$or: [{a: 1}, {'c.d': 3}]}");
+    assertSameResults("{$or: [{a: {$gt: 3}}, {b: 'x'}], c: {$exists: true}}");
+    assertSameResults("{$nor: [{a: 1}, {b: 'y'}]}");
+    assertSameResults("{a: {$not: {$gt: 2}}}");
+    assertSameResults("{$and: [{$or: [{a: 1}, {a: 5}]}, {$or: [{b: 'x'}, {b: 'y'}]}]}");
+    assertSameResults("{$alwaysTrue: 1}");
+    assertSameResults("{$alwaysFalse: 1}");
+}
+
+TEST(ColumnarMatcherTest, PathThatIsAlsoAPrefix) {
+    assertSameResults("{c: {$exists: true}, 'c.d': {$gte: 3}, 'c.e.f': {$exists: false}}");
+}
+
+TEST(ColumnarMatcherTest, EmptyBatch) {
+    auto expr = parse("{a: 1}");
+    auto matcher = ColumnarMatcher::compile(expr.get());
+    ASSERT(matcher);
+
+    std::vector<char> results{1, 1};
+    matcher->matchBatch({}, &results);
+    ASSERT(results.empty());
+}
+
+TEST(ColumnarMatcherTest, UnsupportedOperatorsAreNotCompiled) {
+    auto elemMatch = parse("{a: {$elemMatch: {$gt: 1}}}");
+    ASSERT_FALSE(ColumnarMatcher::compile(elemMatch.get()));
+
+    auto size = parse("{a: 1, c: {$size: 2}}");
+    ASSERT_FALSE(ColumnarMatcher::compile(size.get()));
+
+    auto nestedInOr = parse("{$or: [{a: 1}, {a: {$elemMatch: {$gt: 1}}}]}");
+    ASSERT_FALSE(ColumnarMatcher::compile(nestedInOr.get()));
+}
+
+}  // namespace
+}  // namespace mongo
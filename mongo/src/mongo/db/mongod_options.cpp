@@ -212,9 +212,9 @@ Status addMongodOptions(moe::OptionSection* options) {
         .addOptionChaining("storage.groupCollections",
                            "groupCollections",
                            moe::Switch,
-                           "group collections - if true the storage engine may group "
-                           "collections within a database into a shared record store.")
-        .hidden();
+                           "group collections - if true new collections and indexes share a "
+                           "small number of storage engine tables, set by the "
+                           "groupCollectionsTableCount parameter, instead of getting one each");
 
     general_options
         .addOptionChaining("noIndexBuildRetry",
@@ -148,8 +148,8 @@ void DocumentStorage::alloc(unsigned newSize) {
 
     uassert(16490, "Tried to make oversized document", capacity <= size_t(BufferMaxSize));
 
-    std::unique_ptr<char[]> oldBuf(_buffer);
-    _buffer = new char[capacity];
+    BufferHolder oldBuf(_buffer, &OperationArena::deallocate);
+    _buffer = allocateBuffer(capacity);
     _bufferEnd = _buffer + capacity - hashTabBytes();
 
     if (!firstAlloc) {
@@ -181,7 +181,7 @@ void DocumentStorage::reserveFields(size_t expectedFields) {
 
     uassert(16491, "Tried to make oversized document", newSize <= size_t(BufferMaxSize));
 
-    _buffer = new char[newSize + hashTabBytes()];
+    _buffer = allocateBuffer(newSize + hashTabBytes());
     _bufferEnd = _buffer + newSize;
 }
 
@@ -191,7 +191,7 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
     // Make a copy of the buffer.
     // It is very important that the positions of each field are the same after cloning.
     const size_t bufferBytes = allocatedBytes();
-    out->_buffer = new char[bufferBytes];
+    out->_buffer = allocateBuffer(bufferBytes);
     out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
     if (bufferBytes > 0) {
         memcpy(out->_buffer, _buffer, bufferBytes);
@@ -215,7 +215,7 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
 }
 
 DocumentStorage::~DocumentStorage() {
-    std::unique_ptr<char[]> deleteBufferAtScopeEnd(_buffer);
+    BufferHolder deleteBufferAtScopeEnd(_buffer, &OperationArena::deallocate);
 
     for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
         it->val.~Value();  // explicit destructor call
@@ -32,10 +32,12 @@
 
 #include <bitset>
 #include <boost/intrusive_ptr.hpp>
+#include <memory>
 
 #include "mongo/base/static_assert.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/util/intrusive_counter.h"
+#include "mongo/util/operation_arena.h"
 
 namespace mongo {
 /** Helper class to make the position in a document abstract
@@ -193,6 +195,13 @@ public:
 
     ~DocumentStorage();
 
+    void* operator new(size_t size) {
+        return OperationArena::allocate(size);
+    }
+    void operator delete(void* ptr) {
+        OperationArena::deallocate(ptr);
+    }
+
     enum MetaType : char {
         TEXT_SCORE,
         RAND_VAL,
@@ -328,6 +337,14 @@ private:
     /// Allocates space in _buffer. Copies existing data if there is any.
     void alloc(unsigned newSize);
 
+    /// Allocates a buffer of 'bytes' bytes, from the current OperationArena if there is one.
+    static char* allocateBuffer(size_t bytes) {
+        return static_cast<char*>(OperationArena::allocate(bytes));
+    }
+
+    /// Owns a buffer returned by allocateBuffer().
+    using BufferHolder = std::unique_ptr<char, void (*)(void*)>;
+
     /// Call after adding field to _buffer and increasing _numFields
     void addFieldToHashTable(Position pos);
 
@@ -85,6 +85,16 @@ const char* DocumentSource::getSourceName() const {
     return unknown;
 }
 
+DocumentSource::GetNextResult::ReturnStatus DocumentSource::getNextBatch(
+    std::vector<Document>* batch, size_t maxDocs) {
+    invariant(maxDocs > 0);
+    auto next = getNext();
+    if (next.isAdvanced()) {
+        batch->push_back(next.releaseDocument());
+    }
+    return next.getStatus();
+}
+
 intrusive_ptr<DocumentSource> DocumentSource::optimize() {
     return this;
 }
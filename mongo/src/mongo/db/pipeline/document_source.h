@@ -395,6 +395,20 @@ public:
      */
     virtual GetNextResult getNext() = 0;
 
+    /**
+     * Batched form of getNext(), for consumers which process many documents at a time. Appends up
+     * to 'maxDocs' of the next results of this stage to 'batch', and returns the status which ended
+     * the batch: kAdvanced if more results may be requested right away, otherwise the kEOF or
+     * kPauseExecution which getNext() would have returned after the documents in 'batch'. Calls to
+     * getNext() and getNextBatch() may be mixed.
+     *
+     * The default implementation returns the single next result of getNext(). Stages which can
+     * produce or transform a block of documents more cheaply than one at a time override it, as
+     * long as that does not keep references to the documents of a child which would otherwise be
+     * released (see getNext()).
+     */
+    virtual GetNextResult::ReturnStatus getNextBatch(std::vector<Document>* batch, size_t maxDocs);
+
     /**
      * Returns a struct containing information about any special constraints imposed on using this
      * stage. Input parameter Pipeline::SplitState is used by stages whose requirements change
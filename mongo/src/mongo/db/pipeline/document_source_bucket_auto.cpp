@@ -32,6 +32,7 @@
 
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/util/operation_arena.h"
 
 namespace mongo {
 
@@ -88,6 +89,9 @@ DocumentSource::GetDepsReturn DocumentSourceBucketAuto::getDependencies(DepsTrac
 }
 
 DocumentSource::GetNextResult DocumentSourceBucketAuto::populateSorter() {
+    // Like $sort, the sorter retains the input documents, so they are allocated from the heap.
+    OperationArena::HeapScope heapScope;
+
     if (!_sorter) {
         SortOptions opts;
         opts.maxMemoryUsageBytes = _maxMemoryUsageBytes;
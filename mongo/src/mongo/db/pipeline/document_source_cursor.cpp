@@ -63,6 +63,25 @@ DocumentSource::GetNextResult DocumentSourceCursor::getNext() {
     return std::move(out);
 }
 
+DocumentSource::GetNextResult::ReturnStatus DocumentSourceCursor::getNextBatch(
+    std::vector<Document>* batch, size_t maxDocs) {
+    pExpCtx->checkForInterrupt();
+
+    if (_currentBatch.empty()) {
+        loadBatch();
+
+        if (_currentBatch.empty())
+            return GetNextResult::ReturnStatus::kEOF;
+    }
+
+    // Hand out the documents of the batch already loaded from the PlanExecutor, without reading
+    // more from it until the next call.
+    const auto end = _currentBatch.begin() + std::min(maxDocs, _currentBatch.size());
+    std::move(_currentBatch.begin(), end, std::back_inserter(*batch));
+    _currentBatch.erase(_currentBatch.begin(), end);
+    return GetNextResult::ReturnStatus::kAdvanced;
+}
+
 void DocumentSourceCursor::loadBatch() {
     if (!_exec) {
         // No more documents.
@@ -45,6 +45,7 @@ class DocumentSourceCursor final : public DocumentSource {
 public:
     // virtuals from DocumentSource
     GetNextResult getNext() final;
+    GetNextResult::ReturnStatus getNextBatch(std::vector<Document>* batch, size_t maxDocs) final;
     const char* getSourceName() const final;
     BSONObjSet getOutputSorts() final {
         return _outputSorts;
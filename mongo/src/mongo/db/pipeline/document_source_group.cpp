@@ -38,7 +38,9 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/operation_arena.h"
 
 namespace mongo {
 
@@ -70,7 +72,9 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNext() {
         accum->reset();  // Prep accumulators for a new group.
     }
 
-    if (_spilled) {
+    if (_hashSpilled) {
+        return getNextHashSpilled();
+    } else if (_spilled) {
         return getNextSpilled();
     } else if (_streaming) {
         return getNextStreaming();
@@ -113,6 +117,52 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
     return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
 }
 
+DocumentSource::GetNextResult DocumentSourceGroup::getNextHashSpilled() {
+    while (!_partitionGroups || _partitionGroupsIterator == _partitionGroups->end()) {
+        scheduleSpilledPartitions();
+        if (_aggregatingPartitions.empty()) {
+            dispose();
+            return GetNextResult::makeEOF();
+        }
+
+        // Partitions are returned in the order they were scheduled, which keeps the disk and memory
+        // usage bounded even though a later partition may finish aggregating first.
+        AggregatedPartition aggregated = _aggregatingPartitions.front().get();
+        _aggregatingPartitions.pop_front();
+
+        for (auto&& subPartition : aggregated.subPartitions) {
+            _spilledPartitions.push_back(std::move(subPartition));
+        }
+        _partitionGroups = std::move(aggregated.groups);
+        _partitionGroupsIterator = _partitionGroups->begin();
+    }
+
+    // Keep the other threads busy while the groups of this partition are returned.
+    scheduleSpilledPartitions();
+
+    Document out = makeDocument(
+        _partitionGroupsIterator->first, _partitionGroupsIterator->second, pExpCtx->needsMerge);
+    ++_partitionGroupsIterator;
+    return std::move(out);
+}
+
+void DocumentSourceGroup::scheduleSpilledPartitions() {
+    // Each partition being aggregated, plus the one being returned, gets an equal share of the
+    // memory limit.
+    const size_t maxMemoryUsageBytes =
+        std::max(_maxMemoryUsageBytes / (_maxSpillThreads + 1), size_t(1));
+
+    // With a single thread, the partitions are aggregated lazily by the thread calling getNext().
+    const auto policy = _maxSpillThreads > 1 ? stdx::launch::async : stdx::launch::deferred;
+    while (!_spilledPartitions.empty() && _aggregatingPartitions.size() < _maxSpillThreads) {
+        SpilledPartition partition = std::move(_spilledPartitions.front());
+        _spilledPartitions.pop_front();
+        _aggregatingPartitions.push_back(stdx::async(policy, [this, partition, maxMemoryUsageBytes] {
+            return aggregatePartition(partition, maxMemoryUsageBytes);
+        }));
+    }
+}
+
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     // Not spilled, and not streaming.
     if (_groups->empty())
@@ -168,6 +218,14 @@ void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
     _sorterIterator.reset();
+    _inputBatch.clear();
+    _inputBatchPos = 0;
+
+    // Wait for the partitions being aggregated before releasing the rest of the spilled data.
+    _aggregatingPartitions.clear();
+    _spilledPartitions.clear();
+    _partitionWriters.clear();
+    _partitionGroups = boost::none;
 
     // Make us look done.
     groupsIterator = _groups->end();
@@ -266,7 +324,10 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
       _initialized(false),
       _groups(pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
       _spilled(false),
-      _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos) {}
+      _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos),
+      _hashSpill(internalDocumentSourceGroupHashSpill.load()),
+      _maxSpillThreads(std::max(1, internalDocumentSourceGroupMaxThreads.load())),
+      _inputBatchSize(std::max(1, internalDocumentSourceBatchSize.load())) {}
 
 void DocumentSourceGroup::addAccumulator(AccumulationStatement accumulationStatement) {
     _accumulatedFields.push_back(accumulationStatement);
@@ -385,6 +446,60 @@ private:
     ValueComparator _valueComparator;
 };
 
+/**
+ * Serializes the accumulators of a group for spilling. Mirrors the format written by spill().
+ */
+Value serializeAccumulators(const DocumentSourceGroup::Accumulators& accumulators) {
+    switch (accumulators.size()) {
+        case 0:  // No accumulators so no Values.
+            return Value();
+        case 1:  // Single accumulators serialize as a single Value.
+            return accumulators[0]->getValue(/*toBeMerged=*/true);
+        default: {  // Multiple accumulators serialize as an array of Values.
+            vector<Value> states;
+            states.reserve(accumulators.size());
+            for (auto&& accumulator : accumulators) {
+                states.push_back(accumulator->getValue(/*toBeMerged=*/true));
+            }
+            return Value(std::move(states));
+        }
+    }
+}
+
+/**
+ * Merges the spilled state 'state', produced by serializeAccumulators(), into 'accumulators'.
+ */
+void mergeAccumulators(const Value& state, DocumentSourceGroup::Accumulators* accumulators) {
+    switch (accumulators->size()) {
+        case 0:
+            break;
+        case 1:
+            (*accumulators)[0]->process(state, true);
+            break;
+        default: {
+            const vector<Value>& states = state.getArray();
+            for (size_t i = 0; i < accumulators->size(); i++) {
+                (*accumulators)[i]->process(states[i], true);
+            }
+        }
+    }
+}
+
+/**
+ * Chooses the spill partition of the group with the given _id. The hash is remixed with a seed
+ * which depends on 'depth', so that the groups of a partition which is split again spread over
+ * all of its sub-partitions.
+ */
+size_t spillPartitionFor(const ValueComparator& comparator, const Value& id, int depth) {
+    uint64_t hash = comparator.hash(id) + depth * 0x9E3779B97F4A7C15ULL;
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash % DocumentSourceGroup::kNumSpillPartitions;
+}
+
 bool containsOnlyFieldPathsAndConstants(ExpressionObject* expressionObj) {
     for (auto&& it : expressionObj->getChildExpressions()) {
         const intrusive_ptr<Expression>& childExp = it.second;
@@ -449,6 +564,10 @@ void getFieldPathListForSpilled(ExpressionObject* expressionObj,
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
+    // The accumulators hold on to values from the input documents until the groups are returned,
+    // which may be many batches later, so read the input from the heap.
+    OperationArena::HeapScope heapScope;
+
     const size_t numAccumulators = _accumulatedFields.size();
 
     boost::optional<BSONObj> inputSort = findRelevantInputSort();
@@ -479,14 +598,18 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
 
 
     // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
-    GetNextResult input = pSource->getNext();
-    for (; input.isAdvanced(); input = pSource->getNext()) {
+    GetNextResult input = getNextInput();
+    for (; input.isAdvanced(); input = getNextInput()) {
         if (_memoryUsageBytes > _maxMemoryUsageBytes) {
             uassert(16945,
                     "Exceeded memory limit for $group, but didn't allow external sort."
                     " Pass allowDiskUse:true to opt in.",
                     _allowDiskUse);
-            _sortedFiles.push_back(spill());
+            if (_hashSpill) {
+                spillToPartitions();
+            } else {
+                _sortedFiles.push_back(spill());
+            }
             _memoryUsageBytes = 0;
         }
 
@@ -529,12 +652,17 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
 
         if (kDebugBuild && !storageGlobalParams.readOnly) {
             // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                 // is a dup
-                !pExpCtx->inMongos &&        // can't spill to disk in mongos
-                !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
-
-                _sortedFiles.push_back(spill());
+            if (!inserted &&                                   // is a dup
+                !pExpCtx->inMongos &&                          // can't spill to disk in mongos
+                !_allowDiskUse &&                              // don't change behavior when testing
+                                                               // external sort
+                _sortedFiles.size() + _numHashSpills < 20) {  // don't open too many FDs
+
+                if (_hashSpill) {
+                    spillToPartitions();
+                } else {
+                    _sortedFiles.push_back(spill());
+                }
             }
         }
     }
@@ -548,7 +676,19 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
             // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
+            if (_numHashSpills > 0) {
+                _hashSpilled = true;
+                if (!_groups->empty()) {
+                    spillToPartitions();
+                }
+
+                // We won't be using groups again so free its memory.
+                _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+
+                std::vector<SpilledPartition> partitions;
+                finishPartitions(&_partitionWriters, 0, &partitions);
+                _spilledPartitions.assign(partitions.begin(), partitions.end());
+            } else if (!_sortedFiles.empty()) {
                 _spilled = true;
                 if (!_groups->empty()) {
                     _sortedFiles.push_back(spill());
@@ -582,6 +722,29 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
+DocumentSource::GetNextResult DocumentSourceGroup::getNextInput() {
+    if (_inputBatchSize == 1) {
+        return pSource->getNext();
+    }
+
+    while (_inputBatchPos == _inputBatch.size()) {
+        // Return the status which ended the previous batch before asking for a new one.
+        const auto status = _inputBatchStatus;
+        _inputBatchStatus = GetNextResult::ReturnStatus::kAdvanced;
+        if (status == GetNextResult::ReturnStatus::kEOF) {
+            return GetNextResult::makeEOF();
+        } else if (status == GetNextResult::ReturnStatus::kPauseExecution) {
+            return GetNextResult::makePauseExecution();
+        }
+
+        _inputBatch.clear();
+        _inputBatchPos = 0;
+        _inputBatchStatus = pSource->getNextBatch(&_inputBatch, _inputBatchSize);
+    }
+
+    return std::move(_inputBatch[_inputBatchPos++]);
+}
+
 shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
     ptrs.reserve(_groups->size());
@@ -622,6 +785,88 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
 }
 
+void DocumentSourceGroup::spillToPartitions() {
+    writeToPartitions(*_groups, 0, &_partitionWriters);
+    _groups->clear();
+    _numHashSpills++;
+}
+
+void DocumentSourceGroup::writeToPartitions(const GroupsMap& groups,
+                                            int depth,
+                                            PartitionWriters* writers) const {
+    writers->resize(kNumSpillPartitions);
+    for (auto&& group : groups) {
+        auto& writer =
+            (*writers)[spillPartitionFor(pExpCtx->getValueComparator(), group.first, depth)];
+        if (!writer) {
+            // Only create the files of partitions which have data, since the Sorter does not
+            // accept reading back an empty file.
+            writer = stdx::make_unique<SortedFileWriter<Value, Value>>(
+                SortOptions().TempDir(pExpCtx->tempDir));
+        }
+        writer->addAlreadySorted(group.first, serializeAccumulators(group.second));
+    }
+}
+
+void DocumentSourceGroup::finishPartitions(PartitionWriters* writers,
+                                           int depth,
+                                           std::vector<SpilledPartition>* partitions) {
+    for (auto&& writer : *writers) {
+        if (writer) {
+            partitions->push_back(
+                {shared_ptr<Sorter<Value, Value>::Iterator>(writer->done()), depth});
+        }
+    }
+    writers->clear();
+}
+
+DocumentSourceGroup::AggregatedPartition DocumentSourceGroup::aggregatePartition(
+    SpilledPartition partition, size_t maxMemoryUsageBytes) const {
+    AggregatedPartition result;
+    result.groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+
+    // Only split the partition when that can reduce the memory needed: a single group which does
+    // not fit in memory would otherwise be spilled over and over again.
+    PartitionWriters subPartitionWriters;
+    size_t memoryUsageBytes = 0;
+    while (partition.iterator->more()) {
+        if (memoryUsageBytes > maxMemoryUsageBytes && result.groups->size() > 1 &&
+            partition.depth < kMaxSpillPartitionDepth) {
+            writeToPartitions(*result.groups, partition.depth + 1, &subPartitionWriters);
+            result.groups->clear();
+            memoryUsageBytes = 0;
+        }
+
+        auto next = partition.iterator->next();
+        const size_t oldSize = result.groups->size();
+        Accumulators& group = (*result.groups)[next.first];
+        if (result.groups->size() != oldSize) {
+            memoryUsageBytes += next.first.getApproximateSize();
+            group.reserve(_accumulatedFields.size());
+            for (auto&& accumulatedField : _accumulatedFields) {
+                group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+            }
+        } else {
+            for (auto&& accumulator : group) {
+                memoryUsageBytes -= accumulator->memUsageForSorter();
+            }
+        }
+
+        mergeAccumulators(next.second, &group);
+        for (auto&& accumulator : group) {
+            memoryUsageBytes += accumulator->memUsageForSorter();
+        }
+    }
+
+    if (!subPartitionWriters.empty()) {
+        writeToPartitions(*result.groups, partition.depth + 1, &subPartitionWriters);
+        result.groups->clear();
+        finishPartitions(&subPartitionWriters, partition.depth + 1, &result.subPartitions);
+    }
+
+    return result;
+}
+
 boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
     if (true) {
         // Until streaming $group correctly handles nullish values, the streaming behavior is
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <utility>
 
@@ -35,6 +36,7 @@
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/stdx/future.h"
 
 namespace mongo {
 
@@ -45,6 +47,14 @@ public:
 
     static const size_t kDefaultMaxMemoryUsageBytes = 100 * 1024 * 1024;
 
+    // Number of partitions the groups are hashed into when spilling with
+    // internalDocumentSourceGroupHashSpill enabled.
+    static const size_t kNumSpillPartitions = 16;
+
+    // A spilled partition which still does not fit in memory is partitioned again, up to this
+    // many times. Past this depth, the groups of a partition are aggregated in memory regardless.
+    static const int kMaxSpillPartitionDepth = 4;
+
     // Virtuals from DocumentSource.
     boost::intrusive_ptr<DocumentSource> optimize() final;
     GetDepsReturn getDependencies(DepsTracker* deps) const final;
@@ -106,6 +116,27 @@ protected:
     void doDispose() final;
 
 private:
+    /**
+     * A hash partition of the groups spilled to disk. All the partial groups sharing an _id are
+     * spilled to the same partition, in the order they were spilled, so that each partition can
+     * be aggregated independently of the others.
+     */
+    struct SpilledPartition {
+        std::shared_ptr<Sorter<Value, Value>::Iterator> iterator;
+        int depth;
+    };
+
+    /**
+     * The result of aggregating a SpilledPartition: either the final groups of the partition, or,
+     * if they did not fit in memory, the partitions it was split into.
+     */
+    struct AggregatedPartition {
+        boost::optional<GroupsMap> groups;
+        std::vector<SpilledPartition> subPartitions;
+    };
+
+    using PartitionWriters = std::vector<std::unique_ptr<SortedFileWriter<Value, Value>>>;
+
     explicit DocumentSourceGroup(const boost::intrusive_ptr<ExpressionContext>& pExpCtx,
                                  size_t maxMemoryUsageBytes = kDefaultMaxMemoryUsageBytes);
 
@@ -118,6 +149,12 @@ private:
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
 
+    /**
+     * Used instead of getNextSpilled() when the groups were spilled by spillToPartitions().
+     * Returns the groups of one spilled partition at a time, in no particular order.
+     */
+    GetNextResult getNextHashSpilled();
+
     /**
      * Attempt to identify an input sort order that allows us to turn into a streaming $group. If we
      * find one, return it. Otherwise, return boost::none.
@@ -136,6 +173,12 @@ private:
      */
     GetNextResult initialize();
 
+    /**
+     * Returns the next input document of an unsorted $group. Reads the input from 'pSource' in
+     * batches of 'internalDocumentSourceBatchSize' documents when that is greater than one.
+     */
+    GetNextResult getNextInput();
+
     /**
      * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
      * does not exhaust the previous stage before returning, and thus does not maintain as large a
@@ -143,6 +186,38 @@ private:
      */
     std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
 
+    /**
+     * Alternative to spill() which appends each group of the groups map to one of
+     * 'kNumSpillPartitions' files chosen by hashing its _id, so that the groups never need to be
+     * sorted or merged by _id.
+     */
+    void spillToPartitions();
+
+    /**
+     * Writes the partial groups in 'groups' to the partition files of 'writers' for 'depth'.
+     */
+    void writeToPartitions(const GroupsMap& groups, int depth, PartitionWriters* writers) const;
+
+    /**
+     * Closes 'writers' and appends the resulting partitions to 'partitions'.
+     */
+    static void finishPartitions(PartitionWriters* writers,
+                                 int depth,
+                                 std::vector<SpilledPartition>* partitions);
+
+    /**
+     * Merges the partial groups of 'partition'. When they use more than 'maxMemoryUsageBytes', the
+     * partition is split again rather than aggregated. Does not modify the state of this stage, so
+     * that several partitions can be aggregated concurrently.
+     */
+    AggregatedPartition aggregatePartition(SpilledPartition partition,
+                                           size_t maxMemoryUsageBytes) const;
+
+    /**
+     * Starts aggregating spilled partitions until '_maxSpillThreads' of them are being aggregated.
+     */
+    void scheduleSpilledPartitions();
+
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
     /**
@@ -186,6 +261,31 @@ private:
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
     const bool _allowDiskUse;
 
+    // Whether to spill with spillToPartitions() rather than spill(), and how many spilled
+    // partitions may be aggregated concurrently. Both are read from the query knobs when this
+    // stage is constructed.
+    const bool _hashSpill;
+    const size_t _maxSpillThreads;
+
+    // Input documents read by getNextInput() but not yet consumed, followed by the status which
+    // ended that batch.
+    const size_t _inputBatchSize;
+    std::vector<Document> _inputBatch;
+    size_t _inputBatchPos = 0;
+    GetNextResult::ReturnStatus _inputBatchStatus = GetNextResult::ReturnStatus::kAdvanced;
+
+    // Number of calls to spillToPartitions() while consuming the input.
+    size_t _numHashSpills = 0;
+    PartitionWriters _partitionWriters;
+
+    // Only used when '_hashSpilled' is true. The groups of the partition being returned are held
+    // in '_partitionGroups', while up to '_maxSpillThreads' partitions are aggregated ahead.
+    bool _hashSpilled = false;
+    std::deque<SpilledPartition> _spilledPartitions;
+    std::deque<stdx::future<AggregatedPartition>> _aggregatingPartitions;
+    boost::optional<GroupsMap> _partitionGroups;
+    GroupsMap::iterator _partitionGroupsIterator;
+
     std::pair<Value, Value> _firstPartOfNextGroup;
     // Only used when '_sorted' is true.
     boost::optional<Document> _firstDocOfNextGroup;
@@ -47,12 +47,15 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/operation_arena.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -139,6 +142,73 @@ TEST_F(DocumentSourceGroupTest, ShouldBeAbleToPauseLoadingWhileSpilled) {
     ASSERT_EQ(idSet.count(2), 1UL);
 }
 
+/**
+ * Groups 2000 documents into 500 groups with hash partitioned spilling enabled, and a memory limit
+ * small enough that the spilled partitions also have to be split again.
+ */
+void assertHashSpilledGroupsAreCorrect(const boost::intrusive_ptr<ExpressionContextForTest>& expCtx,
+                                       int numThreads) {
+    const bool oldHashSpill = internalDocumentSourceGroupHashSpill.load();
+    const int oldMaxThreads = internalDocumentSourceGroupMaxThreads.load();
+    internalDocumentSourceGroupHashSpill.store(true);
+    internalDocumentSourceGroupMaxThreads.store(numThreads);
+    ON_BLOCK_EXIT([&] {
+        internalDocumentSourceGroupHashSpill.store(oldHashSpill);
+        internalDocumentSourceGroupMaxThreads.store(oldMaxThreads);
+    });
+
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement sumStatement{"sum",
+                                       ExpressionFieldPath::parse(expCtx, "$value", vps),
+                                       AccumulationStatement::getFactory("$sum")};
+    AccumulationStatement firstStatement{"first",
+                                         ExpressionFieldPath::parse(expCtx, "$value", vps),
+                                         AccumulationStatement::getFactory("$first")};
+    auto group = DocumentSourceGroup::create(expCtx,
+                                             ExpressionFieldPath::parse(expCtx, "$key", vps),
+                                             {sumStatement, firstStatement},
+                                             maxMemoryUsageBytes);
+
+    const int numGroups = 500;
+    const int docsPerGroup = 4;
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < docsPerGroup; i++) {
+        for (int key = 0; key < numGroups; key++) {
+            inputs.push_back(Document{{"key", key}, {"value", i * numGroups + key}});
+        }
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    // The groups are returned in no particular order, and spilling does not change the results.
+    map<int, Document> results;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_TRUE(results.emplace(doc["_id"].coerceToInt(), doc).second);
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+
+    ASSERT_EQ(results.size(), size_t(numGroups));
+    for (int key = 0; key < numGroups; key++) {
+        const int sum = docsPerGroup * key + numGroups * docsPerGroup * (docsPerGroup - 1) / 2;
+        ASSERT_DOCUMENT_EQ(results[key],
+                           (Document{{"_id", key}, {"sum", sum}, {"first", key}}));
+    }
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldCorrectlyGroupWhenSpilledToHashPartitions) {
+    assertHashSpilledGroupsAreCorrect(getExpCtx(), 1);
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldCorrectlyGroupWhenSpilledToHashPartitionsOnSeveralThreads) {
+    assertHashSpilledGroupsAreCorrect(getExpCtx(), 4);
+}
+
 TEST_F(DocumentSourceGroupTest, ShouldErrorIfNotAllowedToSpillToDiskAndResultSetIsTooLarge) {
     auto expCtx = getExpCtx();
     const size_t maxMemoryUsageBytes = 1000;
@@ -189,6 +259,64 @@ TEST_F(DocumentSourceGroupTest, ShouldCorrectlyTrackMemoryUsageBetweenPauses) {
     ASSERT_THROWS_CODE(group->getNext(), AssertionException, 16945);
 }
 
+/**
+ * A source which creates each of its documents, {_id: <n>, str: <150 chars>}, when it returns it.
+ */
+class DocumentSourceGenerator : public DocumentSourceMock {
+public:
+    explicit DocumentSourceGenerator(int numDocs) : DocumentSourceMock({}), _numDocs(numDocs) {}
+
+    GetNextResult getNext() final {
+        if (_nextId == _numDocs) {
+            return GetNextResult::makeEOF();
+        }
+        const int id = _nextId++;
+        return Document{{"_id", id}, {"str", string(150, 'a' + id % 26)}};
+    }
+
+private:
+    const int _numDocs;
+    int _nextId = 0;
+};
+
+TEST_F(DocumentSourceGroupTest, ShouldNotKeepArenaChunksAliveWhileGrouping) {
+    auto expCtx = getExpCtx();
+    expCtx->inMongos = true;  // Disallow external sort.
+                              // This is the only way to do this in a debug build.
+
+    // Each group keeps a value from one of every 200 input documents, which would otherwise leave
+    // a survivor in nearly every chunk read during the blocking phase.
+    const int kNumDocs = 6000;
+    const int kDocsPerGroup = 200;
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement firstStatement{"str",
+                                         ExpressionFieldPath::parse(expCtx, "$str", vps),
+                                         AccumulationStatement::getFactory("$first")};
+    auto groupByExpression = Expression::parseExpression(
+        expCtx, BSON("$trunc" << BSON("$divide" << BSON_ARRAY("$_id" << kDocsPerGroup))), vps);
+    auto group = DocumentSourceGroup::create(expCtx, groupByExpression, {firstStatement});
+    intrusive_ptr<DocumentSourceGenerator> source(new DocumentSourceGenerator(kNumDocs));
+    group->setSource(source.get());
+
+    const size_t liveChunksBefore = OperationArena::numLiveChunks();
+    OperationArena arena;
+    {
+        OperationArena::Scope scope(&arena);
+        auto result = group->getNext();
+        ASSERT_TRUE(result.isAdvanced());
+    }
+
+    // Had the input been read from the arena, the groups would be keeping most of the chunks it
+    // filled alive.
+    ASSERT_LTE(OperationArena::numLiveChunks(), liveChunksBefore + 1);
+
+    size_t numGroups = 1;
+    while (group->getNext().isAdvanced()) {
+        ++numGroups;
+    }
+    ASSERT_EQ(static_cast<size_t>(kNumDocs / kDocsPerGroup), numGroups);
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
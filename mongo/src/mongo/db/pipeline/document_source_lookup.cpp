@@ -40,6 +40,7 @@
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/stringutils.h"
 
 namespace mongo {
 
@@ -74,7 +75,8 @@ DocumentSourceLookUp::DocumentSourceLookUp(NamespaceString fromNs,
       _fromNs(std::move(fromNs)),
       _as(std::move(as)),
       _variables(pExpCtx->variables),
-      _variablesParseState(pExpCtx->variablesParseState.copyWith(_variables.useIdGenerator())) {
+      _variablesParseState(pExpCtx->variablesParseState.copyWith(_variables.useIdGenerator())),
+      _batchSize(std::max(1, internalDocumentSourceLookupBatchSize.load())) {
     const auto& resolvedNamespace = pExpCtx->getResolvedNamespace(_fromNs);
     _resolvedNs = resolvedNamespace.ns;
     _resolvedPipeline = resolvedNamespace.pipeline;
@@ -201,6 +203,42 @@ BSONObj buildEqualityOrQuery(const std::string& fieldName, const BSONArray& valu
     return orBuilder.obj();
 }
 
+/**
+ * Returns whether the foreign documents matching {<foreignField>: {$eq: 'value'}} are exactly the
+ * ones with 'value' among the values visited by document_path_support::visitAllValuesAtPath(),
+ * so that they can be found by hashing those values. Null matches missing fields, a regular
+ * expression is compared as a pattern by $in, and an array also matches an array as a whole.
+ */
+bool canHashJoinOnValue(const Value& value) {
+    switch (value.getType()) {
+        case BSONType::EOO:
+        case BSONType::jstNULL:
+        case BSONType::Undefined:
+        case BSONType::RegEx:
+        case BSONType::Array:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/**
+ * Returns whether the matcher and document_path_support::visitAllValuesAtPath() agree on the values
+ * at 'path'. They differ in how they treat numeric path components after the first one.
+ */
+bool canHashJoinOnPath(const FieldPath& path) {
+    for (size_t i = 1; i < path.getPathLength(); i++) {
+        if (parseUnsignedBase10Integer(path.getFieldName(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Stop adding local values to the query of a batch once they take this many bytes. The remaining
+// input documents of the batch are looked up on their own.
+const int kMaxBatchedLocalValuesBytes = 4 * 1024 * 1024;
+
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
@@ -210,17 +248,24 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
         return unwindResult();
     }
 
+    // If we have not absorbed a $unwind, we cannot absorb a $match. If we have absorbed a $unwind,
+    // '_unwindSrc' would be non-null, and we would not have made it here.
+    invariant(!_matchSrc);
+
+    if (_batchSize > 1 && !wasConstructedWithPipelineSyntax() &&
+        canHashJoinOnPath(*_foreignField)) {
+        return batchedResult();
+    }
+
     auto nextInput = pSource->getNext();
     if (!nextInput.isAdvanced()) {
         return nextInput;
     }
 
-    auto inputDoc = nextInput.releaseDocument();
-
-    // If we have not absorbed a $unwind, we cannot absorb a $match. If we have absorbed a $unwind,
-    // '_unwindSrc' would be non-null, and we would not have made it here.
-    invariant(!_matchSrc);
+    return lookUpSingleDocument(nextInput.releaseDocument());
+}
 
+Document DocumentSourceLookUp::lookUpSingleDocument(Document inputDoc) {
     if (!wasConstructedWithPipelineSyntax()) {
         auto matchStage =
             makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
@@ -249,6 +294,114 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     return output.freeze();
 }
 
+DocumentSource::GetNextResult DocumentSourceLookUp::batchedResult() {
+    while (_joinedBatch.empty()) {
+        // Return the status which ended the previous batch before reading a new one.
+        const auto status = _joinedBatchStatus;
+        _joinedBatchStatus = GetNextResult::ReturnStatus::kAdvanced;
+        if (status == GetNextResult::ReturnStatus::kEOF) {
+            return GetNextResult::makeEOF();
+        } else if (status == GetNextResult::ReturnStatus::kPauseExecution) {
+            return GetNextResult::makePauseExecution();
+        }
+
+        std::vector<Document> inputs;
+        do {
+            _joinedBatchStatus = pSource->getNextBatch(&inputs, _batchSize - inputs.size());
+        } while (_joinedBatchStatus == GetNextResult::ReturnStatus::kAdvanced &&
+                 inputs.size() < _batchSize);
+
+        joinBatch(std::move(inputs));
+    }
+
+    Document out = std::move(_joinedBatch.front());
+    _joinedBatch.pop_front();
+    return std::move(out);
+}
+
+void DocumentSourceLookUp::joinBatch(std::vector<Document> inputs) {
+    // Map each local value to the inputs it appears in, using the equality of the foreign
+    // collection's collation, like the query would.
+    auto inputsByValue =
+        _fromExpCtx->getValueComparator().makeUnorderedValueMap<std::vector<size_t>>();
+    std::vector<bool> isBatched(inputs.size(), false);
+    BSONArrayBuilder localValues;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        std::vector<Value> values;
+        document_path_support::visitAllValuesAtPath(
+            inputs[i], *_localField, [&](const Value& nextValue) { values.push_back(nextValue); });
+
+        isBatched[i] = !values.empty() && localValues.len() < kMaxBatchedLocalValuesBytes &&
+            std::all_of(values.begin(), values.end(), canHashJoinOnValue);
+        if (!isBatched[i]) {
+            continue;
+        }
+
+        for (auto&& value : values) {
+            auto& matchingInputs = inputsByValue[value];
+            if (matchingInputs.empty()) {
+                localValues << value;
+            }
+            if (matchingInputs.empty() || matchingInputs.back() != i) {
+                matchingInputs.push_back(i);
+            }
+        }
+    }
+
+    std::vector<std::vector<Value>> results(inputs.size());
+    if (!inputsByValue.empty()) {
+        // {$match: {<foreignFieldName>: {$in: <localValues>}}}
+        _resolvedPipeline.back() =
+            BSON("$match" << BSON(_foreignField->fullPath() << BSON("$in" << localValues.arr())));
+
+        // 'let' variables are only allowed with pipeline syntax, so no input document is needed to
+        // build the pipeline.
+        auto pipeline = buildPipeline(Document());
+
+        std::vector<int> objsizes(inputs.size(), 0);
+        std::vector<size_t> matchingInputs;
+        while (auto result = pipeline->getNext()) {
+            matchingInputs.clear();
+            document_path_support::visitAllValuesAtPath(
+                *result, *_foreignField, [&](const Value& nextValue) {
+                    auto it = inputsByValue.find(nextValue);
+                    if (it != inputsByValue.end()) {
+                        matchingInputs.insert(
+                            matchingInputs.end(), it->second.begin(), it->second.end());
+                    }
+                });
+
+            // A foreign document is added once to an input, even if it matches several of its
+            // local values.
+            std::sort(matchingInputs.begin(), matchingInputs.end());
+            matchingInputs.erase(std::unique(matchingInputs.begin(), matchingInputs.end()),
+                                 matchingInputs.end());
+
+            for (auto i : matchingInputs) {
+                objsizes[i] += result->getApproximateSize();
+                uassert(4568,
+                        str::stream() << "Total size of documents in " << _fromNs.coll()
+                                      << " matching pipeline "
+                                      << getUserPipelineDefinition()
+                                      << " exceeds maximum document size",
+                        objsizes[i] <= BSONObjMaxInternalSize);
+                results[i].emplace_back(*result);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (!isBatched[i]) {
+            _joinedBatch.push_back(lookUpSingleDocument(std::move(inputs[i])));
+            continue;
+        }
+
+        MutableDocument output(std::move(inputs[i]));
+        output.setNestedField(_as, Value(std::move(results[i])));
+        _joinedBatch.push_back(output.freeze());
+    }
+}
+
 std::unique_ptr<Pipeline, Pipeline::Deleter> DocumentSourceLookUp::buildPipeline(
     const Document& inputDoc) {
     // Copy all 'let' variables into the foreign pipeline's expression context.
@@ -432,6 +585,7 @@ std::string DocumentSourceLookUp::getUserPipelineDefinition() {
 }
 
 void DocumentSourceLookUp::doDispose() {
+    _joinedBatch.clear();
     if (_pipeline) {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
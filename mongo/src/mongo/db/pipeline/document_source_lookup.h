@@ -29,6 +29,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_match.h"
@@ -244,6 +245,28 @@ private:
 
     GetNextResult unwindResult();
 
+    /**
+     * getNext() for a $lookup with localField/foreignField syntax and no absorbed $unwind, when
+     * 'internalDocumentSourceLookupBatchSize' is greater than one. Reads a batch of input documents
+     * and joins them with the foreign collection using a single query, see joinBatch().
+     */
+    GetNextResult batchedResult();
+
+    /**
+     * Looks up the foreign documents matching all the documents of 'inputs' with one query for
+     * all of their local values, and hash-joins the results back to the input documents. Input
+     * documents with local values the hash join cannot match exactly like the query would (null,
+     * regular expressions, arrays within arrays) are looked up on their own. Appends the output
+     * documents to '_joinedBatch', in the order of 'inputs'.
+     */
+    void joinBatch(std::vector<Document> inputs);
+
+    /**
+     * Looks up the foreign documents matching 'inputDoc' and returns it with the results added
+     * under the 'as' field. Only for localField/foreignField syntax without an absorbed $unwind.
+     */
+    Document lookUpSingleDocument(Document inputDoc);
+
     /**
      * Copies 'vars' and 'vps' to the Variables and VariablesParseState objects in 'expCtx'. These
      * copies provide access to 'let' defined variables in sub-pipeline execution.
@@ -332,6 +355,12 @@ private:
     std::unique_ptr<Pipeline, Pipeline::Deleter> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
+
+    // The following members are used by batchedResult() to hold the output of the last batch
+    // joined, followed by the status which ended the batch of input documents.
+    const size_t _batchSize;
+    std::deque<Document> _joinedBatch;
+    GetNextResult::ReturnStatus _joinedBatchStatus = GetNextResult::ReturnStatus::kAdvanced;
 };
 
 }  // namespace mongo
@@ -47,6 +47,7 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -610,6 +611,78 @@ TEST_F(DocumentSourceLookUpTest, ShouldPropagatePauses) {
     lookup->dispose();
 }
 
+TEST_F(DocumentSourceLookUpTest, ShouldJoinBatchesOfInputDocumentsWithOneQuery) {
+    const int oldBatchSize = internalDocumentSourceLookupBatchSize.load();
+    internalDocumentSourceLookupBatchSize.store(10);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceLookupBatchSize.store(oldBatchSize); });
+
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "foreignId"_sd},
+                                         {"foreignField", "key"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    // The null local value is looked up on its own, since it also matches a missing foreign field.
+    auto mockLocalSource =
+        DocumentSourceMock::create({Document{{"foreignId", 0}},
+                                    Document{{"foreignId", vector<Value>{Value(1), Value(2)}}},
+                                    DocumentSource::GetNextResult::makePauseExecution(),
+                                    Document{{"foreignId", 3}},
+                                    Document{{"foreignId", BSONNULL}}});
+    lookup->setSource(mockLocalSource.get());
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{{"_id", 0}, {"key", 0}},
+        Document{{"_id", 1}, {"key", vector<Value>{Value(1), Value(2)}}},
+        Document{{"_id", 2}, {"key", 2}},
+        Document{{"_id", 3}}};
+    lookup->injectMongoProcessInterface(
+        std::make_shared<MockMongoProcessInterface>(std::move(mockForeignContents)));
+
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        (Document{{"foreignId", 0},
+                  {"foreignDocs", vector<Value>{Value(Document{{"_id", 0}, {"key", 0}})}}}));
+
+    // A foreign document matching several local values of an input is only added to it once.
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        (Document{{"foreignId", vector<Value>{Value(1), Value(2)}},
+                  {"foreignDocs",
+                   vector<Value>{
+                       Value(Document{{"_id", 1}, {"key", vector<Value>{Value(1), Value(2)}}}),
+                       Value(Document{{"_id", 2}, {"key", 2}})}}}));
+
+    ASSERT_TRUE(lookup->getNext().isPaused());
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       (Document{{"foreignId", 3}, {"foreignDocs", vector<Value>{}}}));
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        (Document{{"foreignId", BSONNULL},
+                  {"foreignDocs", vector<Value>{Value(Document{{"_id", 3}})}}}));
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    lookup->dispose();
+}
+
 TEST_F(DocumentSourceLookUpTest, ShouldPropagatePausesWhileUnwinding) {
     auto expCtx = getExpCtx();
     NamespaceString fromNs("test", "foreign");
@@ -40,6 +40,7 @@
 #include "mongo/db/pipeline/document_path_support.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/stringutils.h"
 
@@ -86,14 +87,7 @@ DocumentSource::GetNextResult DocumentSourceMatch::getNext() {
 
     auto nextInput = pSource->getNext();
     for (; nextInput.isAdvanced(); nextInput = pSource->getNext()) {
-        // MatchExpression only takes BSON documents, so we have to make one. As an optimization,
-        // only serialize the fields we need to do the match.
-        BSONObj toMatch = _dependencies.needWholeDocument
-            ? nextInput.getDocument().toBson()
-            : document_path_support::documentToBsonWithPaths(nextInput.getDocument(),
-                                                             _dependencies.fields);
-
-        if (_expression->matchesBSON(toMatch)) {
+        if (matches(nextInput.getDocument())) {
             return nextInput;
         }
 
@@ -108,6 +102,76 @@ DocumentSource::GetNextResult DocumentSourceMatch::getNext() {
     return nextInput;
 }
 
+DocumentSource::GetNextResult::ReturnStatus DocumentSourceMatch::getNextBatch(
+    std::vector<Document>* batch, size_t maxDocs) {
+    pExpCtx->checkForInterrupt();
+
+    // The user facing error should have been generated earlier.
+    massert(17309, "Should never call getNext on a $match stage with $text clause", !_isTextQuery);
+
+    // Filter each batch of the child in place, until enough documents matched to fill the batch.
+    const size_t targetSize = batch->size() + maxDocs;
+    while (true) {
+        const size_t start = batch->size();
+        const auto status = pSource->getNextBatch(batch, targetSize - start);
+        filterBatch(batch, start);
+
+        if (status != GetNextResult::ReturnStatus::kAdvanced || batch->size() == targetSize) {
+            return status;
+        }
+    }
+}
+
+void DocumentSourceMatch::filterBatch(std::vector<Document>* batch, size_t start) {
+    if (!_columnarMatcherInitialized) {
+        // The expression no longer changes once documents flow through the stage.
+        if (internalQueryEnableColumnarMatcher.load()) {
+            _columnarMatcher = ColumnarMatcher::compile(_expression.get());
+        }
+        _columnarMatcherInitialized = true;
+    }
+
+    if (!_columnarMatcher) {
+        batch->erase(std::remove_if(batch->begin() + start,
+                                    batch->end(),
+                                    [this](const Document& doc) { return !matches(doc); }),
+                     batch->end());
+        return;
+    }
+
+    std::vector<BSONObj> toMatch;
+    toMatch.reserve(batch->size() - start);
+    for (size_t i = start; i < batch->size(); ++i) {
+        toMatch.push_back(toMatchBson((*batch)[i]));
+    }
+
+    std::vector<char> results;
+    _columnarMatcher->matchBatch(toMatch, &results);
+
+    size_t kept = start;
+    for (size_t i = start; i < batch->size(); ++i) {
+        if (results[i - start]) {
+            if (kept != i) {
+                (*batch)[kept] = std::move((*batch)[i]);
+            }
+            ++kept;
+        }
+    }
+    batch->resize(kept);
+}
+
+bool DocumentSourceMatch::matches(const Document& doc) const {
+    return _expression->matchesBSON(toMatchBson(doc));
+}
+
+BSONObj DocumentSourceMatch::toMatchBson(const Document& doc) const {
+    // MatchExpression only takes BSON documents, so we have to make one. As an optimization, only
+    // serialize the fields we need to do the match.
+    return _dependencies.needWholeDocument
+        ? doc.toBson()
+        : document_path_support::documentToBsonWithPaths(doc, _dependencies.fields);
+}
+
 Pipeline::SourceContainer::iterator DocumentSourceMatch::doOptimizeAt(
     Pipeline::SourceContainer::iterator itr, Pipeline::SourceContainer* container) {
     invariant(*itr == this);
@@ -32,6 +32,7 @@
 #include <utility>
 
 #include "mongo/client/connpool.h"
+#include "mongo/db/matcher/columnar_matcher.h"
 #include "mongo/db/matcher/matcher.h"
 #include "mongo/db/pipeline/document_source.h"
 
@@ -42,6 +43,8 @@ public:
     virtual ~DocumentSourceMatch() = default;
 
     GetNextResult getNext() override;
+    GetNextResult::ReturnStatus getNextBatch(std::vector<Document>* batch,
+                                             size_t maxDocs) override;
     boost::intrusive_ptr<DocumentSource> optimize() final;
     BSONObjSet getOutputSorts() final {
         return pSource ? pSource->getOutputSorts()
@@ -159,8 +162,28 @@ protected:
                         const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
 private:
+    /**
+     * Returns whether 'doc' matches the predicate of this stage.
+     */
+    bool matches(const Document& doc) const;
+
+    /**
+     * Returns the BSON form of 'doc' that the match expression runs against.
+     */
+    BSONObj toMatchBson(const Document& doc) const;
+
+    /**
+     * Removes the documents from position 'start' of 'batch' onwards that do not match.
+     */
+    void filterBatch(std::vector<Document>* batch, size_t start);
+
     std::unique_ptr<MatchExpression> _expression;
 
+    // Compiled form of '_expression' used by getNextBatch(), made on the first batch. It stays null
+    // if it is disabled or '_expression' cannot be compiled.
+    std::unique_ptr<ColumnarMatcher> _columnarMatcher;
+    bool _columnarMatcherInitialized = false;
+
     BSONObj _predicate;
     const bool _isTextQuery;
 
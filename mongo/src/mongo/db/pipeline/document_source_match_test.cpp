@@ -493,6 +493,40 @@ TEST_F(DocumentSourceMatchTest, ShouldPropagatePauses) {
     ASSERT_TRUE(match->getNext().isEOF());
 }
 
+TEST_F(DocumentSourceMatchTest, ShouldFilterBatchesAndPropagatePauses) {
+    using ReturnStatus = DocumentSource::GetNextResult::ReturnStatus;
+    auto match = DocumentSourceMatch::create(BSON("a" << 1), getExpCtx());
+    auto mock = DocumentSourceMock::create({Document{{"a", 1}, {"b", 0}},
+                                            Document{{"a", 2}},
+                                            Document{{"a", 1}, {"b", 1}},
+                                            DocumentSource::GetNextResult::makePauseExecution(),
+                                            Document{{"a", 2}},
+                                            Document{{"a", 1}, {"b", 2}},
+                                            Document{{"a", 1}, {"b", 3}}});
+    match->setSource(mock.get());
+
+    // The documents which match before the pause are returned along with it.
+    std::vector<Document> batch;
+    ASSERT(match->getNextBatch(&batch, 10) == ReturnStatus::kPauseExecution);
+    ASSERT_EQ(batch.size(), 2UL);
+    ASSERT_DOCUMENT_EQ(batch[0], (Document{{"a", 1}, {"b", 0}}));
+    ASSERT_DOCUMENT_EQ(batch[1], (Document{{"a", 1}, {"b", 1}}));
+
+    // A full batch stops before the end of the input, and the rest can be read with getNext().
+    batch.clear();
+    ASSERT(match->getNextBatch(&batch, 1) == ReturnStatus::kAdvanced);
+    ASSERT_EQ(batch.size(), 1UL);
+    ASSERT_DOCUMENT_EQ(batch[0], (Document{{"a", 1}, {"b", 2}}));
+
+    auto next = match->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"a", 1}, {"b", 3}}));
+
+    batch.clear();
+    ASSERT(match->getNextBatch(&batch, 10) == ReturnStatus::kEOF);
+    ASSERT_TRUE(batch.empty());
+}
+
 TEST_F(DocumentSourceMatchTest, ShouldCorrectlyJoinWithSubsequentMatch) {
     const auto match = DocumentSourceMatch::create(BSON("a" << 1), getExpCtx());
     const auto secondMatch = DocumentSourceMatch::create(BSON("b" << 1), getExpCtx());
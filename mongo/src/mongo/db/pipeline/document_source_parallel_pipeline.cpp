@@ -0,0 +1,295 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_parallel_pipeline.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+
+constexpr StringData DocumentSourceParallelPipeline::kStageName;
+
+/**
+ * The first stage of the pipeline of each worker. Returns the documents of the morsels taken from
+ * the DocumentSourceParallelPipeline.
+ */
+class DocumentSourceParallelPipeline::MorselSource final : public DocumentSource {
+public:
+    MorselSource(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                 DocumentSourceParallelPipeline* parent)
+        : DocumentSource(expCtx), _parent(parent) {}
+
+    GetNextResult getNext() final {
+        pExpCtx->checkForInterrupt();
+
+        if (!waitForDocuments()) {
+            return GetNextResult::makeEOF();
+        }
+        return std::move(_morsel[_position++]);
+    }
+
+    GetNextResult::ReturnStatus getNextBatch(std::vector<Document>* batch, size_t maxDocs) final {
+        pExpCtx->checkForInterrupt();
+
+        if (!waitForDocuments()) {
+            return GetNextResult::ReturnStatus::kEOF;
+        }
+
+        const auto begin = _morsel.begin() + _position;
+        const auto end = begin + std::min(maxDocs, _morsel.size() - _position);
+        std::move(begin, end, std::back_inserter(*batch));
+        _position = end - _morsel.begin();
+        return GetNextResult::ReturnStatus::kAdvanced;
+    }
+
+    const char* getSourceName() const final {
+        return "$_internalMorselSource";
+    }
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        StageConstraints constraints(StreamType::kStreaming,
+                                     PositionRequirement::kFirst,
+                                     HostTypeRequirement::kNone,
+                                     DiskUseRequirement::kNoDiskUse,
+                                     FacetRequirement::kNotAllowed);
+        constraints.requiresInputDocSource = false;
+        return constraints;
+    }
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final {
+        // The morsels are described by the DocumentSourceParallelPipeline.
+        return Value();
+    }
+
+private:
+    /**
+     * Returns true once there is a document left in '_morsel', or false if there are no more.
+     */
+    bool waitForDocuments() {
+        while (_position == _morsel.size()) {
+            _morsel.clear();
+            _position = 0;
+            if (!_parent->waitForMorsel(&_morsel)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    DocumentSourceParallelPipeline* const _parent;
+
+    std::vector<Document> _morsel;
+    size_t _position = 0;
+};
+
+boost::intrusive_ptr<DocumentSourceParallelPipeline> DocumentSourceParallelPipeline::create(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    std::vector<BSONObj> workerPipeline,
+    size_t numWorkers) {
+    return new DocumentSourceParallelPipeline(expCtx, std::move(workerPipeline), numWorkers);
+}
+
+DocumentSourceParallelPipeline::DocumentSourceParallelPipeline(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    std::vector<BSONObj> workerPipeline,
+    size_t numWorkers)
+    : DocumentSource(expCtx),
+      _workerPipelineSpec(std::move(workerPipeline)),
+      _numWorkers(numWorkers) {
+    invariant(_numWorkers > 0);
+
+    for (size_t i = 0; i < _numWorkers; i++) {
+        // Like on the shards of a sharded aggregation, the workers output partial results which
+        // the rest of the pipeline merges.
+        auto workerExpCtx = expCtx->copyWith(expCtx->ns, expCtx->uuid);
+        workerExpCtx->needsMerge = true;
+
+        auto pipeline = uassertStatusOK(Pipeline::parse(_workerPipelineSpec, workerExpCtx));
+        pipeline->addInitialSource(new MorselSource(workerExpCtx, this));
+
+        // Each worker uses its own OperationContext, and disposes of its pipeline before exiting.
+        pipeline.get_deleter().dismissDisposal();
+        _workerPipelines.push_back(std::move(pipeline));
+    }
+}
+
+DocumentSourceParallelPipeline::~DocumentSourceParallelPipeline() {
+    stopWorkers();
+}
+
+DocumentSource::GetNextResult DocumentSourceParallelPipeline::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    if (!_started) {
+        startWorkers();
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (true) {
+        if (!_output.empty()) {
+            Document next = std::move(_output.front());
+            _output.pop_front();
+            _outputSpaceCV.notify_one();
+            return std::move(next);
+        }
+
+        uassertStatusOK(_workerStatus);
+        if (_numWorkersDone == _workers.size()) {
+            return GetNextResult::makeEOF();
+        }
+
+        // Keep every worker supplied with one morsel ahead. Reading the source stage must happen
+        // on this thread, since it may take locks on behalf of this operation.
+        if (!_inputExhausted && _morsels.size() < _workers.size()) {
+            std::vector<Document> morsel;
+            lk.unlock();
+            auto status = pSource->getNextBatch(&morsel, kMorselSize);
+            lk.lock();
+
+            invariant(status != GetNextResult::ReturnStatus::kPauseExecution);
+            if (!morsel.empty()) {
+                _morsels.push_back(std::move(morsel));
+                _morselsCV.notify_one();
+            }
+            if (status == GetNextResult::ReturnStatus::kEOF) {
+                _inputExhausted = true;
+                _morselsCV.notify_all();
+            }
+            continue;
+        }
+
+        pExpCtx->opCtx->waitForConditionOrInterrupt(_consumerCV, lk);
+    }
+}
+
+bool DocumentSourceParallelPipeline::waitForMorsel(std::vector<Document>* morsel) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _morselsCV.wait(lk, [&] { return _stopped || _inputExhausted || !_morsels.empty(); });
+    if (_stopped || _morsels.empty()) {
+        return false;
+    }
+
+    *morsel = std::move(_morsels.front());
+    _morsels.pop_front();
+    _consumerCV.notify_one();
+    return true;
+}
+
+void DocumentSourceParallelPipeline::runWorker(size_t workerIndex,
+                                               ServiceContext* serviceContext) {
+    Client::initThread("parallelAggregationWorker", serviceContext, nullptr);
+    auto opCtx = cc().makeOperationContext();
+
+    auto& pipeline = _workerPipelines[workerIndex];
+    pipeline->reattachToOperationContext(opCtx.get());
+
+    Status status = Status::OK();
+    try {
+        while (auto next = pipeline->getNext()) {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            _outputSpaceCV.wait(
+                lk, [&] { return _stopped || _output.size() < kMaxBufferedOutputDocs; });
+            if (_stopped) {
+                break;
+            }
+
+            _output.push_back(std::move(*next));
+            _consumerCV.notify_one();
+        }
+    } catch (const DBException& ex) {
+        status = ex.toStatus();
+    }
+
+    pipeline->dispose(opCtx.get());
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (!status.isOK() && _workerStatus.isOK()) {
+        _workerStatus = status;
+    }
+    ++_numWorkersDone;
+    _consumerCV.notify_one();
+}
+
+void DocumentSourceParallelPipeline::startWorkers() {
+    invariant(!_started);
+    _started = true;
+
+    auto serviceContext = pExpCtx->opCtx->getServiceContext();
+    for (size_t i = 0; i < _workerPipelines.size(); i++) {
+        _workers.emplace_back([this, i, serviceContext] { runWorker(i, serviceContext); });
+    }
+}
+
+void DocumentSourceParallelPipeline::stopWorkers() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _stopped = true;
+    }
+    _morselsCV.notify_all();
+    _outputSpaceCV.notify_all();
+
+    for (auto&& worker : _workers) {
+        worker.join();
+    }
+    _workers.clear();
+
+    if (!_started) {
+        // The pipelines of workers which never ran are disposed of here instead.
+        for (auto&& pipeline : _workerPipelines) {
+            pipeline->dispose(pExpCtx->opCtx);
+        }
+        _started = true;
+    }
+    _workerPipelines.clear();
+    _morsels.clear();
+    _output.clear();
+}
+
+void DocumentSourceParallelPipeline::doDispose() {
+    stopWorkers();
+}
+
+Value DocumentSourceParallelPipeline::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    std::vector<Value> pipeline;
+    for (auto&& stage : _workerPipelineSpec) {
+        pipeline.emplace_back(stage);
+    }
+    return Value(Document{{kStageName,
+                           Document{{"workers", static_cast<long long>(_numWorkers)},
+                                    {"pipeline", Value(std::move(pipeline))}}}});
+}
+
+}  // namespace mongo
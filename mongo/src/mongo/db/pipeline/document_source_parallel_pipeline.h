@@ -0,0 +1,152 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+
+/**
+ * Runs a pipeline on several threads over the documents of its source stage. The documents are
+ * read from the source stage on the thread calling getNext(), and handed out in batches, called
+ * morsels, to the worker threads. Each worker thread runs its own copy of the pipeline over the
+ * morsels it receives, and this stage returns the documents output by all of them, in no
+ * particular order.
+ *
+ * This is how a mongod parallelizes an aggregation on a single collection: the pipeline following
+ * the DocumentSourceCursor is split like it would be for a sharded collection. The shards half
+ * runs in the workers of this stage, and the merge half runs after it, on the calling thread. Not
+ * parsed from user requests; see PipelineD::addParallelPipeline().
+ */
+class DocumentSourceParallelPipeline final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalParallelPipeline"_sd;
+
+    // Max number of documents in a morsel.
+    static const size_t kMorselSize = 1024;
+
+    // Max number of documents output by the workers and not yet returned by getNext(), beyond
+    // which the workers wait.
+    static const size_t kMaxBufferedOutputDocs = 16 * 1024;
+
+    /**
+     * Creates a stage running 'workerPipeline', which must only contain stages which can be
+     * executed without an OperationContext of the client, on 'numWorkers' threads.
+     */
+    static boost::intrusive_ptr<DocumentSourceParallelPipeline> create(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        std::vector<BSONObj> workerPipeline,
+        size_t numWorkers);
+
+    ~DocumentSourceParallelPipeline();
+
+    GetNextResult getNext() final;
+
+    const char* getSourceName() const final {
+        return kStageName.rawData();
+    }
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        return {StreamType::kStreaming,
+                PositionRequirement::kNone,
+                HostTypeRequirement::kNone,
+                DiskUseRequirement::kNoDiskUse,
+                FacetRequirement::kNotAllowed};
+    }
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+protected:
+    void doDispose() final;
+
+private:
+    class MorselSource;
+
+    DocumentSourceParallelPipeline(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                   std::vector<BSONObj> workerPipeline,
+                                   size_t numWorkers);
+
+    /**
+     * Starts the worker threads. Called by the first getNext().
+     */
+    void startWorkers();
+
+    /**
+     * Stops the worker threads and waits for them to exit.
+     */
+    void stopWorkers();
+
+    /**
+     * Runs the pipeline of worker 'workerIndex', on a Client of 'serviceContext', until it is
+     * exhausted or this stage is disposed.
+     */
+    void runWorker(size_t workerIndex, ServiceContext* serviceContext);
+
+    /**
+     * Called by the MorselSource of the worker pipelines. Waits for the next morsel and moves it
+     * into 'morsel'. Returns false if there are no more morsels.
+     */
+    bool waitForMorsel(std::vector<Document>* morsel);
+
+    const std::vector<BSONObj> _workerPipelineSpec;
+    const size_t _numWorkers;
+    std::vector<std::unique_ptr<Pipeline, Pipeline::Deleter>> _workerPipelines;
+    std::vector<stdx::thread> _workers;
+    bool _started = false;
+
+    stdx::mutex _mutex;
+
+    // Signaled when a morsel is queued, when the input is exhausted, and when the workers are
+    // stopped. Waited on by the workers in waitForMorsel().
+    stdx::condition_variable _morselsCV;
+
+    // Signaled when an output document is returned and when the workers are stopped. Waited on by
+    // the workers when '_output' is full.
+    stdx::condition_variable _outputSpaceCV;
+
+    // Signaled when a worker outputs a document, takes a morsel, or exits. Waited on by getNext().
+    stdx::condition_variable _consumerCV;
+
+    // All protected by '_mutex'.
+    std::deque<std::vector<Document>> _morsels;
+    bool _inputExhausted = false;
+    std::deque<Document> _output;
+    size_t _numWorkersDone = 0;
+    Status _workerStatus = Status::OK();
+    bool _stopped = false;
+};
+
+}  // namespace mongo
@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <deque>
+#include <set>
+
+#include "mongo/bson/json.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/document_source_parallel_pipeline.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+// This provides access to getExpCtx(), but we'll use a different name for this test suite.
+using DocumentSourceParallelPipelineTest = AggregationContextFixture;
+
+TEST_F(DocumentSourceParallelPipelineTest, ShouldReturnOutputOfAllWorkers) {
+    const int numDocs = 3 * DocumentSourceParallelPipeline::kMorselSize + 7;
+    std::deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < numDocs; i++) {
+        inputs.push_back(Document{{"_id", i}, {"a", i % 2}});
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+
+    auto parallel = DocumentSourceParallelPipeline::create(
+        getExpCtx(), {fromjson("{$match: {a: 0}}"), fromjson("{$project: {a: 0}}")}, 3);
+    parallel->setSource(mock.get());
+
+    std::set<int> ids;
+    auto next = parallel->getNext();
+    for (; next.isAdvanced(); next = parallel->getNext()) {
+        auto doc = next.releaseDocument();
+        ASSERT_VALUE_EQ(doc["a"], Value());
+        ASSERT_TRUE(ids.insert(doc["_id"].getInt()).second);
+    }
+    ASSERT_TRUE(next.isEOF());
+    ASSERT_TRUE(parallel->getNext().isEOF());
+
+    ASSERT_EQ(ids.size(), static_cast<size_t>((numDocs + 1) / 2));
+    for (auto&& id : ids) {
+        ASSERT_EQ(id % 2, 0);
+    }
+    parallel->dispose();
+}
+
+TEST_F(DocumentSourceParallelPipelineTest, ShouldStopWorkersWhenDisposedBeforeEOF) {
+    std::deque<DocumentSource::GetNextResult> inputs;
+    for (size_t i = 0; i < 4 * DocumentSourceParallelPipeline::kMorselSize; i++) {
+        inputs.push_back(Document{{"_id", static_cast<int>(i)}});
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+
+    auto parallel =
+        DocumentSourceParallelPipeline::create(getExpCtx(), {fromjson("{$match: {}}")}, 2);
+    parallel->setSource(mock.get());
+
+    ASSERT_TRUE(parallel->getNext().isAdvanced());
+    parallel->dispose();
+}
+
+TEST_F(DocumentSourceParallelPipelineTest, ShouldSerializeWorkerPipeline) {
+    auto parallel =
+        DocumentSourceParallelPipeline::create(getExpCtx(), {fromjson("{$match: {a: 1}}")}, 4);
+
+    std::vector<Value> serialization;
+    parallel->serializeToArray(serialization);
+    ASSERT_EQ(serialization.size(), 1UL);
+    ASSERT_VALUE_EQ(serialization[0],
+                    Value(fromjson("{$_internalParallelPipeline: "
+                                   "{workers: 4, pipeline: [{$match: {a: 1}}]}}")));
+    parallel->dispose();
+}
+
+}  // namespace
+}  // namespace mongo
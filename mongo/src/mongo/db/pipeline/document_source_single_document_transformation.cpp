@@ -67,6 +67,20 @@ DocumentSource::GetNextResult DocumentSourceSingleDocumentTransformation::getNex
     return _parsedTransform->applyTransformation(input.releaseDocument());
 }
 
+DocumentSource::GetNextResult::ReturnStatus DocumentSourceSingleDocumentTransformation::getNextBatch(
+    std::vector<Document>* batch, size_t maxDocs) {
+    pExpCtx->checkForInterrupt();
+
+    // Transform the batch of the child in place, releasing each input document as soon as it has
+    // been replaced by its output.
+    const size_t start = batch->size();
+    const auto status = pSource->getNextBatch(batch, maxDocs);
+    for (auto it = batch->begin() + start; it != batch->end(); ++it) {
+        *it = _parsedTransform->applyTransformation(Document(std::move(*it)));
+    }
+    return status;
+}
+
 intrusive_ptr<DocumentSource> DocumentSourceSingleDocumentTransformation::optimize() {
     _parsedTransform->optimize();
     return this;
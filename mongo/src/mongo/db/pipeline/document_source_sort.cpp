@@ -38,6 +38,8 @@
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/util/operation_arena.h"
 
 namespace mongo {
 
@@ -310,11 +312,15 @@ SortOptions DocumentSourceSort::makeSortOptions() const {
         opts.extSortAllowed = true;
         opts.tempDir = pExpCtx->tempDir;
     }
+    opts.parallelism = std::max(1, internalSorterMaxThreads.load());
 
     return opts;
 }
 
 DocumentSource::GetNextResult DocumentSourceSort::populate() {
+    // The sorter keeps every input document until it is returned, so leave them on the heap.
+    OperationArena::HeapScope heapScope;
+
     if (_mergingPresorted) {
         typedef DocumentSourceMergeCursors DSCursors;
         if (DSCursors* castedSource = dynamic_cast<DSCursors*>(pSource)) {
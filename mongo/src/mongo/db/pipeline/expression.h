@@ -44,9 +44,11 @@
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/variables.h"
 #include "mongo/db/query/datetime/date_time_support.h"
+#include "mongo/platform/decimal128.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/intrusive_counter.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/summation.h"
 
 namespace mongo {
 
@@ -645,6 +647,27 @@ public:
 
 class ExpressionAdd final : public ExpressionVariadic<ExpressionAdd> {
 public:
+    /**
+     * Running total of an $add. Keeps a compensated sum of the non-decimal operands and a separate
+     * decimal sum, and tracks the narrowest type able to hold the result.
+     */
+    class Sum {
+    public:
+        /**
+         * Adds 'val' to the total. Returns false if 'val' is nullish, in which case the result of
+         * the $add is null. Throws if 'val' is neither numeric nor a date.
+         */
+        bool add(const Value& val);
+
+        Value getValue() const;
+
+    private:
+        DoubleDoubleSummation _nonDecimalTotal;
+        Decimal128 _decimalTotal;
+        BSONType _totalType = NumberInt;
+        bool _haveDate = false;
+    };
+
     explicit ExpressionAdd(const boost::intrusive_ptr<ExpressionContext>& expCtx)
         : ExpressionVariadic<ExpressionAdd>(expCtx) {}
 
@@ -791,6 +814,11 @@ public:
     Value evaluate(const Document& root) const final;
     const char* getOpName() const final;
 
+    /**
+     * Compares 'lhs' against 'rhs' using the collation of this expression's context.
+     */
+    Value apply(const Value& lhs, const Value& rhs) const;
+
     CmpOp getOp() const {
         return cmpOp;
     }
@@ -1025,6 +1053,8 @@ public:
     explicit ExpressionDivide(const boost::intrusive_ptr<ExpressionContext>& expCtx)
         : ExpressionFixedArity<ExpressionDivide, 2>(expCtx) {}
 
+    static Value apply(const Value& lhs, const Value& rhs);
+
     Value evaluate(const Document& root) const final;
     const char* getOpName() const final;
 };
@@ -1359,6 +1389,8 @@ public:
     explicit ExpressionMod(const boost::intrusive_ptr<ExpressionContext>& expCtx)
         : ExpressionFixedArity<ExpressionMod, 2>(expCtx) {}
 
+    static Value apply(const Value& lhs, const Value& rhs);
+
     Value evaluate(const Document& root) const final;
     const char* getOpName() const final;
 };
@@ -1366,6 +1398,27 @@ public:
 
 class ExpressionMultiply final : public ExpressionVariadic<ExpressionMultiply> {
 public:
+    /**
+     * Running product of a $multiply. The double, long and decimal products are computed in
+     * parallel while tracking the narrowest type able to hold the result.
+     */
+    class Product {
+    public:
+        /**
+         * Multiplies the product by 'val'. Returns false if 'val' is nullish, in which case the
+         * result of the $multiply is null. Throws if 'val' is not numeric.
+         */
+        bool multiply(const Value& val);
+
+        Value getValue() const;
+
+    private:
+        double _doubleProduct = 1;
+        long long _longProduct = 1;
+        Decimal128 _decimalProduct;  // Initialized on encountering the first decimal.
+        BSONType _productType = NumberInt;
+    };
+
     explicit ExpressionMultiply(const boost::intrusive_ptr<ExpressionContext>& expCtx)
         : ExpressionVariadic<ExpressionMultiply>(expCtx) {}
 
@@ -1720,6 +1773,8 @@ public:
     explicit ExpressionSubtract(const boost::intrusive_ptr<ExpressionContext>& expCtx)
         : ExpressionFixedArity<ExpressionSubtract, 2>(expCtx) {}
 
+    static Value apply(const Value& lhs, const Value& rhs);
+
     Value evaluate(const Document& root) const final;
     const char* getOpName() const final;
 };
@@ -0,0 +1,341 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/expression_program.h"
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+/**
+ * Emits the instructions of an ExpressionProgram with a single recursive walk over the tree.
+ * Every node is given a fresh destination register, so each non-constant register is written at
+ * most once per run.
+ */
+class ExpressionProgram::Compiler {
+public:
+    explicit Compiler(ExpressionProgram* program) : _program(program) {}
+
+    /**
+     * Returns true if 'expr' is one of the operators with a dedicated instruction.
+     */
+    static bool isCompilable(const Expression* expr) {
+        return dynamic_cast<const ExpressionAdd*>(expr) ||
+            dynamic_cast<const ExpressionMultiply*>(expr) ||
+            dynamic_cast<const ExpressionSubtract*>(expr) ||
+            dynamic_cast<const ExpressionDivide*>(expr) ||
+            dynamic_cast<const ExpressionMod*>(expr) ||
+            dynamic_cast<const ExpressionCompare*>(expr) ||
+            dynamic_cast<const ExpressionCond*>(expr) ||
+            dynamic_cast<const ExpressionAnd*>(expr) || dynamic_cast<const ExpressionOr*>(expr) ||
+            dynamic_cast<const ExpressionNot*>(expr);
+    }
+
+    /**
+     * Compiles 'root' and lays out the register file: constants first, followed by the registers
+     * written by the program.
+     */
+    void compileRoot(const Expression* root) {
+        uint32_t result = compile(root);
+
+        const uint32_t numConstants = _constants.size();
+        auto relocate = [numConstants](uint32_t reg) {
+            return (reg & kConstantBit) ? (reg & ~kConstantBit) : reg + numConstants;
+        };
+        for (auto&& instruction : _program->_code) {
+            instruction.dst = relocate(instruction.dst);
+            instruction.lhs = relocate(instruction.lhs);
+            instruction.rhs = relocate(instruction.rhs);
+        }
+
+        _program->_resultRegister = relocate(result);
+        _program->_numConstants = numConstants;
+        _program->_registers = std::move(_constants);
+        _program->_registers.resize(numConstants + _numTemporaries);
+        _program->_sums.resize(_numSums);
+        _program->_products.resize(_numProducts);
+    }
+
+private:
+    // Constants and temporaries are numbered separately while compiling, and merged once the
+    // number of constants is known. Constant register numbers carry this bit until then.
+    static constexpr uint32_t kConstantBit = 1u << 31;
+
+    uint32_t compile(const Expression* expr) {
+        if (auto constant = dynamic_cast<const ExpressionConstant*>(expr)) {
+            _constants.push_back(constant->getValue());
+            return (_constants.size() - 1) | kConstantBit;
+        }
+        if (auto add = dynamic_cast<const ExpressionAdd*>(expr)) {
+            return compileAccumulation(
+                add, _numSums++, OpCode::kSumReset, OpCode::kSumAdd, OpCode::kSumResult);
+        }
+        if (auto multiply = dynamic_cast<const ExpressionMultiply*>(expr)) {
+            return compileAccumulation(multiply,
+                                       _numProducts++,
+                                       OpCode::kProductReset,
+                                       OpCode::kProductMultiply,
+                                       OpCode::kProductResult);
+        }
+        if (auto subtract = dynamic_cast<const ExpressionSubtract*>(expr)) {
+            return compileBinary(subtract, OpCode::kSubtract);
+        }
+        if (auto divide = dynamic_cast<const ExpressionDivide*>(expr)) {
+            return compileBinary(divide, OpCode::kDivide);
+        }
+        if (auto mod = dynamic_cast<const ExpressionMod*>(expr)) {
+            return compileBinary(mod, OpCode::kMod);
+        }
+        if (auto compare = dynamic_cast<const ExpressionCompare*>(expr)) {
+            return compileBinary(compare, OpCode::kCompare);
+        }
+        if (auto cond = dynamic_cast<const ExpressionCond*>(expr)) {
+            return compileCond(cond);
+        }
+        if (auto andExpr = dynamic_cast<const ExpressionAnd*>(expr)) {
+            return compileShortCircuit(andExpr, OpCode::kJumpIfFalse);
+        }
+        if (auto orExpr = dynamic_cast<const ExpressionOr*>(expr)) {
+            return compileShortCircuit(orExpr, OpCode::kJumpIfTrue);
+        }
+        if (auto notExpr = dynamic_cast<const ExpressionNot*>(expr)) {
+            uint32_t operand = compile(notExpr->getOperandList()[0].get());
+            uint32_t dst = newTemporary();
+            emit(OpCode::kNot, dst, operand);
+            return dst;
+        }
+
+        uint32_t dst = newTemporary();
+        emit(OpCode::kEvaluate, dst, 0, 0, 0, expr);
+        return dst;
+    }
+
+    /**
+     * $add and $multiply. A nullish operand stops the evaluation of the remaining operands and
+     * makes the result null, as in the tree evaluator.
+     */
+    uint32_t compileAccumulation(const ExpressionNary* expr,
+                                 uint32_t accumulator,
+                                 OpCode reset,
+                                 OpCode accumulate,
+                                 OpCode result) {
+        uint32_t dst = newTemporary();
+        emit(reset, 0, 0, 0, 0, nullptr, accumulator);
+
+        std::vector<size_t> nullJumps;
+        for (auto&& operand : expr->getOperandList()) {
+            uint32_t reg = compile(operand.get());
+            nullJumps.push_back(emit(accumulate, dst, 0, reg, 0, nullptr, accumulator));
+        }
+        emit(result, dst, 0, 0, 0, nullptr, accumulator);
+
+        patch(nullJumps, _program->_code.size());
+        return dst;
+    }
+
+    uint32_t compileBinary(const ExpressionNary* expr, OpCode op) {
+        const auto& operands = expr->getOperandList();
+        uint32_t lhs = compile(operands[0].get());
+        uint32_t rhs = compile(operands[1].get());
+        uint32_t dst = newTemporary();
+        emit(op, dst, lhs, rhs, 0, expr);
+        return dst;
+    }
+
+    uint32_t compileCond(const ExpressionCond* expr) {
+        const auto& operands = expr->getOperandList();
+        uint32_t dst = newTemporary();
+
+        uint32_t condition = compile(operands[0].get());
+        size_t jumpToElse = emit(OpCode::kJumpIfFalse, 0, condition);
+
+        emit(OpCode::kMove, dst, compile(operands[1].get()));
+        size_t jumpToEnd = emit(OpCode::kJump);
+
+        patch({jumpToElse}, _program->_code.size());
+        emit(OpCode::kMove, dst, compile(operands[2].get()));
+
+        patch({jumpToEnd}, _program->_code.size());
+        return dst;
+    }
+
+    /**
+     * $and and $or. 'exitJump' leaves the operand list as soon as the result is known.
+     */
+    uint32_t compileShortCircuit(const ExpressionNary* expr, OpCode exitJump) {
+        const bool exitValue = exitJump == OpCode::kJumpIfTrue;
+        uint32_t dst = newTemporary();
+
+        std::vector<size_t> exitJumps;
+        for (auto&& operand : expr->getOperandList()) {
+            exitJumps.push_back(emit(exitJump, 0, compile(operand.get())));
+        }
+        emit(OpCode::kLoadBool, dst, 0, 0, !exitValue);
+        size_t jumpToEnd = emit(OpCode::kJump);
+
+        patch(exitJumps, _program->_code.size());
+        emit(OpCode::kLoadBool, dst, 0, 0, exitValue);
+
+        patch({jumpToEnd}, _program->_code.size());
+        return dst;
+    }
+
+    uint32_t newTemporary() {
+        return _numTemporaries++;
+    }
+
+    size_t emit(OpCode op,
+                uint32_t dst = 0,
+                uint32_t lhs = 0,
+                uint32_t rhs = 0,
+                uint32_t arg = 0,
+                const Expression* expr = nullptr,
+                uint32_t slot = 0) {
+        _program->_code.push_back({op, dst, lhs, rhs, arg, slot, expr});
+        return _program->_code.size() - 1;
+    }
+
+    void patch(const std::vector<size_t>& jumps, size_t target) {
+        for (auto&& jump : jumps) {
+            _program->_code[jump].arg = target;
+        }
+    }
+
+    ExpressionProgram* _program;
+    std::vector<Value> _constants;
+    uint32_t _numTemporaries = 0;
+    uint32_t _numSums = 0;
+    uint32_t _numProducts = 0;
+};
+
+std::unique_ptr<ExpressionProgram> ExpressionProgram::compile(
+    const intrusive_ptr<Expression>& expr) {
+    if (!Compiler::isCompilable(expr.get())) {
+        return nullptr;
+    }
+
+    std::unique_ptr<ExpressionProgram> program(new ExpressionProgram(expr));
+    Compiler(program.get()).compileRoot(expr.get());
+    return program;
+}
+
+Value ExpressionProgram::run(const Document& root) const {
+    Value* const registers = _registers.data();
+
+    const size_t end = _code.size();
+    size_t pc = 0;
+    while (pc < end) {
+        const Instruction& instruction = _code[pc++];
+        Value& dst = registers[instruction.dst];
+        const Value& lhs = registers[instruction.lhs];
+        const Value& rhs = registers[instruction.rhs];
+
+        switch (instruction.op) {
+            case OpCode::kEvaluate:
+                dst = instruction.expr->evaluate(root);
+                break;
+            case OpCode::kMove:
+                dst = lhs;
+                break;
+            case OpCode::kLoadBool:
+                dst = Value(instruction.arg != 0);
+                break;
+            case OpCode::kNot:
+                dst = Value(!lhs.coerceToBool());
+                break;
+            case OpCode::kJump:
+                pc = instruction.arg;
+                break;
+            case OpCode::kJumpIfFalse:
+                if (!lhs.coerceToBool())
+                    pc = instruction.arg;
+                break;
+            case OpCode::kJumpIfTrue:
+                if (lhs.coerceToBool())
+                    pc = instruction.arg;
+                break;
+            case OpCode::kSubtract:
+                dst = ExpressionSubtract::apply(lhs, rhs);
+                break;
+            case OpCode::kDivide:
+                dst = ExpressionDivide::apply(lhs, rhs);
+                break;
+            case OpCode::kMod:
+                dst = ExpressionMod::apply(lhs, rhs);
+                break;
+            case OpCode::kCompare:
+                dst = static_cast<const ExpressionCompare*>(instruction.expr)->apply(lhs, rhs);
+                break;
+            case OpCode::kSumReset:
+                _sums[instruction.slot] = ExpressionAdd::Sum();
+                break;
+            case OpCode::kSumAdd:
+                if (!_sums[instruction.slot].add(rhs)) {
+                    dst = Value(BSONNULL);
+                    pc = instruction.arg;
+                }
+                break;
+            case OpCode::kSumResult:
+                dst = _sums[instruction.slot].getValue();
+                break;
+            case OpCode::kProductReset:
+                _products[instruction.slot] = ExpressionMultiply::Product();
+                break;
+            case OpCode::kProductMultiply:
+                if (!_products[instruction.slot].multiply(rhs)) {
+                    dst = Value(BSONNULL);
+                    pc = instruction.arg;
+                }
+                break;
+            case OpCode::kProductResult:
+                dst = _products[instruction.slot].getValue();
+                break;
+        }
+    }
+
+    return registers[_resultRegister];
+}
+
+intrusive_ptr<Expression> compileExpression(const intrusive_ptr<ExpressionContext>& expCtx,
+                                            const intrusive_ptr<Expression>& expr) {
+    if (dynamic_cast<ExpressionCompiled*>(expr.get())) {
+        return expr;
+    }
+
+    auto program = ExpressionProgram::compile(expr);
+    if (!program) {
+        return expr;
+    }
+    return new ExpressionCompiled(expCtx, expr, std::move(program));
+}
+
+}  // namespace mongo
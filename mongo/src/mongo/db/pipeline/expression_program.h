@@ -0,0 +1,172 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/value.h"
+
+namespace mongo {
+
+/**
+ * A flattened form of an optimized Expression tree.
+ *
+ * The arithmetic, comparison and boolean operators that dominate $project and $addFields
+ * workloads ($add, $subtract, $multiply, $divide, $mod, the comparison operators, $cond, $and,
+ * $or and $not) are compiled into a linear sequence of instructions that operate on a fixed set
+ * of Value registers. Constants are loaded into their registers once, at compile time, and the
+ * short-circuiting operators become conditional jumps, so evaluating the program makes no virtual
+ * calls and creates no temporaries for those operators. Any other expression, including field
+ * paths and variables, is evaluated through Expression::evaluate() and its result is written to
+ * a register.
+ *
+ * A program produces exactly the same results and errors as the tree it was compiled from. It is
+ * not thread safe: like the rest of a pipeline stage, it must only be run by one thread at a time.
+ */
+class ExpressionProgram {
+public:
+    /**
+     * Compiles 'expr', which must already be optimized. Returns nullptr if the root of 'expr' is
+     * not an operator that can be compiled, as the program would then only add overhead.
+     */
+    static std::unique_ptr<ExpressionProgram> compile(const boost::intrusive_ptr<Expression>& expr);
+
+    /**
+     * Evaluates the program with respect to the Document given by 'root'.
+     */
+    Value run(const Document& root) const;
+
+    size_t numInstructions() const {
+        return _code.size();
+    }
+
+    size_t numRegisters() const {
+        return _registers.size();
+    }
+
+private:
+    enum class OpCode : uint8_t {
+        kEvaluate,     // dst = expr->evaluate(root)
+        kMove,         // dst = lhs
+        kLoadBool,     // dst = Value(bool(arg))
+        kNot,          // dst = !lhs.coerceToBool()
+        kJump,         // pc = arg
+        kJumpIfFalse,  // if (!lhs.coerceToBool()) pc = arg
+        kJumpIfTrue,   // if (lhs.coerceToBool()) pc = arg
+        kSubtract,     // dst = lhs - rhs
+        kDivide,       // dst = lhs / rhs
+        kMod,          // dst = lhs % rhs
+        kCompare,      // dst = expr->apply(lhs, rhs)
+        kSumReset,     // sums[slot] = {}
+        kSumAdd,       // if (!sums[slot].add(rhs)) { dst = null; pc = arg; }
+        kSumResult,    // dst = sums[slot].getValue()
+        kProductReset,
+        kProductMultiply,
+        kProductResult,
+    };
+
+    struct Instruction {
+        OpCode op;
+        uint32_t dst;   // Destination register.
+        uint32_t lhs;   // First operand register.
+        uint32_t rhs;   // Second operand register.
+        uint32_t arg;   // Jump target or immediate value.
+        uint32_t slot;  // Index of the $add or $multiply accumulator.
+        const Expression* expr;
+    };
+
+    class Compiler;
+
+    explicit ExpressionProgram(boost::intrusive_ptr<Expression> expr) : _expr(std::move(expr)) {}
+
+    // The tree this program was compiled from. Instructions keep raw pointers into it.
+    boost::intrusive_ptr<Expression> _expr;
+
+    std::vector<Instruction> _code;
+    uint32_t _resultRegister = 0;
+
+    // The first '_numConstants' registers hold constants and are never written by run().
+    uint32_t _numConstants = 0;
+    mutable std::vector<Value> _registers;
+    mutable std::vector<ExpressionAdd::Sum> _sums;
+    mutable std::vector<ExpressionMultiply::Product> _products;
+};
+
+/**
+ * An Expression that evaluates a compiled ExpressionProgram in place of the tree it was compiled
+ * from. Serialization, dependency tracking and computed paths are delegated to the original tree.
+ */
+class ExpressionCompiled final : public Expression {
+public:
+    ExpressionCompiled(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                       boost::intrusive_ptr<Expression> expr,
+                       std::unique_ptr<ExpressionProgram> program)
+        : Expression(expCtx), _expr(std::move(expr)), _program(std::move(program)) {}
+
+    Value evaluate(const Document& root) const final {
+        return _program->run(root);
+    }
+
+    Value serialize(bool explain) const final {
+        return _expr->serialize(explain);
+    }
+
+    ComputedPaths getComputedPaths(const std::string& exprFieldPath,
+                                   Variables::Id renamingVar) const final {
+        return _expr->getComputedPaths(exprFieldPath, renamingVar);
+    }
+
+    const ExpressionProgram& getProgram() const {
+        return *_program;
+    }
+
+protected:
+    void _doAddDependencies(DepsTracker* deps) const final {
+        _expr->addDependencies(deps);
+    }
+
+private:
+    boost::intrusive_ptr<Expression> _expr;
+    std::unique_ptr<ExpressionProgram> _program;
+};
+
+/**
+ * Returns an ExpressionCompiled evaluating 'expr' if it can be compiled, or 'expr' itself
+ * otherwise. 'expr' must already be optimized.
+ */
+boost::intrusive_ptr<Expression> compileExpression(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    const boost::intrusive_ptr<Expression>& expr);
+
+}  // namespace mongo
@@ -0,0 +1,184 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/expression_program.h"
+
+#include "mongo/bson/json.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+using boost::intrusive_ptr;
+
+intrusive_ptr<Expression> parseAndOptimize(const intrusive_ptr<ExpressionContext>& expCtx,
+                                           const std::string& json) {
+    return Expression::parseOperand(expCtx,
+                                    fromjson("{expr: " + json + "}").firstElement(),
+                                    expCtx->variablesParseState)
+        ->optimize();
+}
+
+/**
+ * Asserts that 'json' compiles, and that the program evaluates every document in 'docs' to the
+ * same value as the tree it was compiled from.
+ */
+void assertProgramMatchesTree(const std::string& json, const std::vector<BSONObj>& docs) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto expr = parseAndOptimize(expCtx, json);
+    auto program = ExpressionProgram::compile(expr);
+    ASSERT(program);
+
+    for (auto&& doc : docs) {
+        Document root(doc);
+        ASSERT_VALUE_EQ(expr->evaluate(root), program->run(root));
+    }
+}
+
+const std::vector<BSONObj> kNumericDocs = {
+    BSON("a" << 1 << "b" << 2),
+    BSON("a" << 7LL << "b" << 3),
+    BSON("a" << 2.5 << "b" << -4),
+    BSON("a" << Decimal128("1.5") << "b" << 2),
+    BSON("a" << std::numeric_limits<long long>::max() << "b" << 2LL),
+    BSON("a" << BSONNULL << "b" << 1),
+    BSON("b" << 1),
+};
+
+TEST(ExpressionProgramTest, DoesNotCompileUnsupportedRoot) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    ASSERT_FALSE(ExpressionProgram::compile(parseAndOptimize(expCtx, "'$a'")));
+    ASSERT_FALSE(ExpressionProgram::compile(parseAndOptimize(expCtx, "{$concat: ['$a', 'b']}")));
+}
+
+TEST(ExpressionProgramTest, ArithmeticMatchesTree) {
+    assertProgramMatchesTree("{$add: ['$a', {$multiply: ['$b', 2]}, 1]}", kNumericDocs);
+    assertProgramMatchesTree("{$subtract: [{$multiply: ['$a', '$b']}, '$b']}", kNumericDocs);
+    assertProgramMatchesTree("{$divide: [{$add: ['$a', 0.5]}, '$b']}", kNumericDocs);
+    assertProgramMatchesTree("{$mod: [{$abs: '$a'}, '$b']}", kNumericDocs);
+}
+
+TEST(ExpressionProgramTest, CondAndComparisonsMatchTree) {
+    assertProgramMatchesTree(
+        "{$cond: {if: {$gt: ['$a', '$b']}, then: {$subtract: ['$a', '$b']}, else: 'small'}}",
+        kNumericDocs);
+    assertProgramMatchesTree("{$cond: [{$and: [{$gte: ['$a', 1]}, {$lt: ['$b', 3]}]}, 1, 0]}",
+                             kNumericDocs);
+    assertProgramMatchesTree("{$or: [{$eq: ['$a', null]}, {$not: [{$ne: ['$b', 2]}]}]}",
+                             kNumericDocs);
+    assertProgramMatchesTree("{$cmp: ['$a', '$b']}", kNumericDocs);
+}
+
+TEST(ExpressionProgramTest, AddOfDateMatchesTree) {
+    assertProgramMatchesTree("{$add: ['$d', '$a']}",
+                             {BSON("d" << Date_t::fromMillisSinceEpoch(1000) << "a" << 5),
+                              BSON("d" << Date_t::fromMillisSinceEpoch(1000) << "a" << 2.5)});
+}
+
+TEST(ExpressionProgramTest, ShortCircuitsLikeTree) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    Document root(BSON("a" << 0));
+
+    // The $divide is never evaluated, so neither form throws.
+    auto andExpr = parseAndOptimize(expCtx, "{$and: ['$a', {$divide: [1, '$a']}]}");
+    ASSERT_VALUE_EQ(Value(false), ExpressionProgram::compile(andExpr)->run(root));
+
+    auto addExpr = parseAndOptimize(expCtx, "{$add: ['$missing', {$divide: [1, '$a']}]}");
+    ASSERT_VALUE_EQ(Value(BSONNULL), ExpressionProgram::compile(addExpr)->run(root));
+
+    auto condExpr = parseAndOptimize(expCtx, "{$cond: ['$a', {$divide: [1, '$a']}, 'zero']}");
+    ASSERT_VALUE_EQ(Value("zero"_sd), ExpressionProgram::compile(condExpr)->run(root));
+}
+
+TEST(ExpressionProgramTest, ThrowsLikeTree) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    Document root(BSON("a" << 0 << "s"
+                           << "str"));
+
+    auto divide = ExpressionProgram::compile(parseAndOptimize(expCtx, "{$divide: [1, '$a']}"));
+    ASSERT_THROWS_CODE(divide->run(root), AssertionException, 16608);
+
+    auto add = ExpressionProgram::compile(parseAndOptimize(expCtx, "{$add: ['$s', 1]}"));
+    ASSERT_THROWS_CODE(add->run(root), AssertionException, 16554);
+}
+
+TEST(ExpressionProgramTest, ReportsErrorOfLeftOperandLikeTree) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    Document root(BSON("a" << 0 << "s"
+                           << "str"));
+
+    // Both operands throw: the left one with 16608, the right one with 16554.
+    for (auto&& op : {"$subtract", "$divide", "$mod", "$cmp", "$lt"}) {
+        auto expr = parseAndOptimize(
+            expCtx, str::stream() << "{" << op << ": [{$divide: [1, '$a']}, {$add: ['$s', 1]}]}");
+        ASSERT_THROWS_CODE(expr->evaluate(root), AssertionException, 16608);
+        auto program = ExpressionProgram::compile(expr);
+        ASSERT(program);
+        ASSERT_THROWS_CODE(program->run(root), AssertionException, 16608);
+    }
+}
+
+TEST(ExpressionProgramTest, PreloadsConstants) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto program = ExpressionProgram::compile(parseAndOptimize(expCtx, "{$subtract: ['$a', 1]}"));
+
+    // One register for the constant, one for '$a' and one for the difference.
+    ASSERT_EQ(3U, program->numRegisters());
+    ASSERT_EQ(2U, program->numInstructions());
+    ASSERT_VALUE_EQ(Value(4), program->run(Document(BSON("a" << 5))));
+    ASSERT_VALUE_EQ(Value(-1), program->run(Document(BSON("a" << 0))));
+}
+
+TEST(ExpressionProgramTest, CompiledExpressionDelegatesToTree) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto expr = parseAndOptimize(expCtx, "{$add: ['$a', '$b.c']}");
+    auto compiled = compileExpression(expCtx, expr);
+    ASSERT(dynamic_cast<ExpressionCompiled*>(compiled.get()));
+    ASSERT_VALUE_EQ(expr->serialize(false), compiled->serialize(false));
+    ASSERT_VALUE_EQ(Value(3), compiled->evaluate(Document(fromjson("{a: 1, b: {c: 2}}"))));
+
+    DepsTracker deps;
+    compiled->addDependencies(&deps);
+    ASSERT_EQ(2U, deps.fields.size());
+    ASSERT_EQ(1U, deps.fields.count("a"));
+    ASSERT_EQ(1U, deps.fields.count("b.c"));
+
+    // Compiling again, or compiling a field path, is a no-op.
+    ASSERT_EQ(compiled.get(), compileExpression(expCtx, compiled).get());
+    auto fieldPath = parseAndOptimize(expCtx, "'$a'");
+    ASSERT_EQ(fieldPath.get(), compileExpression(expCtx, fieldPath).get());
+}
+
+}  // namespace
+}  // namespace mongo
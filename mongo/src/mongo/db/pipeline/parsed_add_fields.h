@@ -82,6 +82,9 @@ public:
      */
     void optimize() final {
         _root->optimize();
+        if (internalQueryCompileAggregationExpressions.load()) {
+            _root->compileExpressions(_expCtx);
+        }
     }
 
     DocumentSource::GetDepsReturn addDependencies(DepsTracker* deps) const final {
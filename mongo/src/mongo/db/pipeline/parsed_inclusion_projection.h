@@ -33,6 +33,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/parsed_aggregation_projection.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/unordered_map.h"
 #include "mongo/stdx/unordered_set.h"
@@ -59,6 +60,12 @@ public:
      */
     void optimize();
 
+    /**
+     * Replace any computed expressions which can be compiled with their ExpressionProgram. Must be
+     * called after optimize().
+     */
+    void compileExpressions(const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
     /**
      * Serialize this projection.
      */
@@ -213,6 +220,9 @@ public:
      */
     void optimize() final {
         _root->optimize();
+        if (internalQueryCompileAggregationExpressions.load()) {
+            _root->compileExpressions(_expCtx);
+        }
     }
 
     DocumentSource::GetDepsReturn addDependencies(DepsTracker* deps) const final {
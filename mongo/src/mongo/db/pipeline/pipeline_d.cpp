@@ -55,16 +55,20 @@
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_merge_cursors.h"
+#include "mongo/db/pipeline/document_source_parallel_pipeline.h"
 #include "mongo/db/pipeline/document_source_sample.h"
 #include "mongo/db/pipeline/document_source_sample_from_random_cursor.h"
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
 #include "mongo/db/pipeline/document_source_sort.h"
+#include "mongo/db/pipeline/document_source_unwind.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/collection_sharding_state.h"
@@ -703,6 +707,93 @@ void PipelineD::prepareCursorSource(Collection* collection,
         collection, pipeline, expCtx, std::move(exec), deps, queryObj, sortObj, projForQuery);
 }
 
+namespace {
+/**
+ * Returns true if 'stage' only depends on the documents it is given, and so can run over a subset
+ * of the input on a thread of a DocumentSourceParallelPipeline.
+ */
+bool canRunInParallelWorker(DocumentSource* stage) {
+    return dynamic_cast<DocumentSourceMatch*>(stage) ||
+        dynamic_cast<DocumentSourceSingleDocumentTransformation*>(stage) ||
+        dynamic_cast<DocumentSourceUnwind*>(stage) || dynamic_cast<DocumentSourceGroup*>(stage);
+}
+
+/**
+ * Returns true if the stages that Pipeline::splitForSharded() would move to the shards half of a
+ * pipeline made of the stages in ['begin', 'end') can all run in a
+ * DocumentSourceParallelPipeline. This must be decided before splitting, since only the shards
+ * half of a split pipeline can undo the split.
+ */
+bool canSplitForParallelWorkers(Pipeline::SourceContainer::const_iterator begin,
+                                Pipeline::SourceContainer::const_iterator end) {
+    bool hasWorkerStage = false;
+    for (auto it = begin; it != end; ++it) {
+        DocumentSource* stage = it->get();
+        if (!canRunInParallelWorker(stage)) {
+            return false;
+        }
+
+        // Trailing $unwind stages are moved to the merge half, so they don't count.
+        if (!dynamic_cast<DocumentSourceUnwind*>(stage)) {
+            hasWorkerStage = true;
+        }
+
+        // The shards half ends with the first splittable stage. The only one allowed in the
+        // workers is $group, whose shards part is the stage itself.
+        if (dynamic_cast<SplittableDocumentSource*>(stage)) {
+            break;
+        }
+    }
+    return hasWorkerStage;
+}
+}  // namespace
+
+void PipelineD::addParallelPipeline(Pipeline* pipeline) {
+    const int numThreads = internalDocumentSourceParallelPipelineThreads.load();
+    auto expCtx = pipeline->getContext();
+    Pipeline::SourceContainer& sources = pipeline->_sources;
+
+    // A pipeline which already runs on a shard outputs partial results for its merger, and a
+    // tailable pipeline must return its results in order.
+    if (numThreads < 2 || expCtx->needsMerge || expCtx->inMongos ||
+        expCtx->tailableMode != TailableMode::kNormal || !pipeline->isUnsplit() ||
+        sources.size() < 2) {
+        return;
+    }
+
+    // The workers return their results in any order, so the rest of the pipeline must not rely on
+    // the output of the cursor being sorted.
+    auto cursor = dynamic_cast<DocumentSourceCursor*>(sources.front().get());
+    if (!cursor || !cursor->getOutputSorts().empty()) {
+        return;
+    }
+
+    if (!canSplitForParallelWorkers(std::next(sources.cbegin()), sources.cend())) {
+        return;
+    }
+
+    boost::intrusive_ptr<DocumentSource> cursorSource = sources.front();
+    sources.pop_front();
+    pipeline->unstitch();
+
+    auto workerPipeline = pipeline->splitForSharded();
+    std::vector<BSONObj> workerSpec;
+    for (auto&& stage : workerPipeline->serialize()) {
+        workerSpec.push_back(stage.getDocument().toBson());
+    }
+
+    // The stages of the split are only used through their serialization.
+    workerPipeline.get_deleter().dismissDisposal();
+    workerPipeline.reset();
+
+    sources.push_front(DocumentSourceParallelPipeline::create(
+        expCtx, std::move(workerSpec), static_cast<size_t>(numThreads)));
+    pipeline->_splitState = Pipeline::SplitState::kUnsplit;
+
+    sources.push_front(cursorSource);
+    pipeline->stitch();
+}
+
 StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prepareExecutor(
     OperationContext* opCtx,
     Collection* collection,
@@ -83,6 +83,16 @@ public:
      */
     static void injectMongodInterface(Pipeline* pipeline);
 
+    /**
+     * If 'internalDocumentSourceParallelPipelineThreads' allows it, splits the stages following the
+     * DocumentSourceCursor of 'pipeline' like for a sharded collection, and runs the shards part
+     * on several threads in a DocumentSourceParallelPipeline. The merging part runs after it.
+     *
+     * Must be called after prepareCursorSource() and optimizePipeline(). Leaves 'pipeline'
+     * unmodified if its stages cannot run on other threads or the output of the cursor is sorted.
+     */
+    static void addParallelPipeline(Pipeline* pipeline);
+
     static std::string getPlanSummaryStr(const Pipeline* pipeline);
 
     static void getPlanSummaryStats(const Pipeline* pipeline, PlanSummaryStats* statsOut);
@@ -39,6 +39,7 @@
 #include "mongo/bson/timestamp.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/intrusive_counter.h"
+#include "mongo/util/operation_arena.h"
 
 
 namespace mongo {
@@ -52,6 +53,14 @@ class RCVector : public RefCountable {
 public:
     RCVector() {}
     RCVector(std::vector<Value> v) : vec(std::move(v)) {}
+
+    void* operator new(size_t size) {
+        return OperationArena::allocate(size);
+    }
+    void operator delete(void* ptr) {
+        OperationArena::deallocate(ptr);
+    }
+
     std::vector<Value> vec;
 };
 
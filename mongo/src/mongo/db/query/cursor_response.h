@@ -41,6 +41,13 @@ namespace mongo {
 /**
  * Builds the cursor field and the _latestOplogTimestamp field for a reply to a cursor-generating
  * command in place.
+ *
+ * The batch is always copied into 'commandResponse'. Unlike the OP_QUERY and OP_GET_MORE replies
+ * in find.cpp, command replies do not reference large result documents through a
+ * MessageGatherBuilder: the BSON layout would allow it, since the array element headers can be
+ * copied and the documents referenced between them, but the rpc::ReplyBuilderInterface
+ * implementations finish the reply as one contiguous BSONObj and append the status and metadata
+ * fields after the batch. They would have to build a segmented Message first.
  */
 class CursorResponseBuilder {
     MONGO_DISALLOW_COPYING(CursorResponseBuilder);
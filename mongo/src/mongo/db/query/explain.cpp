@@ -560,6 +560,8 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("memUsage", spec->memUsage);
             bob->appendNumber("memLimit", spec->memLimit);
+            bob->appendBool("usedDisk", spec->spills > 0);
+            bob->appendNumber("spills", spec->spills);
         }
 
         if (spec->limit > 0) {
@@ -940,6 +942,8 @@ void Explain::getSummaryStats(const PlanExecutor& exec, PlanSummaryStats* statsO
 
         if (STAGE_SORT == stages[i]->stageType()) {
             statsOut->hasSortStage = true;
+            statsOut->sortSpills +=
+                static_cast<const SortStats*>(stages[i]->getSpecificStats())->spills;
         }
 
         if (STAGE_IXSCAN == stages[i]->stageType()) {
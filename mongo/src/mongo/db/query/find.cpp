@@ -50,6 +50,7 @@
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/s/collection_sharding_state.h"
@@ -64,6 +65,7 @@
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/message.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -160,6 +162,19 @@ void endQueryOp(OperationContext* opCtx,
 
 namespace {
 
+/**
+ * Appends a result document to a legacy reply. Large documents which already own their buffer are
+ * referenced by the reply instead of being copied into it.
+ */
+void appendResultDocument(const BSONObj& obj, MessageGatherBuilder* bb) {
+    const int threshold = internalQueryReplyDocumentReferenceThresholdBytes.load();
+    if (threshold > 0 && obj.objsize() >= threshold && obj.isOwned()) {
+        bb->appendReference(obj.sharedBuffer(), obj.objdata(), obj.objsize());
+        return;
+    }
+    bb->appendBuf(obj.objdata(), obj.objsize());
+}
+
 /**
  * Uses 'cursor' to fill out 'bb' with the batch of result documents to
  * be returned by this getMore.
@@ -174,7 +189,7 @@ namespace {
  */
 void generateBatch(int ntoreturn,
                    ClientCursor* cursor,
-                   BufBuilder* bb,
+                   MessageGatherBuilder* bb,
                    int* numResults,
                    Timestamp* slaveReadTill,
                    PlanExecutor::ExecState* state) {
@@ -190,7 +205,7 @@ void generateBatch(int ntoreturn,
         }
 
         // Add result to output buffer.
-        bb->appendBuf((void*)obj.objdata(), obj.objsize());
+        appendResultDocument(obj, bb);
 
         // Count the result.
         (*numResults)++;
@@ -240,6 +255,11 @@ Message getMore(OperationContext* opCtx,
 
     const NamespaceString nss(ns);
 
+    // A getMore command may have left a prefetch of this cursor's next batch running; the batch
+    // is consumed below.
+    CursorManager::waitForPrefetch(opCtx, cursorid);
+    const Status prefetchStatus = CursorManager::releasePrefetch(cursorid);
+
     // Cursors come in one of two flavors:
     // - Cursors owned by the collection cursor manager, such as those generated via the find
     //   command. For these cursors, we hold the appropriate collection lock for the duration of the
@@ -310,6 +330,10 @@ Message getMore(OperationContext* opCtx,
     // CC, so don't delete it.
     auto ccPin = cursorManager->pinCursor(opCtx, cursorid);
 
+    // The prefetch failed, and if it killed the cursor, it also disposed of it. Report the error
+    // instead of the cursor not being found.
+    uassertStatusOK(prefetchStatus);
+
     // These are set in the QueryResult msg we return.
     int resultFlags = ResultFlag_AwaitCapable;
 
@@ -319,7 +343,7 @@ Message getMore(OperationContext* opCtx,
     const int InitialBufSize =
         512 + sizeof(QueryResult::Value) + FindCommon::kMaxBytesToReturnToClientAtOnce;
 
-    BufBuilder bb(InitialBufSize);
+    MessageGatherBuilder bb(InitialBufSize);
     bb.skip(sizeof(QueryResult::Value));
 
     if (!ccPin.isOK()) {
@@ -501,7 +525,7 @@ Message getMore(OperationContext* opCtx,
         }
     }
 
-    QueryResult::View qr = bb.buf();
+    QueryResult::View qr = bb.headerBuf();
     qr.msgdata().setLen(bb.len());
     qr.msgdata().setOperation(opReply);
     qr.setResultFlags(resultFlags);
@@ -509,7 +533,7 @@ Message getMore(OperationContext* opCtx,
     qr.setStartingFrom(startingResult);
     qr.setNReturned(numResults);
     LOG(5) << "getMore returned " << numResults << " results\n";
-    return Message(bb.release());
+    return bb.release();
 }
 
 //οhttps://yq.aliyun.com/articles/647563?spm=a2c4e.11155435.0.0.7cb74df3gUVck4 MongoDB ִмƻ & Ż ()
@@ -621,7 +645,7 @@ std::string runQuery(OperationContext* opCtx,
     // bb is used to hold query results
     // this buffer should contain either requested documents per query or
     // explain information, but not both
-    BufBuilder bb(FindCommon::kInitReplyBufferSize);
+    MessageGatherBuilder bb(FindCommon::kInitReplyBufferSize);
     bb.skip(sizeof(QueryResult::Value));
 
     // How many results have we obtained from the executor?
@@ -647,7 +671,7 @@ std::string runQuery(OperationContext* opCtx,
         }
 
         // Add result to output buffer.
-        bb.appendBuf((void*)obj.objdata(), obj.objsize());
+        appendResultDocument(obj, &bb);
 
         // Count the result.
         ++numResults;
@@ -729,7 +753,7 @@ std::string runQuery(OperationContext* opCtx,
     }
 
     // Fill out the output buffer's header.
-    QueryResult::View queryResultView = bb.buf();
+    QueryResult::View queryResultView = bb.headerBuf();
     queryResultView.setCursorId(ccId);
     queryResultView.setResultFlagsToOk();
     queryResultView.msgdata().setLen(bb.len());
@@ -738,7 +762,7 @@ std::string runQuery(OperationContext* opCtx,
     queryResultView.setNReturned(numResults);
 
     // Add the results from the query into the output buffer.
-    result.setData(bb.release());
+    result = bb.release();
 
     // curOp.debug().exhaust is set above.
     return curOp.debug().exhaust ? nss.ns() : "";
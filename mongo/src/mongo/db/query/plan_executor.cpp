@@ -49,6 +49,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/query/mock_yield_policies.h"
 #include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/record_fetcher.h"
@@ -70,6 +71,14 @@ const OperationContext::Decoration<bool> shouldWaitForInserts =
 const OperationContext::Decoration<repl::OpTime> clientsLastKnownCommittedOpTime =
     OperationContext::declareDecoration<repl::OpTime>();
 
+namespace {
+const auto batchArena = OperationContext::declareDecoration<OperationArena>();
+}  // namespace
+
+OperationArena* getBatchArena(OperationContext* opCtx) {
+    return internalQueryUseBatchArena.load() ? &batchArena(opCtx) : nullptr;
+}
+
 struct CappedInsertNotifierData {
     shared_ptr<CappedInsertNotifier> notifier;
     uint64_t lastEOFVersion = ~0;
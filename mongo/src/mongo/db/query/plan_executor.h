@@ -37,6 +37,7 @@
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/storage/snapshot.h"
 #include "mongo/platform/unordered_set.h"
+#include "mongo/util/operation_arena.h"
 
 namespace mongo {
 
@@ -69,6 +70,13 @@ extern const OperationContext::Decoration<bool> shouldWaitForInserts;
  */
 extern const OperationContext::Decoration<repl::OpTime> clientsLastKnownCommittedOpTime;
 
+/**
+ * Returns the arena from which the documents, values and WorkingSetMembers created while 'opCtx'
+ * builds a batch of results are allocated, or nullptr if internalQueryUseBatchArena is disabled.
+ * Commands make it current with an OperationArena::Scope around each batch they generate.
+ */
+OperationArena* getBatchArena(OperationContext* opCtx);
+
 /**
  * A PlanExecutor is the abstraction that knows how to crank a tree of stages into execution.
  * The executor is usually part of a larger abstraction that is interacting with the cache
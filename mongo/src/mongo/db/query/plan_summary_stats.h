@@ -54,6 +54,9 @@ struct PlanSummaryStats { //
     // Did this plan use an in-memory sort stage?
     bool hasSortStage = false;
 
+    // The number of sorted runs written to disk by the plan's sort stages.
+    size_t sortSpills = 0U;
+
     // The names of each index used by the plan.
     std::set<std::string> indexesUsed;
 
@@ -63,6 +63,14 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalSorterMaxThreads, int, 1);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryEnableColumnarMatcher, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCompileAggregationExpressions, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryUseBatchArena, bool, false);
+
 // Yield every 128 cycles or 10ms.
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
@@ -77,9 +85,25 @@ MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceCursorBatchSizeBytes, int, 4
 
 MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupCacheSizeBytes, int, 100 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupBatchSize, int, 1);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceBatchSize, int, 1024);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupHashSpill, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupMaxThreads, int, 1);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceParallelPipelineThreads, int, 1);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerGenerateCoveredWholeIndexScans, bool, false);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryIgnoreUnknownJSONSchemaKeywords, bool, false);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryProhibitBlockingMergeOnMongoS, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryReplyDocumentReferenceThresholdBytes, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryGetMorePrefetch, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryGetMorePrefetchMaxBytes, int, 256 * 1024 * 1024);
 }  // namespace mongo
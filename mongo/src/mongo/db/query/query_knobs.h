@@ -106,6 +106,22 @@ extern AtomicBool internalQueryIgnoreUnknownJSONSchemaKeywords;
 
 extern AtomicInt32 internalQueryExecMaxBlockingSortBytes;
 
+// Max number of threads a single Sorter may use to sort runs and write spill files. Used by index
+// builds and by $sort. Values less than 2 sort on the calling thread only.
+extern AtomicInt32 internalSorterMaxThreads;
+
+// Evaluate the filters of collection scans and the $match stages of aggregations with a
+// ColumnarMatcher when the filter only uses operators it supports.
+extern AtomicBool internalQueryEnableColumnarMatcher;
+
+// Compile the computed fields of $project and $addFields into ExpressionPrograms after they have
+// been optimized.
+extern AtomicBool internalQueryCompileAggregationExpressions;
+
+// Allocate the documents and working set members created while building a find, getMore or
+// aggregate batch from a per-operation OperationArena.
+extern AtomicBool internalQueryUseBatchArena;
+
 // Yield after this many "should yield?" checks.
 //ۻֵ yieldĬΪ 128ϷӳǴ߱ϻȡ
 //˶ݺ yieldyield ֮ۻ㡣
@@ -129,5 +145,37 @@ extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
 
 extern AtomicInt32 internalDocumentSourceLookupCacheSizeBytes;
 
+// Number of input documents a $lookup with localField/foreignField syntax joins with a single query
+// on the foreign collection. Values less than 2 run one query per input document.
+extern AtomicInt32 internalDocumentSourceLookupBatchSize;
+
+// Max number of documents passed at once by DocumentSource::getNextBatch() to the stages which
+// consume their input in batches. Values less than 2 read the input one document at a time.
+extern AtomicInt32 internalDocumentSourceBatchSize;
+
+// When $group exceeds its memory limit, spill the groups into hash partitions which are aggregated
+// one at a time, instead of spilling sorted runs which are merged by _id.
+extern AtomicBool internalDocumentSourceGroupHashSpill;
+
+// Max number of hash partitions spilled by $group which may be aggregated concurrently.
+extern AtomicInt32 internalDocumentSourceGroupMaxThreads;
+
+// Number of threads running the part of an unsharded aggregation which follows the collection scan
+// and could run on the shards of a sharded collection. Values less than 2 disable parallelism.
+extern AtomicInt32 internalDocumentSourceParallelPipelineThreads;
+
 extern AtomicBool internalQueryProhibitBlockingMergeOnMongoS;
+
+// Documents of at least this many bytes which already own their buffer are referenced by OP_QUERY
+// and OP_GET_MORE replies and sent with a gather write instead of being copied into the reply.
+// Values less than 1 disable referencing. Replies to the find and getMore commands, including
+// those sent as OP_MSG, always copy their documents; see CursorResponseBuilder.
+extern AtomicInt32 internalQueryReplyDocumentReferenceThresholdBytes;
+
+// After answering a getMore on a non-tailable find cursor, build the cursor's next batch in the
+// background so that it is ready when the client asks for it.
+extern AtomicBool internalQueryGetMorePrefetch;
+
+// Max number of bytes of prefetched getMore batches buffered at once, across all cursors.
+extern AtomicInt32 internalQueryGetMorePrefetchMaxBytes;
 }  // namespace mongo
@@ -102,6 +102,7 @@ const char kNoCursorTimeoutField[] = "noCursorTimeout";
 const char kAwaitDataField[] = "awaitData";
 const char kPartialResultsField[] = "allowPartialResults";
 const char kTermField[] = "term";
+const char kAllowDiskUseField[] = "allowDiskUse";
 const char kOptionsField[] = "options";
 
 // Field names for sorting options.
@@ -354,6 +355,13 @@ StatusWith<unique_ptr<QueryRequest>> QueryRequest::parseFromFindCommand(unique_p
             }
 
             qr->_allowPartialResults = el.boolean();
+        } else if (fieldName == kAllowDiskUseField) {
+            Status status = checkFieldType(el, Bool);
+            if (!status.isOK()) {
+                return status;
+            }
+
+            qr->_allowDiskUse = el.boolean();
         } else if (fieldName == kOptionsField) {
             // 3.0.x versions of the shell may generate an explain of a find command with an
             // 'options' field. We accept this only if the 'options' field is empty so that
@@ -541,6 +549,10 @@ void QueryRequest::asFindCommand(BSONObjBuilder* cmdBuilder) const {
         cmdBuilder->append(kPartialResultsField, true);
     }
 
+    if (_allowDiskUse) {
+        cmdBuilder->append(kAllowDiskUseField, true);
+    }
+
     if (_replicationTerm) {
         cmdBuilder->append(kTermField, *_replicationTerm);
     }
@@ -1134,6 +1146,9 @@ StatusWith<BSONObj> QueryRequest::asAggregationCommand() const {
     if (!_unwrappedReadPref.isEmpty()) {
         aggregationBuilder.append(QueryRequest::kUnwrappedReadPrefField, _unwrappedReadPref);
     }
+    if (_allowDiskUse) {
+        aggregationBuilder.append(kAllowDiskUseField, true);
+    }
     return StatusWith<BSONObj>(aggregationBuilder.obj());
 }
 }  // namespace mongo
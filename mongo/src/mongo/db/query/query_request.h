@@ -234,6 +234,7 @@ db.runCommand(
       "noCursorTimeout": <bool>,
       "awaitData": <bool>,
       "allowPartialResults": <bool>,
+      "allowDiskUse": <bool>,
       "collation": <document>
    }
 )
@@ -591,6 +592,14 @@ public:
         _allowPartialResults = allowPartialResults;
     }
 
+    bool allowDiskUse() const {
+        return _allowDiskUse;
+    }
+
+    void setAllowDiskUse(bool allowDiskUse) {
+        _allowDiskUse = allowDiskUse;
+    }
+
     boost::optional<long long> getReplicationTerm() const {
         return _replicationTerm;
     }
@@ -728,6 +737,9 @@ private:
     bool _exhaust = false;
     bool _allowPartialResults = false;
 
+    // Lets a blocking SORT stage write to temporary files rather than fail at its memory limit.
+    bool _allowDiskUse = false;
+
     boost::optional<long long> _replicationTerm;
 };
 
@@ -436,7 +436,8 @@ TEST(QueryRequestTest, ParseFromCommandAllFlagsTrue) {
         "oplogReplay: true,"
         "noCursorTimeout: true,"
         "awaitData: true,"
-        "allowPartialResults: true}");
+        "allowPartialResults: true,"
+        "allowDiskUse: true}");
     const NamespaceString nss("test.testns");
     bool isExplain = false;
     unique_ptr<QueryRequest> qr(
@@ -449,6 +450,7 @@ TEST(QueryRequestTest, ParseFromCommandAllFlagsTrue) {
     ASSERT(qr->isNoCursorTimeout());
     ASSERT(qr->isTailableAndAwaitData());
     ASSERT(qr->isAllowPartialResults());
+    ASSERT(qr->allowDiskUse());
 }
 
 TEST(QueryRequestTest, ParseFromCommandCommentWithValidMinMax) {
@@ -801,6 +803,17 @@ TEST(QueryRequestTest, ParseFromCommandPartialWrongType) {
     ASSERT_NOT_OK(result.getStatus());
 }
 
+TEST(QueryRequestTest, ParseFromCommandAllowDiskUseWrongType) {
+    BSONObj cmdObj = fromjson(
+        "{find: 'testns',"
+        "filter:  {a: 1},"
+        "allowDiskUse: 3}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    auto result = QueryRequest::makeFromFindCommand(nss, cmdObj, isExplain);
+    ASSERT_NOT_OK(result.getStatus());
+}
+
 TEST(QueryRequestTest, ParseFromCommandReadConcernWrongType) {
     BSONObj cmdObj = fromjson(
         "{find: 'testns',"
@@ -1053,6 +1066,7 @@ TEST(QueryRequestTest, DefaultQueryParametersCorrect) {
     ASSERT_EQUALS(false, qr->isTailableAndAwaitData());
     ASSERT_EQUALS(false, qr->isExhaust());
     ASSERT_EQUALS(false, qr->isAllowPartialResults());
+    ASSERT_EQUALS(false, qr->allowDiskUse());
 }
 
 //
@@ -1286,6 +1300,17 @@ TEST(QueryRequestTest, ConvertToAggregationWithPipeline) {
                       SimpleBSONObjComparator::kInstance.makeEqualTo()));
 }
 
+TEST(QueryRequestTest, ConvertToAggregationWithAllowDiskUse) {
+    QueryRequest qr(testns);
+    qr.setAllowDiskUse(true);
+    auto agg = qr.asAggregationCommand();
+    ASSERT_OK(agg);
+
+    auto ar = AggregationRequest::parseFromBSON(testns, agg.getValue());
+    ASSERT_OK(ar.getStatus());
+    ASSERT(ar.getValue().shouldAllowDiskUse());
+}
+
 TEST(QueryRequestTest, ConvertToAggregationWithBatchSize) {
     QueryRequest qr(testns);
     qr.setBatchSize(4);
@@ -58,6 +58,7 @@
 #include "mongo/db/index/fts_access_method.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/s/collection_sharding_state.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 
@@ -125,6 +126,8 @@ PlanStage* buildStages(OperationContext* opCtx,     //
             params.collection = collection;
             params.pattern = sn->pattern;
             params.limit = sn->limit;
+            params.allowDiskUse = cq.getQueryRequest().allowDiskUse();
+            params.tempDir = storageGlobalParams.dbpath + "/_tmp";
             return new SortStage(opCtx, params, ws, childStage);
         }
         case STAGE_SORT_KEY_GENERATOR: {
@@ -34,6 +34,7 @@
 #include "mongo/db/repl/sync_tail.h"
 
 #include "third_party/murmurhash3/MurmurHash3.h"
+#include <algorithm>
 #include <boost/functional/hash.hpp>
 #include <memory>
 
@@ -74,6 +75,7 @@
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/storage/recovery_unit.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -140,6 +142,24 @@ public:
     }
 } exportedBatchLimitOperationsParam;
 
+/**
+ * When enabled, the ops in a batch are grouped into chains of ops which must be applied in order
+ * relative to each other (ops on the same document, or on the same collection when document-level
+ * ordering cannot be relied upon). The chains are then packed into work units which the writer
+ * threads pull from a shared queue, instead of statically assigning ops to writer threads by hash.
+ * This keeps a single busy collection or a few unlucky hash buckets from pinning one writer thread
+ * while the others sit idle.
+ */
+AtomicBool replWriterDynamicScheduling(true);
+ExportedServerParameter<bool, ServerParameterType::kStartupAndRuntime>
+    replWriterDynamicSchedulingParam(ServerParameterSet::getGlobal(),
+                                     "replWriterDynamicScheduling",
+                                     &replWriterDynamicScheduling);
+
+// Number of work units created per writer thread when dynamic scheduling is enabled. Having more
+// work units than threads lets threads that finish early pick up the remaining work.
+const size_t kWorkUnitsPerWriterThread = 4;
+
 // The oplog entries applied
 Counter64 opsAppliedStats;
 ServerStatusMetricField<Counter64> displayOpsApplied("repl.apply.ops", &opsAppliedStats);
@@ -477,6 +497,36 @@ void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
     }
 }
 
+// Doles out the work units to the writer pool threads. Each thread repeatedly claims the next
+// unapplied work unit until none are left, so a thread that finishes its unit early takes over
+// work that would otherwise wait behind a slower thread. The caller must guarantee that
+// 'workUnits' and 'nextWorkUnit' stay valid until all scheduled work in the thread pool completes.
+// Does not modify workUnits, but passes non-const pointers to inner vectors into func.
+void applyWorkUnits(std::vector<MultiApplier::OperationPtrs>& workUnits,
+                    AtomicUInt32* nextWorkUnit,
+                    OldThreadPool* writerPool,
+                    const MultiApplier::ApplyOperationFn& func,
+                    std::vector<Status>* statusVector) {
+    TimerHolder timer(&applyBatchStats);
+    const size_t numThreads = std::min(statusVector->size(), workUnits.size());
+    for (size_t i = 0; i < numThreads; i++) {
+        writerPool->schedule([&func, &workUnits, nextWorkUnit, statusVector, i] {
+            while (true) {
+                const size_t unit = nextWorkUnit->fetchAndAdd(1);
+                if (unit >= workUnits.size()) {
+                    return;
+                }
+
+                auto status = func(&workUnits[unit]);
+                if (!status.isOK()) {
+                    (*statusVector)[i] = status;
+                    return;
+                }
+            }
+        });
+    }
+}
+
 void initializeWriterThread() {
     // Only do this once per thread
     if (!Client::getCurrent()) {
@@ -623,10 +673,51 @@ private:
     StringMap<CollectionProperties> _cache;
 };
 
+/**
+ * Packs 'chains' into at most 'numWorkUnits' work units of roughly equal size and stores them in
+ * 'workUnits'. Each chain holds ops which must be applied in order relative to each other, so a
+ * chain is never split across work units. Chains on the same namespace are packed next to each
+ * other to preserve the grouping of inserts in multiSyncApply. The resulting work units are
+ * ordered largest first so that the longest-running ones are claimed by the writer threads first.
+ */
+void packChainsIntoWorkUnits(std::vector<MultiApplier::OperationPtrs>* chains,
+                             size_t numOps,
+                             size_t numWorkUnits,
+                             std::vector<MultiApplier::OperationPtrs>* workUnits) {
+    invariant(numWorkUnits > 0);
+    const size_t targetWorkUnitSize = (numOps + numWorkUnits - 1) / numWorkUnits;
+
+    std::stable_sort(chains->begin(),
+                     chains->end(),
+                     [](const MultiApplier::OperationPtrs& l, const MultiApplier::OperationPtrs& r) {
+                         return l.front()->getNamespace() < r.front()->getNamespace();
+                     });
+
+    workUnits->clear();
+    for (auto&& chain : *chains) {
+        if (workUnits->empty() ||
+            (!workUnits->back().empty() &&
+             workUnits->back().size() + chain.size() > targetWorkUnitSize)) {
+            workUnits->emplace_back();
+            workUnits->back().reserve(std::max(targetWorkUnitSize, chain.size()));
+        }
+        auto& workUnit = workUnits->back();
+        workUnit.insert(workUnit.end(), chain.begin(), chain.end());
+    }
+
+    std::stable_sort(workUnits->begin(),
+                     workUnits->end(),
+                     [](const MultiApplier::OperationPtrs& l, const MultiApplier::OperationPtrs& r) {
+                         return l.size() > r.size();
+                     });
+}
+
 /**
  * ops - This only modifies the isForCappedCollection field on each op. It does not alter the ops
  *      vector in any other way.
- * writerVectors - Set of operations for each worker thread to apply.
+ * writerVectors - Set of operations for each worker thread to apply. If 'useWorkUnits' is true,
+ *      this is instead replaced with the set of work units to be claimed by the worker threads
+ *      (see packChainsIntoWorkUnits).
  * latestSessionRecords - Populated map of the "latest" transaction table records for each logical
  *      session id present in the given operations. Each record represents the final state of the
  *      transaction table entry for that session id after the operations are applied.
@@ -635,7 +726,8 @@ void fillWriterVectorsAndLatestSessionRecords(
     OperationContext* opCtx,
     MultiApplier::Operations* ops,
     std::vector<MultiApplier::OperationPtrs>* writerVectors,
-    SessionRecordMap* latestSessionRecords) {
+    SessionRecordMap* latestSessionRecords,
+    bool useWorkUnits) {
     const auto serviceContext = opCtx->getServiceContext();
     const auto storageEngine = serviceContext->getGlobalStorageEngine();
 
@@ -644,6 +736,11 @@ void fillWriterVectorsAndLatestSessionRecords(
 
     CachedCollectionProperties collPropertiesCache;
 
+    // Ops which hash to the same value must be applied in order, so they are kept in one chain.
+    // Hash collisions only merge chains which could have been applied independently.
+    std::vector<MultiApplier::OperationPtrs> chains;
+    stdx::unordered_map<uint32_t, size_t> chainsByHash;
+
     for (auto&& op : *ops) {
         StringMapTraits::HashedKey hashedNs(op.getNamespace().ns());
         uint32_t hash = hashedNs.hash();
@@ -690,12 +787,27 @@ void fillWriterVectorsAndLatestSessionRecords(
             }
         }
 
+        if (useWorkUnits) {
+            auto chainIt = chainsByHash.find(hash);
+            if (chainIt == chainsByHash.end()) {
+                chainIt = chainsByHash.emplace(hash, chains.size()).first;
+                chains.emplace_back();
+            }
+            chains[chainIt->second].push_back(&op);
+            continue;
+        }
+
         auto& writer = (*writerVectors)[hash % numWriters];
         if (writer.empty()) {
             writer.reserve(8);  // Skip a few growth rounds
         }
         writer.push_back(&op);
     }
+
+    if (useWorkUnits) {
+        packChainsIntoWorkUnits(
+            &chains, ops->size(), numWriters * kWorkUnitsPerWriterThread, writerVectors);
+    }
 }
 
 }  // namespace
@@ -1545,10 +1657,12 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
         consistencyMarkers->setOplogTruncateAfterPoint(opCtx, ops.front().getTimestamp());
         scheduleWritesToOplog(opCtx, workerPool, ops);
 
+        const bool useWorkUnits = replWriterDynamicScheduling.load();
         std::vector<MultiApplier::OperationPtrs> writerVectors(workerPool->getNumThreads());
+        AtomicUInt32 nextWorkUnit(0);
         SessionRecordMap latestSessionRecords;
         fillWriterVectorsAndLatestSessionRecords(
-            opCtx, &ops, &writerVectors, &latestSessionRecords);
+            opCtx, &ops, &writerVectors, &latestSessionRecords, useWorkUnits);
 
         // Wait for writes to finish before applying ops.
         workerPool->join();
@@ -1557,7 +1671,11 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
         consistencyMarkers->setOplogTruncateAfterPoint(opCtx, Timestamp());
         consistencyMarkers->setMinValidToAtLeast(opCtx, ops.back().getOpTime());
 
-        applyOps(writerVectors, workerPool, applyOperation, &statusVector);
+        if (useWorkUnits) {
+            applyWorkUnits(writerVectors, &nextWorkUnit, workerPool, applyOperation, &statusVector);
+        } else {
+            applyOps(writerVectors, workerPool, applyOperation, &statusVector);
+        }
         workerPool->join();
 
         // Update the transaction table to point to the latest oplog entries for each session id.
@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -574,6 +575,63 @@ TEST_F(SyncTailTest, MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceH
     ASSERT_BSONOBJ_EQ(op2.raw, operationsWrittenToOplog[1].doc);
 }
 
+TEST_F(SyncTailTest, MultiApplyKeepsDependentOperationsTogetherInOrderWhenBalancingWork) {
+    // Eight independent chains of four ops each. Every op in a chain targets the same document, so
+    // the ops of a chain must be applied by one writer thread in oplog order, while the chains
+    // themselves may be spread out over more work units than there are writer threads.
+    const int kNumChains = 8;
+    const int kOpsPerChain = 4;
+    OldThreadPool writerPool(2);
+
+    stdx::mutex mutex;
+    std::vector<MultiApplier::Operations> operationsApplied;
+    auto applyOperationFn =
+        [&mutex, &operationsApplied](MultiApplier::OperationPtrs* workUnit) -> Status {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        operationsApplied.emplace_back();
+        for (auto&& opPtr : *workUnit) {
+            operationsApplied.back().push_back(*opPtr);
+        }
+        return Status::OK();
+    };
+
+    MultiApplier::Operations ops;
+    for (int i = 0; i < kOpsPerChain; i++) {
+        for (int chain = 0; chain < kNumChains; chain++) {
+            NamespaceString nss("test.t" + std::to_string(chain));
+            ops.push_back(makeInsertDocumentOplogEntry(
+                {Timestamp(Seconds(i * kNumChains + chain + 1), 0), 1LL}, nss, BSON("_id" << 0)));
+        }
+    }
+
+    auto lastOpTime =
+        unittest::assertGet(multiApply(_opCtx.get(), &writerPool, ops, applyOperationFn));
+    ASSERT_EQUALS(ops.back().getOpTime(), lastOpTime);
+
+    stdx::lock_guard<stdx::mutex> lock(mutex);
+    ASSERT_GREATER_THAN(operationsApplied.size(), writerPool.getNumThreads());
+
+    std::map<NamespaceString, size_t> workUnitByNamespace;
+    std::map<NamespaceString, OpTime> lastOpTimeByNamespace;
+    size_t numOperationsApplied = 0;
+    for (size_t unit = 0; unit < operationsApplied.size(); unit++) {
+        for (auto&& op : operationsApplied[unit]) {
+            const auto& nss = op.getNamespace();
+            auto it = workUnitByNamespace.find(nss);
+            if (it == workUnitByNamespace.end()) {
+                workUnitByNamespace[nss] = unit;
+            } else {
+                ASSERT_EQUALS(it->second, unit);
+                ASSERT_LESS_THAN(lastOpTimeByNamespace[nss], op.getOpTime());
+            }
+            lastOpTimeByNamespace[nss] = op.getOpTime();
+            numOperationsApplied++;
+        }
+    }
+    ASSERT_EQUALS(static_cast<size_t>(kNumChains), workUnitByNamespace.size());
+    ASSERT_EQUALS(ops.size(), numOperationsApplied);
+}
+
 TEST_F(SyncTailTest, MultiApplyUpdatesTheTransactionTable) {
     // Set up the transactions collection, which can only be done by the primary.
     ASSERT_OK(ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_PRIMARY));
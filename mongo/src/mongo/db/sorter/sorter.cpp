@@ -47,6 +47,7 @@
 
 #include "mongo/db/sorter/sorter.h"
 
+#include <algorithm>
 #include <boost/filesystem/operations.hpp>
 #include <snappy.h>
 #include <vector>
@@ -59,6 +60,8 @@
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/s/is_mongos.h"
+#include "mongo/stdx/future.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/destructor_guard.h"
@@ -114,6 +117,71 @@ private:
     const std::string _fileName;
 };
 
+/**
+ * Stable sorts the random access range [begin, end) using up to 'parallelism' threads, including
+ * the calling thread. The range is cut into contiguous runs which are sorted concurrently and then
+ * merged pairwise, with the merges of each round also running concurrently. Merging only adjacent
+ * runs keeps the result stable.
+ */
+template <typename Iterator, typename Less>
+void parallelStableSort(Iterator begin, Iterator end, const Less& less, size_t parallelism) {
+    // Sorting fewer elements than this per thread isn't worth the cost of starting a thread.
+    const size_t kMinElementsPerThread = 16 * 1024;
+
+    const size_t size = std::distance(begin, end);
+    const size_t numRuns = std::min(parallelism, size / kMinElementsPerThread);
+    if (numRuns <= 1) {
+        std::stable_sort(begin, end, less);
+        return;
+    }
+
+    // Run i covers [begin + bounds[i], begin + bounds[i + 1]).
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i < numRuns; i++) {
+        bounds.push_back(size * i / numRuns);
+    }
+    bounds.push_back(size);
+
+    {
+        // The destructors of futures returned by stdx::async wait for their tasks, so no task can
+        // outlive the range even if one of them throws.
+        std::vector<stdx::future<void>> tasks;
+        for (size_t i = 1; i < numRuns; i++) {
+            tasks.push_back(stdx::async(stdx::launch::async, [&, i] {
+                std::stable_sort(begin + bounds[i], begin + bounds[i + 1], less);
+            }));
+        }
+        std::stable_sort(begin + bounds[0], begin + bounds[1], less);
+        for (auto&& task : tasks) {
+            task.get();
+        }
+    }
+
+    while (bounds.size() > 2) {
+        std::vector<size_t> mergedBounds;
+        std::vector<stdx::future<void>> tasks;
+        for (size_t i = 0; i + 2 < bounds.size(); i += 2) {
+            const size_t first = bounds[i];
+            const size_t middle = bounds[i + 1];
+            const size_t last = bounds[i + 2];
+            tasks.push_back(stdx::async(stdx::launch::async, [&, first, middle, last] {
+                std::inplace_merge(begin + first, begin + middle, begin + last, less);
+            }));
+            mergedBounds.push_back(first);
+        }
+        if (bounds.size() % 2 == 0) {
+            // An odd number of runs, so the last one is carried over to the next round as is.
+            mergedBounds.push_back(bounds[bounds.size() - 2]);
+        }
+        mergedBounds.push_back(size);
+
+        for (auto&& task : tasks) {
+            task.get();
+        }
+        bounds.swap(mergedBounds);
+    }
+}
+
 /** Returns results from sorted in-memory storage */
 template <typename Key, typename Value>
 class InMemIterator : public SortIteratorInterface<Key, Value> {
@@ -289,32 +357,33 @@ public:
         : _opts(opts),
           _remaining(opts.limit ? opts.limit : std::numeric_limits<unsigned long long>::max()),
           _first(true),
-          _greater(comp) {
+          _numActive(0),
+          _comp(comp) {
         for (size_t i = 0; i < iters.size(); i++) {
             if (iters[i]->more()) {
-                _heap.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
+                _streams.push_back(stdx::make_unique<Stream>(i, iters[i]->next(), iters[i]));
             }
         }
 
-        if (_heap.empty()) {
+        if (_streams.empty()) {
             _remaining = 0;
             return;
         }
 
-        std::make_heap(_heap.begin(), _heap.end(), _greater);
-        std::pop_heap(_heap.begin(), _heap.end(), _greater);
-        _current = _heap.back();
-        _heap.pop_back();
+        _numActive = _streams.size();
+        _tree.resize(_streams.size());
+        _winner = initTree(1);
     }
 
     bool more() {
-        if (_remaining > 0 && (_first || !_heap.empty() || _current->more()))
+        if (_remaining > 0 && (_first || _numActive > 1 || _streams[_winner]->more()))
             return true;
 
         // We are done so clean up resources.
         // Can't do this in next() due to lifetime guarantees of unowned Data.
-        _heap.clear();
-        _current.reset();
+        _streams.clear();
+        _tree.clear();
+        _numActive = 0;
         _remaining = 0;
 
         return false;
@@ -327,22 +396,17 @@ public:
 
         if (_first) {
             _first = false;
-            return _current->current();
+            return _streams[_winner]->current();
         }
 
-        if (!_current->advance()) {
-            verify(!_heap.empty());
-
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            _current = _heap.back();
-            _heap.pop_back();
-        } else if (!_heap.empty() && _greater(_current, _heap.front())) {
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            std::swap(_current, _heap.back());
-            std::push_heap(_heap.begin(), _heap.end(), _greater);
+        if (!_streams[_winner]->advance()) {
+            verify(_numActive > 1);
+            _streams[_winner]->setExhausted();
+            _numActive--;
         }
+        replay();
 
-        return _current->current();
+        return _streams[_winner]->current();
     }
 
 
@@ -366,37 +430,77 @@ private:
             return true;
         }
 
+        bool exhausted() const {
+            return _exhausted;
+        }
+        void setExhausted() {
+            _exhausted = true;
+        }
+
         const size_t fileNum;
 
     private:
         Data _current;
         std::shared_ptr<Input> _rest;
+        bool _exhausted = false;
     };
 
-    class STLComparator {  // uses greater rather than less-than to maintain a MinHeap
-    public:
-        explicit STLComparator(const Comparator& comp) : _comp(comp) {}
-        bool operator()(unowned_ptr<const Stream> lhs, unowned_ptr<const Stream> rhs) const {
-            // first compare data
-            dassertCompIsSane(_comp, lhs->current(), rhs->current());
-            int ret = _comp(lhs->current(), rhs->current());
-            if (ret)
-                return ret > 0;
+    // The streams are merged with a tree of losers: each internal node holds the index of the
+    // stream that lost the match played at that node, and the overall winner is kept in _winner.
+    // When the winner advances only the matches on the path from its leaf to the root are
+    // replayed, which takes about half the comparisons of sifting a binary heap. Leaves are
+    // numbered [size, 2 * size) and internal nodes [1, size), so any number of streams works.
+
+    // Returns true if 'lhs' should be output before 'rhs'. Exhausted streams lose to everything.
+    bool beats(size_t lhs, size_t rhs) const {
+        const Stream& left = *_streams[lhs];
+        const Stream& right = *_streams[rhs];
+        if (left.exhausted() || right.exhausted())
+            return !left.exhausted();
+
+        // first compare data
+        dassertCompIsSane(_comp, left.current(), right.current());
+        int ret = _comp(left.current(), right.current());
+        if (ret)
+            return ret < 0;
+
+        // then compare fileNums to ensure stability
+        return left.fileNum < right.fileNum;
+    }
+
+    // Records the losers of the subtree rooted at 'node' and returns its winner.
+    size_t initTree(size_t node) {
+        if (node >= _streams.size())
+            return node - _streams.size();
 
-            // then compare fileNums to ensure stability
-            return lhs->fileNum > rhs->fileNum;
+        const size_t left = initTree(2 * node);
+        const size_t right = initTree(2 * node + 1);
+        if (beats(left, right)) {
+            _tree[node] = right;
+            return left;
         }
+        _tree[node] = left;
+        return right;
+    }
 
-    private:
-        const Comparator _comp;
-    };
+    // Replays the matches on the path from the current winner's leaf to the root.
+    void replay() {
+        size_t winner = _winner;
+        for (size_t node = (winner + _streams.size()) / 2; node >= 1; node /= 2) {
+            if (beats(_tree[node], winner))
+                std::swap(_tree[node], winner);
+        }
+        _winner = winner;
+    }
 
     SortOptions _opts;
     unsigned long long _remaining;
     bool _first;
-    std::shared_ptr<Stream> _current;
-    std::vector<std::shared_ptr<Stream>> _heap;  // MinHeap
-    STLComparator _greater;                      // named so calls make sense
+    size_t _numActive;  // Number of streams which are not exhausted.
+    const Comparator _comp;
+    std::vector<std::unique_ptr<Stream>> _streams;
+    std::vector<size_t> _tree;  // Losers, indexed by internal node. _tree[0] is unused.
+    size_t _winner;             // Index of the stream holding the next Data to output.
 };
 
 //IndexAccessMethod::BulkBuilder::BulkBuilder->Sorter<Key, Value>::makeйʹ
@@ -464,7 +568,7 @@ private:
 	//spill()ãdataѹдļ
     void sort() {
         STLComparator less(_comp);
-        std::stable_sort(_data.begin(), _data.end(), less);
+        parallelStableSort(_data.begin(), _data.end(), less, _opts.parallelism);
 
         // Does 2x more compares than stable_sort
         // TODO test on windows
@@ -489,6 +593,11 @@ private:
                           << " bytes, but did not opt in to external sorting. Aborting operation."
                           << " Pass allowDiskUse:true to opt in.");
         }
+        if (_opts.parallelism > 1) {
+            spillInParallel();
+            return;
+        }
+
 		//
         sort();
 
@@ -503,6 +612,50 @@ private:
         _memUsed = 0;
     }
 
+    /**
+     * Cuts _data into up to _opts.parallelism contiguous runs, then sorts each run and writes it to
+     * its own file concurrently. Since the runs are appended to _iters in input order, the merge
+     * in done() stays stable. This never holds more data in memory than a serial spill.
+     */
+    void spillInParallel() {
+        // Writing fewer elements than this to a file isn't worth the cost of starting a thread.
+        const size_t kMinElementsPerThread = 16 * 1024;
+        const size_t numRuns =
+            std::max(size_t(1), std::min(_opts.parallelism, _data.size() / kMinElementsPerThread));
+
+        std::vector<std::shared_ptr<Iterator>> runIters(numRuns);
+        auto sortAndWriteRun = [this, &runIters, numRuns](size_t run) {
+            const auto begin = _data.begin() + (_data.size() * run / numRuns);
+            const auto end = _data.begin() + (_data.size() * (run + 1) / numRuns);
+
+            STLComparator less(_comp);
+            std::stable_sort(begin, end, less);
+
+            SortedFileWriter<Key, Value> writer(_opts, _settings);
+            for (auto it = begin; it != end; ++it) {
+                writer.addAlreadySorted(it->first, it->second);
+            }
+            runIters[run].reset(writer.done());
+        };
+
+        {
+            // The destructors of futures returned by stdx::async wait for their tasks, so no task
+            // can outlive _data even if one of them throws.
+            std::vector<stdx::future<void>> tasks;
+            for (size_t run = 1; run < numRuns; run++) {
+                tasks.push_back(stdx::async(stdx::launch::async, sortAndWriteRun, run));
+            }
+            sortAndWriteRun(0);
+            for (auto&& task : tasks) {
+                task.get();
+            }
+        }
+
+        _iters.insert(_iters.end(), runIters.begin(), runIters.end());
+        _data.clear();
+        _memUsed = 0;
+    }
+
     const Comparator _comp;
     const Settings _settings;
     SortOptions _opts;
@@ -100,9 +100,12 @@ struct SortOptions {
     bool extSortAllowed;         /// If false, uassert if more mem needed than allowed.
     std::string tempDir;         /// Directory to directly place files in.
                                  /// Must be explicitly set if extSortAllowed is true.
+    size_t parallelism;          /// Max number of threads used to sort and spill runs.
+                                 /// 1 means everything is done on the calling thread.
 
     //
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    SortOptions()
+        : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false), parallelism(1) {}
 
     /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -125,6 +128,11 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& Parallelism(size_t newParallelism) {
+        parallelism = newParallelism;
+        return *this;
+    }
 };
 
 /// This is the output from the sorting framework
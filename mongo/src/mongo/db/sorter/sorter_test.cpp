@@ -330,6 +330,25 @@ public:
                 mergeIterators(iterators, ASC, SortOptions().Limit(10)),
                 make_shared<LimitIterator>(10, make_shared<IntIterator>(0, 20, 1)));
         }
+        {  // test a number of inputs which is not a power of two, exhausted at different times
+            std::shared_ptr<IWIterator> iterators[] = {
+                make_shared<IntIterator>(0, 70, 7)  // 0, 7, ... 63
+                ,
+                make_shared<IntIterator>(1, 20, 7)  // 1, 8, 15
+                ,
+                make_shared<IntIterator>(2, 3, 7)  // 2
+                ,
+                make_shared<IntIterator>(3, 70, 7)  // 3, 10, ... 66
+                ,
+                make_shared<IntIterator>(4, 70, 7)  // 4, 11, ... 67
+            };
+
+            const int expected[] = {0,  1,  2,  3,  4,  7,  8,  10, 11, 14, 15, 17, 18, 21, 24,
+                                    25, 28, 31, 32, 35, 38, 39, 42, 45, 46, 49, 52, 53, 56, 59,
+                                    60, 63, 66, 67};
+            ASSERT_ITERATORS_EQUIVALENT(mergeIterators(iterators, ASC),
+                                        makeInMemIterator(expected));
+        }
     }
 };
 
@@ -541,6 +560,28 @@ class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     }
     enum { MEM_LIMIT = 32 * 1024 };
 };
+
+// Sorts runs and writes spill files on several threads.
+template <bool Random = true>
+class LotsOfDataParallel : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+    SortOptions adjustSortOptions(SortOptions opts) {
+        // Make sure each spill is big enough to be split across threads.
+        MONGO_STATIC_ASSERT(MEM_LIMIT / sizeof(IWPair) > 4 * 16 * 1024);
+        MONGO_STATIC_ASSERT((Parent::NUM_ITEMS * sizeof(IWPair)) / MEM_LIMIT > 2);
+
+        return opts.MaxMemoryUsageBytes(MEM_LIMIT).ExtSortAllowed().Parallelism(4);
+    }
+    enum { MEM_LIMIT = 1024 * 1024 };
+};
+
+// Sorts the data in memory on several threads.
+template <bool Random = true>
+class LotsOfDataParallelInMemory : public LotsOfDataLittleMemory<Random> {
+    SortOptions adjustSortOptions(SortOptions opts) {
+        return opts.Parallelism(4);
+    }
+};
 }
 
 class SorterSuite : public mongo::unittest::Suite {
@@ -562,6 +603,10 @@ public:
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/true>>();    // fits in mem
         add<SorterTests::LotsOfDataWithLimit<5000, /*random=*/false>>();  // spills
         add<SorterTests::LotsOfDataWithLimit<5000, /*random=*/true>>();   // spills
+        add<SorterTests::LotsOfDataParallel</*random=*/false>>();
+        add<SorterTests::LotsOfDataParallel</*random=*/true>>();
+        add<SorterTests::LotsOfDataParallelInMemory</*random=*/false>>();
+        add<SorterTests::LotsOfDataParallelInMemory</*random=*/true>>();
     }
 };
 
@@ -304,6 +304,7 @@
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/kv/kv_catalog_feature_tracker.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/recovery_unit.h"
@@ -324,6 +325,24 @@ const char kNamespaceFieldName[] = "ns";
 const char kNonRepairableFeaturesFieldName[] = "nonRepairable";
 const char kRepairableFeaturesFieldName[] = "repairable";
 
+// Marks the idents of tables shared by grouped collections and indexes. Unique idents are made of
+// numbers only, so they never contain it.
+const char kGroupIdentPrefix[] = "group-";
+const char kGroupIdentInfix[] = "-group-";
+
+/**
+ * Returns whether collection 'ns' created with 'options', and its indexes, may live in tables
+ * shared with other grouped collections. Everyone in a table shares its configuration, so
+ * collections asking for their own storage engine options keep tables of their own, as do those
+ * of the "local" database, whose tables are not journaled like everybody else's. Capped
+ * collections keep their own tables too, since capped deletes walk and truncate from the start of
+ * the table rather than of their prefix.
+ */
+bool canShareTable(StringData ns, const CollectionOptions& options) {
+    return nsToDatabaseSubstring(ns) != "local" && !options.capped &&
+        options.storageEngine.isEmpty() && options.indexOptionDefaults.isEmpty();
+}
+
 void appendPositionsOfBitsSet(uint64_t value, StringBuilder* sb) {
     invariant(sb);
 
@@ -342,6 +361,11 @@ void appendPositionsOfBitsSet(uint64_t value, StringBuilder* sb) {
 }
 }
 
+// Number of shared tables that grouped collections, and separately grouped indexes of each index
+// version, are spread over when --groupCollections is enabled. Only affects new collections and
+// indexes; existing ones stay in the table they were created in.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(groupCollectionsTableCount, int, 16);
+
 using std::unique_ptr;
 using std::string;
 
@@ -572,6 +596,23 @@ std::string KVCatalog::_newUniqueIdent(StringData ns, const char* kind) {
 
 //KVStorageEngine::KVStorageEngineеãKVStorageEngine::KVStorageEngineʼʱʹ
 //Ԫļ_mdb_catalog.wtлȡԪϢ
+std::string KVCatalog::_groupIdent(StringData ns,
+                                   const char* kind,
+                                   StringData tag,
+                                   KVPrefix prefix) {
+    invariant(prefix.isPrefixed());
+    const int64_t tableCount = std::max(1, groupCollectionsTableCount);
+
+    StringBuilder buf;
+    if (_directoryPerDb) {
+        buf << NamespaceString::escapeDbName(nsToDatabaseSubstring(ns)) << '/';
+    }
+    buf << kind;
+    buf << (_directoryForIndexes ? '/' : '-');
+    buf << kGroupIdentPrefix << tag << prefix.repr() % tableCount;
+    return buf.str();
+}
+
 void KVCatalog::init(OperationContext* opCtx) {
     // No locking needed since called single threaded.
     auto cursor = _rs->getCursor(opCtx);
@@ -640,7 +681,9 @@ Status KVCatalog::newCollection(OperationContext* opCtx,
     invariant(opCtx->lockState()->isDbLockedForMode(nsToDatabaseSubstring(ns), MODE_X));
 
 	//һ϶Ӧһwtļ
-    const string ident = _newUniqueIdent(ns, "collection");
+    const string ident = prefix.isPrefixed() && canShareTable(ns, options)
+        ? _groupIdent(ns, "collection", "", prefix)
+        : _newUniqueIdent(ns, "collection");
 
     stdx::lock_guard<stdx::mutex> lk(_identsLock);
 	//
@@ -803,7 +846,15 @@ void KVCatalog::putMetaData(OperationContext* opCtx,
             }
             // missing, create new
             //¼ӵҲ׷ӽȥ
-            newIdentMap.append(name, _newUniqueIdent(ns, "index"));
+            const BSONCollectionCatalogEntry::IndexMetaData& index = md.indexes[i];
+            if (index.prefix.isPrefixed() && canShareTable(ns, md.options) &&
+                !index.spec.hasField("storageEngine")) {
+                // Index versions have different on-disk key formats, so they don't share tables.
+                const std::string tag = str::stream() << 'v' << index.spec["v"].numberInt() << '-';
+                newIdentMap.append(name, _groupIdent(ns, "index", tag, index.prefix));
+            } else {
+                newIdentMap.append(name, _newUniqueIdent(ns, "index"));
+            }
         }
         b.append("idxIdent", newIdentMap.obj());
 
@@ -952,6 +1003,13 @@ std::vector<std::string> KVCatalog::getAllIdents(OperationContext* opCtx) const
 }
 
 //ûݰͨݺ
+bool KVCatalog::isGroupedIdent(StringData ident) {
+    const size_t lastSlash = ident.rfind('/');
+    const StringData name = lastSlash == std::string::npos ? ident : ident.substr(lastSlash + 1);
+    return name.startsWith(kGroupIdentPrefix) ||
+        name.find(kGroupIdentInfix) != std::string::npos;
+}
+
 bool KVCatalog::isUserDataIdent(StringData ident) const {
     return ident.find("index-") != std::string::npos || ident.find("index/") != std::string::npos ||
         ident.find("collection-") != std::string::npos ||
@@ -185,6 +185,13 @@ public:
 
     bool isUserDataIdent(StringData ident) const;
 
+    /**
+     * Returns whether 'ident' names a table shared by grouped collections or indexes. Such a
+     * table outlives the collections and indexes in it: dropping one removes only the entries
+     * under its prefix.
+     */
+    static bool isGroupedIdent(StringData ident);
+
     FeatureTracker* getFeatureTracker() const {
         invariant(_featureTracker);
         return _featureTracker.get();
@@ -203,6 +210,14 @@ private:
      */
     std::string _newUniqueIdent(StringData ns, const char* kind);
 
+    /**
+     * Returns the ident of the shared table that a grouped collection or index with 'prefix'
+     * lives in. There are 'groupCollectionsTableCount' such tables per 'kind' and 'tag', so
+     * unlike _newUniqueIdent() the same ident is handed out many times.
+     * @param tag - distinguishes tables whose entries need a different table configuration
+     */
+    std::string _groupIdent(StringData ns, const char* kind, StringData tag, KVPrefix prefix);
+
     // Helpers only used by constructor and init(). Don't call from elsewhere.
     static std::string _newRand();
     bool _hasEntryCollidingWithRand() const;
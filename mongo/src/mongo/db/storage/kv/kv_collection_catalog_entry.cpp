@@ -196,6 +196,18 @@ Status KVCollectionCatalogEntry::removeIndex(OperationContext* opCtx, StringData
 	//ȡindexӦ·ļ
     const string ident = _catalog->getIndexIdent(opCtx, ns().ns(), indexName);
 
+    // A grouped index shares its table with other grouped indexes, so only its own entries go.
+    // They go in this unit of work rather than on commit, so that a crash can never leave entries
+    // behind under a prefix that is no longer in the catalog and may be handed out again.
+    const bool isGrouped = KVCatalog::isGroupedIdent(ident);
+    if (isGrouped) {
+        const KVPrefix prefix = md.indexes[md.findIndexOffset(indexName)].prefix;
+        Status status = _engine->truncateGroupedIdent(opCtx, ident, prefix);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
 	//BSONCollectionCatalogEntry::MetaData::eraseIndex
 	//Ԫmdбindex
     md.eraseIndex(indexName);
@@ -204,7 +216,9 @@ Status KVCollectionCatalogEntry::removeIndex(OperationContext* opCtx, StringData
     // Lazily remove to isolate underlying engine from rollback.
     //ɾ¼¼ļɾ
     //RemoveIndexChange commitļ
-    opCtx->recoveryUnit()->registerChange(new RemoveIndexChange(opCtx, this, ident));
+    if (!isGrouped) {
+        opCtx->recoveryUnit()->registerChange(new RemoveIndexChange(opCtx, this, ident));
+    }
     return Status::OK();
 }
 
@@ -249,7 +263,8 @@ Status KVCollectionCatalogEntry::prepareForIndexBuild(OperationContext* opCtx,
 
 	//WiredTigerKVEngine::createGroupedSortedDataInterface
     const Status status = _engine->createGroupedSortedDataInterface(opCtx, ident, spec, prefix);
-    if (status.isOK()) {
+    // A shared table must survive a rollback; the index's entries roll back with everything else.
+    if (status.isOK() && !KVCatalog::isGroupedIdent(ident)) {
         opCtx->recoveryUnit()->registerChange(new AddIndexChange(opCtx, this, ident));
     }
 
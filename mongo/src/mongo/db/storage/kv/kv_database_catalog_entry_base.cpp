@@ -105,6 +105,7 @@
 
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/storage/kv/kv_catalog.h"
 #include "mongo/db/storage/kv/kv_catalog_feature_tracker.h"
 #include "mongo/db/storage/kv/kv_collection_catalog_entry.h"
 #include "mongo/db/storage/kv/kv_engine.h"
@@ -377,7 +378,11 @@ Status KVDatabaseCatalogEntryBase::createCollection(OperationContext* opCtx,
 
 
 	//½collection¼¼
-    opCtx->recoveryUnit()->registerChange(new AddCollectionChange(opCtx, this, ns, ident, true));
+    // A shared table must survive a rollback; the collection's records roll back with everything
+    // else.
+    const bool dropOnRollback = !KVCatalog::isGroupedIdent(ident);
+    opCtx->recoveryUnit()->registerChange(
+        new AddCollectionChange(opCtx, this, ns, ident, dropOnRollback));
 	//WiredTigerKVEngine::getGroupedRecordStore
 	//StandardWiredTigerRecordStore,ͱʵϹԸؽӿڲʵϾǶԱKV
 	//һһStandardWiredTigerRecordStoreӦԺԸñĵײ洢KVɸʵ
@@ -405,7 +410,6 @@ Status KVDatabaseCatalogEntryBase::createCollection(OperationContext* opCtx,
 void KVDatabaseCatalogEntryBase::initCollection(OperationContext* opCtx,
                                                 const std::string& ns,
                                                 bool forRepair) {
-    invariant(!_collections.count(ns));
 	
 	//ȡnsӦwtļҲǴ·
     const std::string ident = _engine->getCatalog()->getCollectionIdent(ns);
@@ -428,12 +432,15 @@ void KVDatabaseCatalogEntryBase::initCollection(OperationContext* opCtx,
    //WiredTigerKVEngine--洢    
    //     KVStorageEngine::getCatalog(KVStorageEngine._catalog(KVCatalog))---"_mdb_catalog.wt"Ԫݽӿ
    //                                           StandardWiredTigerRecordStore--ײWT洢KV--Ʊײ洢KVӿ
-    _collections[ns] = new KVCollectionCatalogEntry(
+    auto entry = stdx::make_unique<KVCollectionCatalogEntry>(
    //WiredTigerKVEngine--洢    
    //     KVStorageEngine::getCatalog(KVStorageEngine._catalog(KVCatalog))---"_mdb_catalog.wt"Ԫݽӿ
    //                                                        ident-----ӦļĿ¼
    //                                                            StandardWiredTigerRecordStore--ײWT洢KV--Ʊײ洢KVӿ
         _engine->getEngine(), _engine->getCatalog(), ns, ident, std::move(rs));
+
+    stdx::lock_guard<stdx::mutex> lk(_initCollectionMutex);
+    invariant(_collections.emplace(ns, entry.release()).second);
 }
 
 void KVDatabaseCatalogEntryBase::reinitCollectionAfterRepair(OperationContext* opCtx,
@@ -551,6 +558,16 @@ Status KVDatabaseCatalogEntryBase::dropCollection(OperationContext* opCtx, Strin
 
     const std::string ident = _engine->getCatalog()->getCollectionIdent(ns);
 
+    // A grouped collection shares its table with other grouped collections, so only its own
+    // records go. As with grouped indexes, they go in this unit of work rather than on commit.
+    const bool isGrouped = KVCatalog::isGroupedIdent(ident);
+    if (isGrouped) {
+        Status status = entry->getRecordStore()->truncate(opCtx);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
 	//KVStorageEngine::getCatalogȡKVDatabaseCatalogEntry   KVStorageEngine::getCatalogȡKVCatalog
 	//KVCatalog::dropCollection 
 	//ɾҪԪɾñ
@@ -564,7 +581,7 @@ Status KVDatabaseCatalogEntryBase::dropCollection(OperationContext* opCtx, Strin
     //ıɾͨﴥKVStorageEngine::dropDatabaseеWUOW::commit()ɾ
     opCtx->recoveryUnit()->registerChange(
     //ôRemoveCollectionChange::commitɾ
-        new RemoveCollectionChange(opCtx, this, ns, ident, it->second, true));
+        new RemoveCollectionChange(opCtx, this, ns, ident, it->second, !isGrouped));
 
 	//cacheñ
     _collections.erase(ns.toString());
@@ -33,6 +33,7 @@
 #include <string>
 
 #include "mongo/db/catalog/database_catalog_entry.h"
+#include "mongo/stdx/mutex.h"
 
 namespace mongo {
 
@@ -90,6 +91,10 @@ public:
 
     // --------------
 
+    /**
+     * May be called concurrently for different namespaces, which the storage engine does to open
+     * collections in parallel at startup.
+     */
     void initCollection(OperationContext* opCtx, const std::string& ns, bool forRepair);
 
     void initCollectionBeforeRepair(OperationContext* opCtx, const std::string& ns);
@@ -113,5 +118,9 @@ protected:
     //1. mongodͨKVStorageEngine::KVStorageEngine->KVDatabaseCatalogEntryBase::initCollectionԪ_mdb_catalog.wtмرϢ
     //2. KVDatabaseCatalogEntryBase::createCollectionʵʱ
     CollectionMap _collections;  
+
+    // Serializes initCollection()'s inserts into '_collections'. Everything else relies on the
+    // database lock.
+    stdx::mutex _initCollectionMutex;
 };
 }  // namespace mongo
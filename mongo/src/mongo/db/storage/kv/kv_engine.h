@@ -169,6 +169,18 @@ public:
 
     virtual Status dropIdent(OperationContext* opCtx, StringData ident) = 0;
 
+    /**
+     * Removes the entries stored under 'prefix' from 'ident', a table shared by grouped
+     * collections or indexes, leaving the table in place for its other residents. Runs in the
+     * caller's unit of work, so the entries come back if it rolls back.
+     */
+    virtual Status truncateGroupedIdent(OperationContext* opCtx,
+                                        StringData ident,
+                                        KVPrefix prefix) {
+        return Status(ErrorCodes::CommandNotSupported,
+                      "The current storage engine doesn't support grouped collections");
+    }
+
     // optional
     virtual int flushAllFiles(OperationContext* opCtx, bool sync) {
         return 0;
@@ -486,6 +486,48 @@ TEST(KVCatalogTest, RestartForPrefixes) {
     }
 }
 
+TEST(KVCatalogTest, CappedCollectionDoesNotShareTable) {
+    storageGlobalParams.groupCollections = true;
+    ON_BLOCK_EXIT([&] { storageGlobalParams.groupCollections = false; });
+
+    unique_ptr<KVHarnessHelper> helper(KVHarnessHelper::create());
+    KVEngine* engine = helper->getEngine();
+
+    unique_ptr<RecordStore> rs;
+    unique_ptr<KVCatalog> catalog;
+    {
+        MyOperationContext opCtx(engine);
+        WriteUnitOfWork uow(&opCtx);
+        ASSERT_OK(engine->createRecordStore(&opCtx, "catalog", "catalog", CollectionOptions()));
+        rs = engine->getRecordStore(&opCtx, "catalog", "catalog", CollectionOptions());
+        catalog.reset(new KVCatalog(rs.get(), false, false));
+        uow.commit();
+    }
+
+    CollectionOptions cappedOptions;
+    cappedOptions.capped = true;
+    cappedOptions.cappedSize = 4096;
+
+    {
+        MyOperationContext opCtx(engine);
+        WriteUnitOfWork uow(&opCtx);
+        ASSERT_OK(catalog->newCollection(&opCtx,
+                                         "a.capped",
+                                         cappedOptions,
+                                         KVPrefix::getNextPrefix(NamespaceString("a.capped"))));
+        ASSERT_OK(catalog->newCollection(&opCtx,
+                                         "a.other",
+                                         CollectionOptions(),
+                                         KVPrefix::getNextPrefix(NamespaceString("a.other"))));
+        uow.commit();
+    }
+
+    // Only the non-capped collection goes to a shared table.
+    ASSERT_FALSE(KVCatalog::isGroupedIdent(catalog->getCollectionIdent("a.capped")));
+    ASSERT_TRUE(KVCatalog::isGroupedIdent(catalog->getCollectionIdent("a.other")));
+    ASSERT_TRUE(catalog->isUserDataIdent(catalog->getCollectionIdent("a.capped")));
+}
+
 }  // namespace
 
 std::unique_ptr<KVHarnessHelper> KVHarnessHelper::create() {
@@ -33,11 +33,19 @@
 #include <algorithm>
 
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/kv/kv_database_catalog_entry.h"
 #include "mongo/db/storage/kv/kv_engine.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -61,6 +69,12 @@ namespace {
 const std::string catalogInfo = "_mdb_catalog";
 }
 
+// Number of threads opening the collections of the catalog at startup. 0 means one per core.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(storageEngineStartupThreads, int, 0);
+
+// Fails opening the collection whose namespace is the "ns" field of the fail point's data.
+MONGO_FP_DECLARE(failInitCollectionAtStartup);
+
 //KVEngine(WiredTigerKVEngine)StorageEngine(KVStorageEngine)Ĺϵ: KVStorageEngine._engineΪWiredTigerKVEngine
 //ҲKVStorageEngineWiredTigerKVEngineԱ
 
@@ -150,34 +164,88 @@ KVStorageEngine::KVStorageEngine(
 	//KVCatalog::getAllCollections ȡϢʵҪͨ_mdb_catalog.wtȡԪϢ
     _catalog->getAllCollections(&collections);
 
-    KVPrefix maxSeenPrefix = KVPrefix::kNotPrefixed;
-	//_mdb_catalog.wtнԪϢ
-	//mongodʵҪ_mdb_catalog.wtļȡԪϢ
-    for (size_t i = 0; i < collections.size(); i++) {
-		//_mdb_catalog.wtļлȡͱ
-        std::string coll = collections[i];
-        NamespaceString nss(coll);
-        string dbName = nss.db().toString();
-
+    // Create every database's entry up front, so that the collections can then be opened in
+    // parallel without modifying '_dbs'.
+    for (const auto& coll : collections) {
         // No rollback since this is only for committed dbs.
-
-		//_dbsֵԿһdbnameӦһdb KVDatabaseCatalogEntryBase
+        const std::string dbName = nsToDatabase(coll);
         KVDatabaseCatalogEntryBase*& db = _dbs[dbName];
         if (!db) {
             db = _databaseCatalogEntryFactory(dbName, this).release();
         }
-
-		//KVDatabaseCatalogEntryBase::initCollection
-		//ͬһdbеı洢KVDatabaseCatalogEntryBase._collections[]
-        db->initCollection(&opCtx, coll, options.forRepair);
-        auto maxPrefixForCollection = _catalog->getMetaData(&opCtx, coll).getMaxPrefix();
-        maxSeenPrefix = std::max(maxSeenPrefix, maxPrefixForCollection);
     }
-	
-    KVPrefix::setLargestPrefix(maxSeenPrefix);
+
+    // Startup fails if a collection cannot be opened. Close those which were before the engine.
+    auto closeDatabasesGuard = MakeGuard([this] {
+        for (auto&& db : _dbs) {
+            delete db.second;
+        }
+        _dbs.clear();
+    });
+    KVPrefix::setLargestPrefix(_initCollections(collections, options.forRepair));
+    closeDatabasesGuard.Dismiss();
     opCtx.recoveryUnit()->abandonSnapshot();
 }
 
+KVPrefix KVStorageEngine::_initCollections(const std::vector<std::string>& collections,
+                                           bool forRepair) {
+    size_t numThreads = std::max(storageEngineStartupThreads, 0);
+    if (numThreads == 0) {
+        ProcessInfo pi;
+        numThreads = pi.getNumAvailableCores().value_or(pi.getNumCores());
+    }
+    numThreads = std::max<size_t>(1, std::min(numThreads, collections.size()));
+
+    Timer timer;
+    AtomicUInt64 nextCollection;
+    stdx::mutex mutex;
+    KVPrefix maxSeenPrefix = KVPrefix::kNotPrefixed;  // Guarded by 'mutex'.
+    Status firstError = Status::OK();                 // Guarded by 'mutex'.
+
+    auto initCollections = [&] {
+        OperationContextNoop opCtx(_engine->newRecoveryUnit());
+        try {
+            for (size_t i = nextCollection.fetchAndAdd(1); i < collections.size();
+                 i = nextCollection.fetchAndAdd(1)) {
+                const std::string& coll = collections[i];
+                MONGO_FAIL_POINT_BLOCK(failInitCollectionAtStartup, extraData) {
+                    uassert(ErrorCodes::FailPointEnabled,
+                            str::stream() << "Failpoint (failInitCollectionAtStartup) rejects "
+                                          << coll,
+                            extraData.getData()["ns"].str() != coll);
+                }
+                _dbs.find(nsToDatabase(coll))->second->initCollection(&opCtx, coll, forRepair);
+                auto maxPrefixForCollection = _catalog->getMetaData(&opCtx, coll).getMaxPrefix();
+
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                maxSeenPrefix = std::max(maxSeenPrefix, maxPrefixForCollection);
+            }
+        } catch (...) {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            if (firstError.isOK()) {
+                firstError = exceptionToStatus();
+            }
+            // Startup fails anyway, so let the other threads stop early.
+            nextCollection.store(collections.size());
+        }
+        opCtx.recoveryUnit()->abandonSnapshot();
+    };
+
+    std::vector<stdx::thread> threads;
+    for (size_t i = 1; i < numThreads; ++i) {
+        threads.emplace_back(initCollections);
+    }
+    initCollections();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    uassertStatusOK(firstError);
+
+    LOG(1) << "Opened " << collections.size() << " collections with " << numThreads
+           << " threads in " << timer.millis() << "ms";
+    return maxSeenPrefix;
+}
+
 /**
  * This method reconciles differences between idents the KVEngine is aware of and the
  * KVCatalog. There are three differences to consider:
@@ -313,6 +313,12 @@ public:
 private:
     class RemoveDBChange;
 
+    /**
+     * Opens the collections in 'collections', whose databases must already be in '_dbs', using
+     * up to 'storageEngineStartupThreads' threads. Returns the largest prefix they use.
+     */
+    KVPrefix _initCollections(const std::vector<std::string>& collections, bool forRepair);
+
     //KVStorageEngine::getDatabaseCatalogEntryKVStorageEngine::KVStorageEngineеøfactory
     //ĬΪdefaultDatabaseCatalogEntryFactory
     stdx::function<KVDatabaseCatalogEntryFactory> _databaseCatalogEntryFactory;
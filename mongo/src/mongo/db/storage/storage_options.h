@@ -126,9 +126,9 @@ struct StorageGlobalParams {
     bool readOnly = false;
 
     // --groupCollections
-    // Dictate to the storage engine that it should attempt to create new MongoDB collections from
-    // an existing underlying MongoDB database level resource if possible. This can improve
-    // workloads that rely heavily on creating many collections within a database.
+    // Dictate to the storage engine that it should attempt to create new MongoDB collections and
+    // indexes in existing, shared tables if possible, keeping them apart by key prefix. This can
+    // improve workloads that rely heavily on creating many collections.
     bool groupCollections = false;
 };
 
@@ -753,6 +753,32 @@ private:
     std::vector<std::pair<RecordId, KeyString::TypeBits>> _records;
 };
 
+/**
+ * Builds a prefixed index through the same cursors as regular inserts. A prefixed index shares its
+ * table with other collections' indexes, and a bulk cursor would hold that table exclusively:
+ * every other index in it would fail to open a cursor with EBUSY until the build finished.
+ */
+class WiredTigerIndex::PrefixedBuilder : public SortedDataBuilderInterface {
+public:
+    PrefixedBuilder(WiredTigerIndex* idx, OperationContext* opCtx, bool dupsAllowed)
+        : _idx(idx), _opCtx(opCtx), _dupsAllowed(dupsAllowed) {}
+
+    Status addKey(const BSONObj& key, const RecordId& id) {
+        // Like the bulk builders, make each key durable on its own when the caller has no unit of
+        // work open.
+        WriteUnitOfWork uow(_opCtx);
+        const Status s = _idx->insert(_opCtx, key, id, _dupsAllowed);
+        if (s.isOK())
+            uow.commit();
+        return s;
+    }
+
+private:
+    WiredTigerIndex* const _idx;
+    OperationContext* const _opCtx;
+    const bool _dupsAllowed;
+};
+
 namespace {
 
 /**
@@ -1195,6 +1221,8 @@ std::unique_ptr<SortedDataInterface::Cursor> WiredTigerIndexUnique::newCursor(
 
 SortedDataBuilderInterface* WiredTigerIndexUnique::getBulkBuilder(OperationContext* opCtx,
                                                                   bool dupsAllowed) {
+    if (_prefix.isPrefixed())
+        return new PrefixedBuilder(this, opCtx, dupsAllowed);
     return new UniqueBulkBuilder(this, opCtx, dupsAllowed, _prefix);
 }
 
@@ -1484,6 +1512,8 @@ SortedDataBuilderInterface* WiredTigerIndexStandard::getBulkBuilder(OperationCon
                                                                     bool dupsAllowed) {
     // We aren't unique so dups better be allowed.
     invariant(dupsAllowed);
+    if (_prefix.isPrefixed())
+        return new PrefixedBuilder(this, opCtx, dupsAllowed);
     return new StandardBulkBuilder(this, opCtx, _prefix);
 }
 
@@ -160,6 +160,7 @@ protected:
     class BulkBuilder;
     class StandardBulkBuilder;
     class UniqueBulkBuilder;
+    class PrefixedBuilder;
 
     const Ordering _ordering;
     // The keystring version is effectively const after the WiredTigerIndex instance is constructed.
@@ -45,6 +45,7 @@
 #include <boost/filesystem/operations.hpp>
 #include <valgrind/valgrind.h>
 
+#include "mongo/base/checked_cast.h"
 #include "mongo/base/error_codes.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/bson/dotted_path_support.h"
@@ -70,6 +71,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
@@ -81,6 +83,7 @@
 #include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 //wiredtigerеwtļͨ·ʽwt:wt -C "extensions=[/usr/local/lib/libwiredtiger_snappy.so]" -h . dump table:_mdb_catalog
 
@@ -334,11 +337,89 @@ TicketHolder openReadTransaction(128);
 TicketServerParameter openReadTransactionParam(&openReadTransaction,
                                                "wiredTigerConcurrentReadTransactions");
 
+// Used instead of 'openReadTransaction' by reads which yielded, when adaptive concurrency is on.
+TicketHolder openLongRunningReadTransaction(16);
+TicketServerParameter openLongRunningReadTransactionParam(
+    &openLongRunningReadTransaction, "wiredTigerConcurrentLongRunningReadTransactions");
+
+// Resize the read and write ticket pools from the observed throughput, queueing and cache
+// pressure, and give reads which yielded their own pool of tickets.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerAdaptiveConcurrency, bool, false);
+
+// Open tables in the background after startup, so that the first operations on each collection
+// and index do not pay for opening its data handle. Each opened table keeps a file handle until
+// it has been idle for 'close_idle_time', so this is off by default and opens at most
+// 'wiredTigerWarmUpTablesLimit' tables.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerWarmUpTables, bool, false);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerWarmUpTablesLimit, int, 1000);
+
 stdx::function<bool(StringData)> initRsOplogBackgroundThreadCallback = [](StringData) -> bool {
     fassertFailed(40358);
 };
 }  // namespace
 
+class WiredTigerKVEngine::WiredTigerTableWarmer : public BackgroundJob {
+public:
+    explicit WiredTigerTableWarmer(WT_CONNECTION* conn)
+        : BackgroundJob(false /* deleteSelf */), _conn(conn) {}
+
+    virtual string name() const {
+        return "WTTableWarmer";
+    }
+
+    virtual void run() {
+        Client::initThread(name().c_str());
+
+        LOG(1) << "starting " << name() << " thread";
+
+        Timer timer;
+        WiredTigerSession session(_conn);
+        WT_SESSION* s = session.getSession();
+
+        std::vector<std::string> uris;
+        {
+            WT_CURSOR* c = nullptr;
+            invariantWTOK(s->open_cursor(s, "metadata:", nullptr, nullptr, &c));
+            ON_BLOCK_EXIT(c->close, c);
+            const size_t limit = std::max(wiredTigerWarmUpTablesLimit, 0);
+            while (!_shuttingDown.load() && uris.size() < limit && c->next(c) == 0) {
+                const char* key;
+                invariantWTOK(c->get_key(c, &key));
+                if (StringData(key).startsWith("table:")) {
+                    uris.emplace_back(key);
+                }
+            }
+        }
+
+        // Opening a cursor opens the table's data handle, which stays open after the cursor is
+        // closed until the handle has been idle for 'close_idle_time'. Errors are ignored, since
+        // a table may be dropped concurrently and the first real use opens it anyway.
+        size_t numOpened = 0;
+        for (const auto& uri : uris) {
+            if (_shuttingDown.load()) {
+                break;
+            }
+            WT_CURSOR* c = nullptr;
+            if (s->open_cursor(s, uri.c_str(), nullptr, nullptr, &c) == 0) {
+                c->close(c);
+                ++numOpened;
+            }
+        }
+
+        log() << "Opened " << numOpened << " of " << uris.size() << " WiredTiger tables in "
+              << timer.millis() << "ms";
+    }
+
+    void shutdown() {
+        _shuttingDown.store(true);
+        wait();
+    }
+
+private:
+    WT_CONNECTION* _conn;
+    AtomicBool _shuttingDown{false};
+};
+
 /*
 wiredtiger:
 //error_check(wiredtiger_open(home, NULL, CONN_CONFIG, &conn));
@@ -516,6 +597,18 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
 
 	//WiredTigerKVEngine::WiredTigerKVEngine->Locker::setGlobalThrottling
     Locker::setGlobalThrottling(&openReadTransaction, &openWriteTransaction);
+
+    if (wiredTigerAdaptiveConcurrency) {
+        Locker::setLongRunningReadThrottling(&openLongRunningReadTransaction);
+        _ticketController = stdx::make_unique<WiredTigerTicketController>(
+            _sessionCache.get(), &openReadTransaction, &openWriteTransaction);
+        _ticketController->go();
+    }
+
+    if (wiredTigerWarmUpTables && !_ephemeral && !repair) {
+        _tableWarmer = stdx::make_unique<WiredTigerTableWarmer>(_conn);
+        _tableWarmer->go();
+    }
 }
 
 
@@ -559,6 +652,13 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("totalTickets", openReadTransaction.outof());
         bbb.done();
     }
+    if (wiredTigerAdaptiveConcurrency) {
+        BSONObjBuilder bbb(bb.subobjStart("longRunningRead"));
+        bbb.append("out", openLongRunningReadTransaction.used());
+        bbb.append("available", openLongRunningReadTransaction.available());
+        bbb.append("totalTickets", openLongRunningReadTransaction.outof());
+        bbb.done();
+    }
     bb.done();
 }
 
@@ -588,6 +688,10 @@ void WiredTigerKVEngine::cleanShutdown() {
             _journalFlusher->shutdown();
         if (_checkpointThread)
             _checkpointThread->shutdown();
+        if (_ticketController)
+            _ticketController->shutdown();
+        if (_tableWarmer)
+            _tableWarmer->shutdown();
         _sizeStorer.reset();
         _sessionCache->shuttingDown();
 
@@ -684,7 +788,9 @@ Status WiredTigerKVEngine::okToRename(OperationContext* opCtx,
                                       StringData ident,
                                       const RecordStore* originalRecordStore) const {
     _sizeStorer->storeToCache(
-        _uri(ident), originalRecordStore->numRecords(opCtx), originalRecordStore->dataSize(opCtx));
+        checked_cast<const WiredTigerRecordStore*>(originalRecordStore)->getSizeStorerURI(),
+        originalRecordStore->numRecords(opCtx),
+        originalRecordStore->dataSize(opCtx));
     syncSizeInfo(true);
     return Status::OK();
 }
@@ -1121,6 +1227,14 @@ Status WiredTigerKVEngine::dropIdent(OperationContext* opCtx, StringData ident)
     return Status::OK();
 }
 
+Status WiredTigerKVEngine::truncateGroupedIdent(OperationContext* opCtx,
+                                                StringData ident,
+                                                KVPrefix prefix) {
+    invariant(prefix.isPrefixed());
+    WT_SESSION* session = WiredTigerRecoveryUnit::get(opCtx)->getSession()->getSession();
+    return WiredTigerUtil::truncatePrefix(session, _uri(ident), prefix.repr());
+}
+
 //cacheк_identToDropƥcursorҳ뵽toDropУں
 //WiredTigerSession::closeCursorsForQueuedDropsеãȻͷЩcursor
 std::list<WiredTigerCachedCursor> WiredTigerKVEngine::filterCursorsWithQueuedDrops(
@@ -53,6 +53,7 @@ class JournalListener;
 class WiredTigerRecordStore;
 class WiredTigerSessionCache;
 class WiredTigerSizeStorer;
+class WiredTigerTicketController;
 
 //wiredtigerеwtļͨ·ʽwt(עwtùٷ):
 //  1. wt -C "extensions=[/usr/local/lib/libwiredtiger_snappy.so]" -h . dump table:_mdb_catalog
@@ -148,6 +149,8 @@ public:
 
     virtual Status dropIdent(OperationContext* opCtx, StringData ident);
 
+    Status truncateGroupedIdent(OperationContext* opCtx, StringData ident, KVPrefix prefix) override;
+
     virtual Status okToRename(OperationContext* opCtx,
                               StringData fromNS,
                               StringData toNS,
@@ -271,6 +274,7 @@ public:
 private:
     class WiredTigerJournalFlusher;
     class WiredTigerCheckpointThread;
+    class WiredTigerTableWarmer;
 
     Status _salvageIfNeeded(const char* uri);
     void _checkIdentPath(StringData ident);
@@ -315,6 +319,8 @@ private:
     
     std::unique_ptr<WiredTigerJournalFlusher> _journalFlusher;  // Depends on _sizeStorer
     std::unique_ptr<WiredTigerCheckpointThread> _checkpointThread;
+    std::unique_ptr<WiredTigerTicketController> _ticketController;
+    std::unique_ptr<WiredTigerTableWarmer> _tableWarmer;
 
     std::string _rsOptions;
     std::string _indexOptions;
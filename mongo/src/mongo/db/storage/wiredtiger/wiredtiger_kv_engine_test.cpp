@@ -33,12 +33,22 @@
 
 #include "mongo/db/storage/kv/kv_engine_test_harness.h"
 
+#include "mongo/base/checked_cast.h"
 #include "mongo/base/init.h"
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/kv/kv_collection_catalog_entry.h"
+#include "mongo/db/storage/kv/kv_database_catalog_entry_mock.h"
+#include "mongo/db/storage/kv/kv_storage_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
+#include "mongo/util/fail_point_service.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -80,5 +90,124 @@ MONGO_INITIALIZER(RegisterKVHarnessFactory)(InitializerContext*) {
     return Status::OK();
 }
 
+class WiredTigerKVStorageEngineStartupTest : public unittest::Test {
+public:
+    static const int kNumCollections = 24;
+
+    WiredTigerKVStorageEngineStartupTest() : _dbpath("wt-kv-storage-engine-startup") {}
+
+    void setUp() final {
+        setStartupThreads("4");
+    }
+
+    void tearDown() final {
+        setStartupThreads("0");
+    }
+
+protected:
+    static void setStartupThreads(const std::string& value) {
+        auto parameter =
+            ServerParameterSet::getGlobal()->getMap().at("storageEngineStartupThreads");
+        ASSERT_OK(parameter->setFromString(value));
+    }
+
+    std::unique_ptr<KVStorageEngine> startStorageEngine() {
+        return stdx::make_unique<KVStorageEngine>(new WiredTigerKVEngine(kWiredTigerEngineName,
+                                                                         _dbpath.path(),
+                                                                         &_cs,
+                                                                         "",
+                                                                         1,
+                                                                         false,
+                                                                         false,
+                                                                         false,
+                                                                         false),
+                                                  KVStorageEngineOptions(),
+                                                  kvDatabaseCatalogEntryMockFactory);
+    }
+
+    static std::string collectionName(int i) {
+        return str::stream() << "db" << i % 3 << ".coll" << i;
+    }
+
+    static RecordStore* getRecordStore(KVStorageEngine* storageEngine,
+                                       OperationContext* opCtx,
+                                       const std::string& ns) {
+        auto dbce = storageEngine->getDatabaseCatalogEntry(opCtx, nsToDatabaseSubstring(ns));
+        auto cce = checked_cast<KVCollectionCatalogEntry*>(dbce->getCollectionCatalogEntry(ns));
+        ASSERT(cce);
+        return cce->getRecordStore();
+    }
+
+    static RecordId insertRecord(OperationContext* opCtx, RecordStore* rs) {
+        WriteUnitOfWork uow(opCtx);
+        auto id = unittest::assertGet(rs->insertRecord(opCtx, "data", 5, Timestamp(), false));
+        uow.commit();
+        return id;
+    }
+
+    /**
+     * Creates the collections, each with three records of which the first is deleted, so that its
+     * largest RecordId is 3 while it only has 2 records, and shuts the storage engine down.
+     */
+    void createCollections() {
+        auto storageEngine = startStorageEngine();
+        {
+            OperationContextNoop opCtx(storageEngine->newRecoveryUnit());
+            for (int i = 0; i < kNumCollections; i++) {
+                const std::string ns = collectionName(i);
+                {
+                    WriteUnitOfWork uow(&opCtx);
+                    auto dbce =
+                        storageEngine->getDatabaseCatalogEntry(&opCtx, nsToDatabaseSubstring(ns));
+                    ASSERT_OK(dbce->createCollection(&opCtx, ns, CollectionOptions(), false));
+                    uow.commit();
+                }
+
+                RecordStore* rs = getRecordStore(storageEngine.get(), &opCtx, ns);
+                const RecordId first = insertRecord(&opCtx, rs);
+                insertRecord(&opCtx, rs);
+                ASSERT_EQ(insertRecord(&opCtx, rs), RecordId(3));
+
+                WriteUnitOfWork uow(&opCtx);
+                rs->deleteRecord(&opCtx, first);
+                uow.commit();
+            }
+        }
+        storageEngine->cleanShutdown();
+    }
+
+    ClockSourceMock _cs;
+    unittest::TempDir _dbpath;
+};
+
+TEST_F(WiredTigerKVStorageEngineStartupTest, OpensEveryCollectionOnSeveralThreads) {
+    createCollections();
+
+    auto storageEngine = startStorageEngine();
+    ON_BLOCK_EXIT([&] { storageEngine->cleanShutdown(); });
+
+    OperationContextNoop opCtx(storageEngine->newRecoveryUnit());
+    for (int i = 0; i < kNumCollections; i++) {
+        RecordStore* rs = getRecordStore(storageEngine.get(), &opCtx, collectionName(i));
+        ASSERT_EQ(rs->numRecords(&opCtx), 2);
+
+        // The next RecordId of a table opened without positioning a cursor on it is computed by
+        // the first insert, and must follow the largest one in the table rather than the count.
+        ASSERT_EQ(insertRecord(&opCtx, rs), RecordId(4));
+        ASSERT_EQ(insertRecord(&opCtx, rs), RecordId(5));
+        ASSERT_EQ(rs->numRecords(&opCtx), 4);
+    }
+}
+
+TEST_F(WiredTigerKVStorageEngineStartupTest, FailureToOpenACollectionFailsStartup) {
+    createCollections();
+
+    auto failPoint = getGlobalFailPointRegistry()->getFailPoint("failInitCollectionAtStartup");
+    failPoint->setMode(FailPoint::alwaysOn, 0, BSON("ns" << collectionName(kNumCollections / 2)));
+    ON_BLOCK_EXIT([&] { failPoint->setMode(FailPoint::off); });
+
+    ASSERT_THROWS_CODE(startStorageEngine(), AssertionException, ErrorCodes::FailPointEnabled);
+}
+
 }  // namespace
 }  // namespace mongo
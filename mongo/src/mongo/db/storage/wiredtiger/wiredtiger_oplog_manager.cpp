@@ -34,9 +34,12 @@
 #include <cstring>
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_oplog_manager.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -47,6 +50,10 @@ const uint64_t kMinimumTimestamp = 1;
 
 MONGO_FP_DECLARE(WTPausePrimaryOplogDurabilityLoop);
 
+// When false, oplog entries become visible to readers as soon as all earlier oplog writes have
+// committed, without waiting for a journal flush. In-memory storage engines never wait.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerOplogVisibilityWaitsForJournal, bool, true);
+
 /*
 MongoDB Ҫ֧ majority  readConcern   replication.enableMajorityReadConcern  
  MongoDB һsnapshot ̣߳ ԵĶԵǰݼsnapshot ¼ snapshot ʱ
@@ -84,15 +91,26 @@ void WiredTigerOplogManager::start(OperationContext* opCtx,
     stdx::lock_guard<stdx::mutex> lk(_oplogVisibilityStateMutex);
     _isRunning = true;
     _shuttingDown = false;
+
+    auto engine = sessionCache->getKVEngine();
+    _visibilityWaitsForJournal =
+        wiredTigerOplogVisibilityWaitsForJournal && !(engine && engine->isEphemeral());
+    _sessionCache = sessionCache;
+    _oplogRecordStore = oplogRecordStore;
+    _updateOldestTimestamp = updateOldestTimestamp;
 }
 
 //WiredTigerKVEngine::haltOplogManagerеִ
 void WiredTigerOplogManager::halt() {
     {
-        stdx::lock_guard<stdx::mutex> lk(_oplogVisibilityStateMutex);
+        stdx::unique_lock<stdx::mutex> lk(_oplogVisibilityStateMutex);
         invariant(_isRunning);
         _shuttingDown = true;
         _isRunning = false;
+
+        // Committers which are advancing visibility themselves still use the oplog record store
+        // and the session cache.
+        _inlineAdvancersDoneCV.wait(lk, [&] { return _numInlineAdvancers == 0; });
     }
 
     if (_oplogJournalThread.joinable()) {
@@ -150,7 +168,20 @@ void WiredTigerOplogManager::waitForAllEarlierOplogWritesToBeVisible(
 
 //WiredTigerKVEngine::replicationBatchIsCompleteеִ
 void WiredTigerOplogManager::triggerJournalFlush() {
-    stdx::lock_guard<stdx::mutex> lk(_oplogVisibilityStateMutex);
+    stdx::unique_lock<stdx::mutex> lk(_oplogVisibilityStateMutex);
+    if (_isRunning && !_shuttingDown && !_visibilityWaitsForJournal) {
+        ++_numInlineAdvancers;
+        lk.unlock();
+        ON_BLOCK_EXIT([&] {
+            lk.lock();
+            if (--_numInlineAdvancers == 0) {
+                _inlineAdvancersDoneCV.notify_all();
+            }
+        });
+        _advanceOplogVisibility();
+        return;
+    }
+
     if (!_opsWaitingForJournal) {
         _opsWaitingForJournal = true;
         _opsWaitingForJournalCV.notify_one();
@@ -214,6 +245,26 @@ void WiredTigerOplogManager::_oplogJournalThreadLoop(WiredTigerSessionCache* ses
     }
 }
 
+void WiredTigerOplogManager::_advanceOplogVisibility() {
+    // The all-committed timestamp only moves past a hole in the oplog once the transaction which
+    // left it commits, so whichever committer closes the last hole publishes the new entries.
+    const uint64_t newTimestamp = _fetchAllCommittedValue(_sessionCache->conn());
+    {
+        stdx::lock_guard<stdx::mutex> lk(_oplogVisibilityStateMutex);
+        // Concurrent committers race to publish; only ever move visibility forward here.
+        if (newTimestamp <= _oplogReadTimestamp.load()) {
+            return;
+        }
+        _setOplogReadTimestamp(lk, newTimestamp);
+    }
+
+    _oplogRecordStore->notifyCappedWaitersIfNeeded();
+
+    if (_updateOldestTimestamp) {
+        _sessionCache->getKVEngine()->advanceOldestTimestamp(Timestamp(newTimestamp));
+    }
+}
+
 std::uint64_t WiredTigerOplogManager::getOplogReadTimestamp() const {
     return _oplogReadTimestamp.load();
 }
@@ -73,7 +73,10 @@ public:
     std::uint64_t getOplogReadTimestamp() const;
     void setOplogReadTimestamp(Timestamp ts);
 
-    // Triggers the oplogJournal thread to update its oplog read timestamp, by flushing the journal.
+    // Called when a timestamped transaction commits or a replication batch completes. If oplog
+    // visibility does not have to wait for the journal, advances the oplog read timestamp right
+    // away and wakes oplog readers. Otherwise triggers the oplogJournal thread to update its oplog
+    // read timestamp, by flushing the journal.
     void triggerJournalFlush();
 
     // Waits until all committed writes at this point to become visible (that is, no holes exist in
@@ -88,6 +91,12 @@ private:
 
     void _setOplogReadTimestamp(WithLock, uint64_t newTimestamp);
 
+    /**
+     * Advances the oplog read timestamp to the all-committed timestamp, if that is newer, and
+     * wakes oplog readers. Runs on the thread which triggered it.
+     */
+    void _advanceOplogVisibility();
+
     uint64_t _fetchAllCommittedValue(WT_CONNECTION* conn);
 
     stdx::thread _oplogJournalThread;
@@ -96,6 +105,8 @@ private:
         _opsWaitingForJournalCV;  // Signaled to trigger a journal flush.
     mutable stdx::condition_variable
         _opsBecameVisibleCV;  // Signaled when a journal flush is complete.
+    stdx::condition_variable
+        _inlineAdvancersDoneCV;  // Signaled when _numInlineAdvancers drops to zero.
 
     bool _isRunning = false;     // Guarded by the oplogVisibilityStateMutex.
     bool _shuttingDown = false;  // Guarded by oplogVisibilityStateMutex.
@@ -105,6 +116,16 @@ private:
     RecordId _oplogMaxAtStartup = RecordId(0);  // Guarded by oplogVisibilityStateMutex.
     bool _opsWaitingForJournal = false;         // Guarded by oplogVisibilityStateMutex.
 
+    // Set by start(). When false, committers advance oplog visibility themselves instead of
+    // waiting for the oplogJournal thread to flush the journal.
+    bool _visibilityWaitsForJournal = true;  // Guarded by oplogVisibilityStateMutex.
+
+    // Committers running _advanceOplogVisibility(). halt() waits for them to finish.
+    int _numInlineAdvancers = 0;  // Guarded by oplogVisibilityStateMutex.
+    WiredTigerSessionCache* _sessionCache = nullptr;
+    WiredTigerRecordStore* _oplogRecordStore = nullptr;
+    bool _updateOldestTimestamp = false;
+
     //οhttp://www.mongoing.com/archives/25302  ʱ߼ʱ
     AtomicUInt64 _oplogReadTimestamp;
 };
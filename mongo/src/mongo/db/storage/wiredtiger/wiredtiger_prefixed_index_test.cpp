@@ -110,5 +110,37 @@ MONGO_INITIALIZER(RegisterHarnessFactory)(InitializerContext* const) {
     mongo::registerHarnessHelperFactory(makeHarnessHelper);
     return Status::OK();
 }
+
+// Building an index must not lock the other indexes in its table out, even when the table is
+// still empty when the build starts.
+TEST(WiredTigerPrefixedIndex, BuildingAnIndexLeavesItsTableUsableByOtherIndexes) {
+    MyHarnessHelper harnessHelper;
+    const std::unique_ptr<SortedDataInterface> idle(harnessHelper.newSortedDataInterface(false));
+    const std::unique_ptr<SortedDataInterface> built(harnessHelper.newSortedDataInterface(false));
+
+    auto otherClient = harnessHelper.serviceContext()->makeClient("other");
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+        const std::unique_ptr<SortedDataBuilderInterface> builder(
+            built->getBulkBuilder(opCtx.get(), true));
+        ASSERT_OK(builder->addKey(BSON("" << 1), RecordId(1)));
+
+        const ServiceContext::UniqueOperationContext otherOpCtx(
+            harnessHelper.newOperationContext(otherClient.get()));
+        ASSERT(!idle->newCursor(otherOpCtx.get())->seek(BSON("" << 1), true));
+        {
+            WriteUnitOfWork uow(otherOpCtx.get());
+            ASSERT_OK(idle->insert(otherOpCtx.get(), BSON("" << 2), RecordId(2), true));
+            uow.commit();
+        }
+
+        ASSERT_OK(builder->addKey(BSON("" << 3), RecordId(3)));
+        builder->commit(false);
+    }
+
+    const ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+    ASSERT_EQUALS(2, built->numEntries(opCtx.get()));
+    ASSERT_EQUALS(1, idle->numEntries(opCtx.get()));
+}
 }  // namespace
 }  // namespace mongo
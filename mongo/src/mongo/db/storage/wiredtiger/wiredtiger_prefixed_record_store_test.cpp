@@ -250,5 +250,43 @@ TEST(WiredTigerRecordStoreTest, PrefixedSeekingCursor) {
     ASSERT(!cursor->seekExact(RecordId(startRecordId.repr() + numDocs)));
 }
 
+TEST(WiredTigerRecordStoreTest, PrefixedTruncateLeavesOtherPrefixes) {
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper = newRecordStoreHarnessHelper();
+    // Both record stores share the table "a.b" under different prefixes.
+    unique_ptr<RecordStore> rs = harnessHelper->newNonCappedRecordStore("a.b");
+    unique_ptr<RecordStore> otherRs = harnessHelper->newNonCappedRecordStore("a.b");
+
+    const int numDocs = 100;
+    {  // Insert documents.
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        for (int num = 0; num < numDocs; ++num) {
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_OK(rs->insertRecord(opCtx.get(), "a", 2, Timestamp(), false).getStatus());
+            ASSERT_OK(otherRs->insertRecord(opCtx.get(), "b", 2, Timestamp(), false).getStatus());
+            uow.commit();
+        }
+    }
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        ASSERT_OK(rs->truncate(opCtx.get()));
+        uow.commit();
+    }
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    ASSERT_EQUALS(0, rs->numRecords(opCtx.get()));
+    ASSERT(!rs->getCursor(opCtx.get())->next());
+
+    ASSERT_EQUALS(numDocs, otherRs->numRecords(opCtx.get()));
+    auto cursor = otherRs->getCursor(opCtx.get());
+    for (int num = 0; num < numDocs; ++num) {
+        auto record = cursor->next();
+        ASSERT(record);
+        ASSERT_EQUALS(std::string("b"), record->data.data());
+    }
+    ASSERT(!cursor->next());
+}
+
 }  // namespace
 }  // mongo
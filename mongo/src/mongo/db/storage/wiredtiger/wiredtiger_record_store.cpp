@@ -44,6 +44,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
@@ -85,6 +86,10 @@ void checkOplogFormatVersion(OperationContext* opCtx, const std::string& uri) {
 }
 }  // namespace
 
+// When true, record stores with their counts in the size storer do not position a cursor on their
+// table at startup. The next RecordId is then computed on the first insert.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerDeferTableOpen, bool, true);
+
 MONGO_FP_DECLARE(WTWriteConflictException);
 MONGO_FP_DECLARE(WTWriteConflictExceptionForReads);
 
@@ -632,6 +637,7 @@ WiredTigerRecordStore::WiredTigerRecordStore(WiredTigerKVEngine* kvEngine,
       _cappedDeleteCheckCount(0),
       _sizeStorer(params.sizeStorer),
       _sizeStorerCounter(0),
+      _sizeStorerUri(params.uri),
       _kvEngine(kvEngine) {
     Status versionStatus = WiredTigerUtil::checkApplicationMetadataFormatVersion(
                                ctx, _uri, kMinimumRecordStoreVersion, kMaximumRecordStoreVersion)
@@ -689,6 +695,20 @@ WiredTigerRecordStore::~WiredTigerRecordStore() {
 
 //ʼȡǰtableRecordId startOplogManager OplogBackgroundThread
 void WiredTigerRecordStore::postConstructorInit(OperationContext* opCtx) {
+    if (wiredTigerDeferTableOpen && _sizeStorer && !_isOplog &&
+        !WiredTigerKVEngine::initRsOplogBackgroundThread(ns())) {
+        // Opening a cursor on the table is what makes startup slow with many collections, and
+        // the counts do not need it. '_nextIdNum' is initialized by the first insert instead.
+        long long numRecords;
+        long long dataSize;
+        _sizeStorer->loadFromCache(_sizeStorerUri, &numRecords, &dataSize);
+        _numRecords.store(numRecords);
+        _dataSize.store(dataSize);
+        _sizeStorer->onCreate(this, numRecords, dataSize);
+        return;
+    }
+    _nextIdNumInitialized.store(true);
+
     // Find the largest RecordId currently in use and estimate the number of records.
     //ȡñtablerecordID
     std::unique_ptr<SeekableRecordCursor> cursor = getCursor(opCtx, /*forward=*/false);
@@ -700,7 +720,7 @@ void WiredTigerRecordStore::postConstructorInit(OperationContext* opCtx) {
             long long numRecords;
             long long dataSize;
 			//ȡǰ
-            _sizeStorer->loadFromCache(_uri, &numRecords, &dataSize);
+            _sizeStorer->loadFromCache(_sizeStorerUri, &numRecords, &dataSize);
             _numRecords.store(numRecords);
             _dataSize.store(dataSize);
             _sizeStorer->onCreate(this, numRecords, dataSize);
@@ -1204,6 +1224,10 @@ Status WiredTigerRecordStore::_insertRecords(OperationContext* opCtx,
     WT_CURSOR* c = curwrap.get(); //WiredTigerCursor._cursorԱ
     invariant(c);
 
+    if (!_isOplog) {
+        _initNextIdNumIfNeeded(opCtx);
+    }
+
 	//ñһд뵽洢idкż¼ģ´ݽ
     RecordId highestId = RecordId();
     dassert(nRecords != 0);
@@ -1635,12 +1659,35 @@ void WiredTigerRecordStore::updateStatsAfterRepair(OperationContext* opCtx,
     _dataSize.store(dataSize);
 
     if (_sizeStorer) {
-        _sizeStorer->storeToCache(_uri, numRecords, dataSize);
+        _sizeStorer->storeToCache(_sizeStorerUri, numRecords, dataSize);
+    }
+}
+
+void WiredTigerRecordStore::_initNextIdNumIfNeeded(OperationContext* opCtx) {
+    if (_nextIdNumInitialized.load()) {
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_nextIdNumMutex);
+    if (_nextIdNumInitialized.load()) {
+        return;
+    }
+
+    // Nothing has been inserted since the table was opened, so every record is committed and
+    // visible to this snapshot.
+    std::unique_ptr<SeekableRecordCursor> cursor = getCursor(opCtx, /*forward=*/false);
+    if (auto record = cursor->next()) {
+        _nextIdNum.store(1 + record->id.repr());
+    } else {
+        // Need to start at 1 so we are always higher than RecordId::min()
+        _nextIdNum.store(1);
     }
+    _nextIdNumInitialized.store(true);
 }
 
 RecordId WiredTigerRecordStore::_nextId() {
     invariant(!_isOplog);
+    invariant(_nextIdNumInitialized.load());
     RecordId out = RecordId(_nextIdNum.fetchAndAdd(1));
     invariant(out.isNormal());
     return out;
@@ -1692,7 +1739,7 @@ void WiredTigerRecordStore::_increaseDataSize(OperationContext* opCtx, int64_t a
         _dataSize.store(std::max(amount, int64_t(0)));
 
     if (_sizeStorer && _sizeStorerCounter++ % 1000 == 0) {
-        _sizeStorer->storeToCache(_uri, _numRecords.load(), _dataSize.load());
+        _sizeStorer->storeToCache(_sizeStorerUri, _numRecords.load(), _dataSize.load());
     }
 }
 
@@ -2003,7 +2050,9 @@ PrefixedWiredTigerRecordStore::PrefixedWiredTigerRecordStore(WiredTigerKVEngine*
                                                              OperationContext* opCtx,
                                                              Params params,
                                                              KVPrefix prefix)
-    : WiredTigerRecordStore(kvEngine, opCtx, params), _prefix(prefix) {}
+    : WiredTigerRecordStore(kvEngine, opCtx, params), _prefix(prefix) {
+    _sizeStorerUri = str::stream() << _uri << "?prefix=" << _prefix.repr();
+}
 
 std::unique_ptr<SeekableRecordCursor> PrefixedWiredTigerRecordStore::getCursor(
     OperationContext* opCtx, bool forward) const {
@@ -2026,6 +2075,18 @@ std::unique_ptr<RecordCursor> PrefixedWiredTigerRecordStore::getRandomCursorWith
     return {};
 }
 
+Status PrefixedWiredTigerRecordStore::truncate(OperationContext* opCtx) {
+    WT_SESSION* session = WiredTigerRecoveryUnit::get(opCtx)->getSession()->getSession();
+    Status status = WiredTigerUtil::truncatePrefix(session, _uri, _prefix.repr());
+    if (!status.isOK()) {
+        return status;
+    }
+
+    _changeNumRecords(opCtx, -numRecords(opCtx));
+    _increaseDataSize(opCtx, -dataSize(opCtx));
+    return Status::OK();
+}
+
 RecordId PrefixedWiredTigerRecordStore::getKey(WT_CURSOR* cursor) const {
     std::int64_t prefix;
     std::int64_t recordId;
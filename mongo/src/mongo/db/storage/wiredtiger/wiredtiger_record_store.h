@@ -259,6 +259,14 @@ public:
     const std::string& getURI() const {
         return _uri;
     }
+
+    /**
+     * Returns the key of this record store's sizes in the size storer. Record stores sharing a
+     * table through grouped collections each have their own key.
+     */
+    const std::string& getSizeStorerURI() const {
+        return _sizeStorerUri;
+    }
     uint64_t tableId() const {
         return _tableId;
     }
@@ -312,6 +320,12 @@ private:
                           size_t nRecords);
 
     RecordId _nextId();
+
+    /**
+     * Sets '_nextIdNum' past the largest RecordId in the table, unless postConstructorInit()
+     * already did.
+     */
+    void _initNextIdNumIfNeeded(OperationContext* opCtx);
     void _setId(RecordId id);
     bool cappedAndNeedDelete() const;
     void _changeNumRecords(OperationContext* opCtx, int64_t diff);
@@ -354,12 +368,16 @@ private:
     mutable stdx::timed_mutex _cappedDeleterMutex;
 
     AtomicInt64 _nextIdNum;
+    // False until '_nextIdNum' is known, which may be deferred to the first insert.
+    AtomicBool _nextIdNumInitialized{false};
+    stdx::mutex _nextIdNumMutex;  // serializes the deferred initialization of '_nextIdNum'
     AtomicInt64 _dataSize;
     AtomicInt64 _numRecords;
 
     //
     WiredTigerSizeStorer* _sizeStorer;  // not owned, can be NULL
     int _sizeStorerCounter;
+    std::string _sizeStorerUri;
 
     WiredTigerKVEngine* _kvEngine;  // not owned.
 
@@ -406,6 +424,12 @@ public:
         return _prefix;
     }
 
+    /**
+     * Removes only the records stored under this record store's prefix, since the table may be
+     * shared with other grouped collections.
+     */
+    Status truncate(OperationContext* opCtx) override;
+
 protected:
     virtual RecordId getKey(WT_CURSOR* cursor) const;
 
@@ -40,6 +40,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/kv/kv_prefix.h"
 #include "mongo/db/storage/record_store_test_harness.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
@@ -351,6 +352,47 @@ TEST(WiredTigerRecordStoreTest, OplogDurableVisibilityOutOfOrder) {
     ASSERT(!wtrs->isOpHidden_forTest(id2));
 }
 
+// Test that when oplog visibility does not wait for the journal, the commit which closes the last
+// hole in the oplog makes the entries visible without the oplog journal thread.
+TEST(WiredTigerRecordStoreTest, OplogVisibilityAdvancesOnCommitWithoutJournalFlush) {
+    ServerParameter* waitsForJournal = ServerParameterSet::getGlobal()->getMap().at(
+        "wiredTigerOplogVisibilityWaitsForJournal");
+    ON_BLOCK_EXIT([&] { ASSERT_OK(waitsForJournal->setFromString("true")); });
+    ASSERT_OK(waitsForJournal->setFromString("false"));
+
+    // The journal thread cannot publish anything while the loop is paused.
+    ON_BLOCK_EXIT([] { WTPausePrimaryOplogDurabilityLoop.setMode(FailPoint::off); });
+    WTPausePrimaryOplogDurabilityLoop.setMode(FailPoint::alwaysOn);
+
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("local.oplog.rs", 100000, -1));
+    auto wtrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+
+    ServiceContext::UniqueOperationContext longLivedOp(harnessHelper->newOperationContext());
+    WriteUnitOfWork uow(longLivedOp.get());
+    RecordId id1 = _oplogOrderInsertOplog(longLivedOp.get(), rs, 1);
+    ASSERT(wtrs->isOpHidden_forTest(id1));
+
+    RecordId id2;
+    {
+        auto innerClient = harnessHelper->serviceContext()->makeClient("inner");
+        ServiceContext::UniqueOperationContext opCtx(
+            harnessHelper->newOperationContext(innerClient.get()));
+        WriteUnitOfWork uow(opCtx.get());
+        id2 = _oplogOrderInsertOplog(opCtx.get(), rs, 2);
+        uow.commit();
+    }
+
+    // The uncommitted first entry still hides the second.
+    ASSERT(wtrs->isOpHidden_forTest(id1));
+    ASSERT(wtrs->isOpHidden_forTest(id2));
+
+    uow.commit();
+
+    ASSERT(!wtrs->isOpHidden_forTest(id1));
+    ASSERT(!wtrs->isOpHidden_forTest(id2));
+}
+
 TEST(WiredTigerRecordStoreTest, AppendCustomStatsMetadata) {
     std::unique_ptr<RecordStoreHarnessHelper> harnessHelper = newRecordStoreHarnessHelper();
     unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore("a.b"));
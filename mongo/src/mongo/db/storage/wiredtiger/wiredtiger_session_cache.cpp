@@ -38,13 +38,16 @@
 #include "mongo/base/error_codes.h"
 #include "mongo/db/mongod_options.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 /*
@@ -244,11 +247,43 @@ uint64_t WiredTigerSession::genTableId() {
 
 // -----------------------
 //WiredTigerKVEngine::WiredTigerKVEngineеù
+namespace {
+
+// Upper bound on how long a journal flush waits for more j:true writers to join it. The actual
+// delay adapts to how many writers recent flushes covered. Zero flushes right away.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerGroupCommitMaxDelayMicros, int, 0);
+
+// Number of stripes the session cache is split into. Values less than 1 use one stripe per core.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerSessionCacheStripes, int, 0);
+
+size_t defaultNumStripes() {
+    if (wiredTigerSessionCacheStripes > 0) {
+        return wiredTigerSessionCacheStripes;
+    }
+
+    ProcessInfo pi;
+    return std::max<size_t>(pi.getNumAvailableCores().value_or(pi.getNumCores()), 1);
+}
+
+}  // namespace
+
 WiredTigerSessionCache::WiredTigerSessionCache(WiredTigerKVEngine* engine)
-    : _engine(engine), _conn(engine->getConnection()), _snapshotManager(_conn), _shuttingDown(0) {}
+    : _engine(engine), _conn(engine->getConnection()), _snapshotManager(_conn), _shuttingDown(0) {
+    for (size_t i = 0, numStripes = defaultNumStripes(); i < numStripes; ++i) {
+        _stripes.push_back(stdx::make_unique<Stripe>());
+    }
+}
 
 WiredTigerSessionCache::WiredTigerSessionCache(WT_CONNECTION* conn)
-    : _engine(NULL), _conn(conn), _snapshotManager(_conn), _shuttingDown(0) {}
+    : WiredTigerSessionCache(conn, defaultNumStripes()) {}
+
+WiredTigerSessionCache::WiredTigerSessionCache(WT_CONNECTION* conn, size_t numStripes)
+    : _engine(NULL), _conn(conn), _snapshotManager(_conn), _shuttingDown(0) {
+    invariant(numStripes > 0);
+    for (size_t i = 0; i < numStripes; ++i) {
+        _stripes.push_back(stdx::make_unique<Stripe>());
+    }
+}
 
 WiredTigerSessionCache::~WiredTigerSessionCache() {
     shuttingDown();
@@ -293,6 +328,22 @@ void WiredTigerSessionCache::shuttingDown() {
     _snapshotManager.shutdown(); //WiredTigerSnapshotManager::shutdown
 }
 
+void WiredTigerSessionCache::_waitForFlushGroup(stdx::unique_lock<stdx::mutex>& lk) {
+    const int maxDelayMicros = wiredTigerGroupCommitMaxDelayMicros.load();
+    const auto expectedGroupSize = static_cast<uint64_t>(_avgFlushGroupSize + 0.5);
+    if (maxDelayMicros <= 0 || expectedGroupSize < 2 || _flushWaiters >= expectedGroupSize) {
+        return;
+    }
+
+    // Waiting for writers which are not coming only adds latency, so never wait longer than the
+    // flush itself takes; a writer arriving later than that is better served by the next flush.
+    const auto delay = Microseconds(
+        std::min(static_cast<long long>(maxDelayMicros), static_cast<long long>(_avgFlushMicros)));
+    _flushArrival.wait_for(lk, delay.toSystemDuration(), [&] {
+        return _flushWaiters >= expectedGroupSize;
+    });
+}
+
 //WiredTigerKVEngine::flushAllFiles
 void WiredTigerSessionCache::waitUntilDurable(bool forceCheckpoint, bool stableCheckpoint) {
     // For inMemory storage engines, the data is "as durable as it's going to get".
@@ -339,47 +390,89 @@ void WiredTigerSessionCache::waitUntilDurable(bool forceCheckpoint, bool stableC
         return;
     }
 
-    uint32_t start = _lastSyncTime.load();
-    // Do the remainder in a critical section that ensures only a single thread at a time
-    // will attempt to synchronize.
-    stdx::unique_lock<stdx::mutex> lk(_lastSyncMutex);
-    uint32_t current = _lastSyncTime.loadRelaxed();  // synchronized with writes through mutex
-    if (current != start) {
-        // Someone else synced already since we read lastSyncTime, so we're done!
-        return;
-    }
-    _lastSyncTime.store(current + 1);
+    stdx::unique_lock<stdx::mutex> lk(_flushMutex);
+
+    // Any flush which starts from now on covers all the writes this caller waits for.
+    const uint64_t flushNeeded = _flushesStarted + 1;
+    ++_flushWaiters;
+    _flushArrival.notify_one();
 
-    // Nobody has synched yet, so we have to sync ourselves.
+    while (_flushesCompleted < flushNeeded) {
+        if (_flushInProgress) {
+            _flushCompleted.wait(lk);
+            continue;
+        }
 
-    // This gets the token (OpTime) from the last write, before flushing (either the journal, or a
-    // checkpoint), and then reports that token (OpTime) as a durable write.
-    stdx::unique_lock<stdx::mutex> jlk(_journalListenerMutex);
-    JournalListener::Token token = _journalListener->getToken();
+        // Nobody is flushing, so lead the next flush on behalf of everybody waiting.
+        _flushInProgress = true;
+        ON_BLOCK_EXIT([&] {
+            if (!lk.owns_lock()) {
+                lk.lock();
+            }
+            _flushInProgress = false;
+            _flushCompleted.notify_all();
+        });
 
-    // Initialize on first use.
-    if (!_waitUntilDurableSession) {
-        invariantWTOK(
-            _conn->open_session(_conn, NULL, "isolation=snapshot", &_waitUntilDurableSession));
-    }
+        _waitForFlushGroup(lk);
+        const uint64_t flush = ++_flushesStarted;
+        const uint64_t groupSize = _flushWaiters;
+        _flushWaiters = 0;
 
-    // Use the journal when available, or a checkpoint otherwise.
-    if (_engine && _engine->isDurable()) { //Ӧwiredtigerеlog־ģ
-        invariantWTOK(_waitUntilDurableSession->log_flush(_waitUntilDurableSession, "sync=on"));
-        LOG(4) << "flushed journal";
-    } else { //Ӧcheckpointģ
-        invariantWTOK(_waitUntilDurableSession->checkpoint(_waitUntilDurableSession, NULL));
-        LOG(4) << "created checkpoint";
+        lk.unlock();
+        Timer flushTimer;
+        {
+            // This gets the token (OpTime) from the last write, before flushing (either the
+            // journal, or a checkpoint), and then reports that token (OpTime) as a durable write.
+            stdx::unique_lock<stdx::mutex> jlk(_journalListenerMutex);
+            JournalListener::Token token = _journalListener->getToken();
+
+            // Initialize on first use.
+            if (!_waitUntilDurableSession) {
+                invariantWTOK(_conn->open_session(
+                    _conn, NULL, "isolation=snapshot", &_waitUntilDurableSession));
+            }
+
+            // Use the journal when available, or a checkpoint otherwise.
+            if (_engine && _engine->isDurable()) { //Ӧwiredtigerеlog־ģ
+                invariantWTOK(
+                    _waitUntilDurableSession->log_flush(_waitUntilDurableSession, "sync=on"));
+                LOG(4) << "flushed journal for " << groupSize << " waiters";
+            } else { //Ӧcheckpointģ
+                invariantWTOK(_waitUntilDurableSession->checkpoint(_waitUntilDurableSession, NULL));
+                LOG(4) << "created checkpoint for " << groupSize << " waiters";
+            }
+
+            //ReplicationCoordinatorExternalStateImpl::onDurable
+            _journalListener->onDurable(token);
+        }
+        const auto flushMicros = flushTimer.micros();
+        lk.lock();
+
+        _flushesCompleted = flush;
+        _avgFlushGroupSize += (groupSize - _avgFlushGroupSize) / 8;
+        _avgFlushMicros += (flushMicros - _avgFlushMicros) / 8;
     }
+}
+
+uint64_t WiredTigerSessionCache::numPendingFlushWaiters() const {
+    stdx::lock_guard<stdx::mutex> lk(_flushMutex);
+    return _flushWaiters;
+}
 
-	//ReplicationCoordinatorExternalStateImpl::onDurable
-    _journalListener->onDurable(token);
+WiredTigerSessionCache::Stripe& WiredTigerSessionCache::_stripeForCurrentThread() {
+    // Threads are spread round-robin across stripes on their first use of the cache, and keep
+    // using the same stripe afterwards so that their sessions stay warm in it.
+    static AtomicUInt32 nextThreadSlot;
+    thread_local const unsigned threadSlot = nextThreadSlot.fetchAndAdd(1);
+    return *_stripes[threadSlot % _stripes.size()];
 }
 
 void WiredTigerSessionCache::closeAllCursors(const std::string& uri) {
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeAllCursors(uri); //WiredTigerSession::closeAllCursors
+    for (auto& stripe : _stripes) {
+        stdx::lock_guard<stdx::mutex> lock(stripe->mutex);
+        for (auto session : stripe->sessions) {
+            session->closeAllCursors(uri);
+        }
     }
 }
 
@@ -388,21 +481,28 @@ void WiredTigerSessionCache::closeCursorsForQueuedDrops() {
     // Increment the cursor epoch so that all cursors from this epoch are closed.
     _cursorEpoch.fetchAndAdd(1);
 
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeCursorsForQueuedDrops(_engine); //WiredTigerSession::closeCursorsForQueuedDrops
+    for (auto& stripe : _stripes) {
+        stdx::lock_guard<stdx::mutex> lock(stripe->mutex);
+        for (auto session : stripe->sessions) {
+            session->closeCursorsForQueuedDrops(_engine);
+        }
     }
 }
 
 //ɾWiredTigerSession _sessions      WiredTigerSessionCache::shuttingDown
 void WiredTigerSessionCache::closeAll() {
-    // Increment the epoch as we are now closing all sessions with this epoch.
-    SessionCache swap;
+    // Increment the epoch as we are now closing all sessions with this epoch. Sessions released
+    // from now on see the new epoch and are not cached, so the stripes can be emptied one by one.
+    _epoch.fetchAndAdd(1);
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        _epoch.fetchAndAdd(1);
-        _sessions.swap(swap);
+    SessionCache swap;
+    for (auto& stripe : _stripes) {
+        SessionCache stripeSessions;
+        {
+            stdx::lock_guard<stdx::mutex> lock(stripe->mutex);
+            stripeSessions.swap(stripe->sessions);
+        }
+        swap.insert(swap.end(), stripeSessions.begin(), stripeSessions.end());
     }
 
     for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
@@ -436,14 +536,30 @@ UniqueWiredTigerSession WiredTigerSessionCache::getSession() {
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
+    // Get the most recently used session so that if we discard sessions, we're discarding older
+    // ones. Prefer this thread's own stripe, whose sessions are most likely to have the cursors
+    // this thread needs cached.
+    auto& home = _stripeForCurrentThread();
     {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        if (!_sessions.empty()) { //WiredTigerSession _sessionsΪգֱȡһ
-            // Get the most recently used session so that if we discard sessions, we're
-            // discarding older ones  
-            WiredTigerSession* cachedSession = _sessions.back();
-            _sessions.pop_back(); //WiredTigerSessionCache._sessions
-            return UniqueWiredTigerSession(cachedSession); 
+        stdx::lock_guard<stdx::mutex> lock(home.mutex);
+        if (!home.sessions.empty()) {
+            WiredTigerSession* cachedSession = home.sessions.back();
+            home.sessions.pop_back();
+            return UniqueWiredTigerSession(cachedSession);
+        }
+    }
+
+    // Never wait on another stripe's lock; a busy stripe is being used by its own threads.
+    for (auto& stripe : _stripes) {
+        if (stripe.get() == &home) {
+            continue;
+        }
+
+        stdx::unique_lock<stdx::mutex> lock(stripe->mutex, stdx::try_to_lock);
+        if (lock && !stripe->sessions.empty()) {
+            WiredTigerSession* cachedSession = stripe->sessions.back();
+            stripe->sessions.pop_back();
+            return UniqueWiredTigerSession(cachedSession);
         }
     }
 
@@ -540,10 +656,11 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
 
 	//Ѹsessioncacheûֱdrop
     if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
+        auto& stripe = _stripeForCurrentThread();
+        stdx::lock_guard<stdx::mutex> lock(stripe.mutex);
         if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
             returnedToCache = true; //
-            _sessions.push_back(session);
+            stripe.sessions.push_back(session);
         }
     } else
         invariant(session->_getEpoch() < currentEpoch);
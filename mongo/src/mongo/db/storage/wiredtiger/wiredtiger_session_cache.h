@@ -32,13 +32,16 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <wiredtiger.h>
 
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/spin_lock.h"
 
@@ -152,6 +155,7 @@ class WiredTigerSessionCache { //
 public:
     WiredTigerSessionCache(WiredTigerKVEngine* engine); //WiredTigerKVEngine::WiredTigerKVEnginenew
     WiredTigerSessionCache(WT_CONNECTION* conn);
+    WiredTigerSessionCache(WT_CONNECTION* conn, size_t numStripes);
     ~WiredTigerSessionCache();
 
     /**
@@ -201,6 +205,12 @@ public:
      */
     void waitUntilDurable(bool forceCheckpoint, bool stableCheckpoint);
 
+    /**
+     * Returns the number of callers of waitUntilDurable() which wait for a flush that has not
+     * started yet.
+     */
+    uint64_t numPendingFlushWaiters() const;
+
     WT_CONNECTION* conn() const {
         return _conn;
     }
@@ -233,12 +243,22 @@ private:
     AtomicUInt32 _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
-    stdx::mutex _cacheLock;
-
     //WiredTigerSessionCache::releaseSessionиֵ 
     //WiredTigerRecoveryUnit::_ensureSession()ֵWiredTigerRecoveryUnit._session
     typedef std::vector<WiredTigerSession*> SessionCache;
-    SessionCache _sessions; 
+
+    /**
+     * Released sessions are cached in stripes. A thread releases sessions to, and first looks for
+     * sessions in, its own stripe, so it usually gets back the session it used last together with
+     * that session's cached cursors. The per-stripe mutex is uncontended as long as there are no
+     * more concurrently running threads than stripes. A thread whose stripe is empty takes a
+     * session from any other stripe which is not busy before it opens a new session.
+     */
+    struct Stripe {
+        stdx::mutex mutex;
+        SessionCache sessions;
+    };
+    std::vector<std::unique_ptr<Stripe>> _stripes;
     
 
     // Bumped when all open sessions need to be closed
@@ -248,9 +268,28 @@ private:
     // Bumped when all open cursors need to be closed
     AtomicUInt64 _cursorEpoch;  // atomic so we can check it outside of the lock
 
-    // Counter and critical section mutex for waitUntilDurable
-    AtomicUInt32 _lastSyncTime;
-    stdx::mutex _lastSyncMutex;
+    // Group commit state for waitUntilDurable. Callers share journal flushes: the first caller to
+    // find no flush in progress leads the next one, which covers every caller that arrived before
+    // it started. The others wait until a flush started after their arrival has completed.
+    mutable stdx::mutex _flushMutex;
+    stdx::condition_variable _flushCompleted;  // Notified when a flush completes.
+    stdx::condition_variable _flushArrival;    // Notified when a caller starts waiting.
+    bool _flushInProgress = false;
+    uint64_t _flushesStarted = 0;
+    uint64_t _flushesCompleted = 0;
+    uint64_t _flushWaiters = 0;  // Callers not yet covered by a started flush.
+
+    // Moving averages of the number of callers covered by a flush and of the duration of a flush,
+    // used to size the commit delay. Guarded by _flushMutex.
+    double _avgFlushGroupSize = 1;
+    double _avgFlushMicros = 0;
+
+    /**
+     * Called by the leader of a flush with _flushMutex held. Delays the flush while more callers
+     * are expected to join it, based on recent group sizes, for no longer than a flush takes and
+     * wiredTigerGroupCommitMaxDelayMicros.
+     */
+    void _waitForFlushGroup(stdx::unique_lock<stdx::mutex>& lk);
 
     // Protects _journalListener.
     stdx::mutex _journalListenerMutex;
@@ -264,6 +303,8 @@ private:
      * session and releasing it, the session is directly released. This method is thread safe.
      */
     void releaseSession(WiredTigerSession* session);
+
+    Stripe& _stripeForCurrentThread();
 };
 
 /**
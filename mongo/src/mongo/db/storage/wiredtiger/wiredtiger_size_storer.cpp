@@ -157,7 +157,7 @@ void WiredTigerSizeStorer::onCreate(WiredTigerRecordStore* rs,
                                     long long dataSize) {
     _checkMagic();
     stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
-    Entry& entry = _entries[rs->getURI()];
+    Entry& entry = _entries[rs->getSizeStorerURI()];
     entry.rs = rs;
     entry.numRecords = numRecords;
     entry.dataSize = dataSize;
@@ -167,7 +167,7 @@ void WiredTigerSizeStorer::onCreate(WiredTigerRecordStore* rs,
 void WiredTigerSizeStorer::onDestroy(WiredTigerRecordStore* rs) {
     _checkMagic();
     stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
-    Entry& entry = _entries[rs->getURI()];
+    Entry& entry = _entries[rs->getSizeStorerURI()];
     entry.numRecords = rs->numRecords(NULL);
     entry.dataSize = rs->dataSize(NULL);
     entry.dirty = true;
@@ -0,0 +1,155 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+namespace {
+// Fractions of the cache size above which WiredTiger has application threads help with
+// eviction, which are the defaults of its eviction_trigger and eviction_dirty_trigger settings.
+const double kCacheEvictionTrigger = 0.95;
+const double kCacheDirtyEvictionTrigger = 0.20;
+}  // namespace
+
+WiredTigerTicketController::WiredTigerTicketController(WiredTigerSessionCache* sessionCache,
+                                                       TicketHolder* readTickets,
+                                                       TicketHolder* writeTickets)
+    : BackgroundJob(false /* deleteSelf */),
+      _sessionCache(sessionCache),
+      _readTickets(readTickets),
+      _writeTickets(writeTickets),
+      _lastReadsReleased(readTickets->numReleased()),
+      _lastWritesReleased(writeTickets->numReleased()) {}
+
+std::string WiredTigerTicketController::name() const {
+    return "WTTicketController";
+}
+
+void WiredTigerTicketController::run() {
+    Client::initThread(name().c_str());
+
+    LOG(1) << "starting " << name() << " thread";
+
+    while (!_shuttingDown.load()) {
+        {
+            stdx::unique_lock<stdx::mutex> lock(_mutex);
+            MONGO_IDLE_THREAD_BLOCK;
+            _condvar.wait_for(lock, stdx::chrono::seconds(1));
+        }
+        if (_shuttingDown.load()) {
+            break;
+        }
+
+        bool cachePressure = false;
+        bool dirtyCachePressure = false;
+        _getCachePressure(&cachePressure, &dirtyCachePressure);
+        adjustTickets(cachePressure, dirtyCachePressure);
+    }
+    LOG(1) << "stopping " << name() << " thread";
+}
+
+void WiredTigerTicketController::shutdown() {
+    _shuttingDown.store(true);
+    {
+        stdx::unique_lock<stdx::mutex> lock(_mutex);
+        _condvar.notify_one();
+    }
+    wait();
+}
+
+void WiredTigerTicketController::adjustTickets(bool cachePressure, bool dirtyCachePressure) {
+    AdaptiveTicketController::Observation reads;
+    const long long readsReleased = _readTickets->numReleased();
+    reads.numReleased = readsReleased - _lastReadsReleased;
+    reads.numWaiting = _readTickets->waiting();
+    reads.numUsed = _readTickets->used();
+    reads.storagePressure = cachePressure;
+    _lastReadsReleased = readsReleased;
+
+    AdaptiveTicketController::Observation writes;
+    const long long writesReleased = _writeTickets->numReleased();
+    writes.numReleased = writesReleased - _lastWritesReleased;
+    writes.numWaiting = _writeTickets->waiting();
+    writes.numUsed = _writeTickets->used();
+    writes.storagePressure = cachePressure || dirtyCachePressure;
+    _lastWritesReleased = writesReleased;
+
+    _resize(_readTickets, _readController.nextSize(_readTickets->outof(), reads), "read");
+    _resize(_writeTickets, _writeController.nextSize(_writeTickets->outof(), writes), "write");
+}
+
+void WiredTigerTicketController::_getCachePressure(bool* cachePressure, bool* dirtyCachePressure) {
+    UniqueWiredTigerSession session = _sessionCache->getSession();
+    WT_SESSION* s = session->getSession();
+
+    auto getStat = [s](int key) {
+        return WiredTigerUtil::getStatisticsValueAs<long long>(
+            s, "statistics:", "statistics=(fast)", key);
+    };
+    auto bytesMax = getStat(WT_STAT_CONN_CACHE_BYTES_MAX);
+    auto bytesInUse = getStat(WT_STAT_CONN_CACHE_BYTES_INUSE);
+    auto bytesDirty = getStat(WT_STAT_CONN_CACHE_BYTES_DIRTY);
+    if (!bytesMax.isOK() || !bytesInUse.isOK() || !bytesDirty.isOK() ||
+        bytesMax.getValue() <= 0) {
+        return;
+    }
+
+    const double cacheSize = bytesMax.getValue();
+    *cachePressure = bytesInUse.getValue() > cacheSize * kCacheEvictionTrigger;
+    *dirtyCachePressure = bytesDirty.getValue() > cacheSize * kCacheDirtyEvictionTrigger;
+}
+
+void WiredTigerTicketController::_resize(TicketHolder* holder, int newSize, StringData kind) {
+    const int oldSize = holder->outof();
+    if (newSize == oldSize) {
+        return;
+    }
+
+    // Shrinking waits for operations holding tickets to release them.
+    Status status = holder->resize(newSize);
+    if (!status.isOK()) {
+        warning() << "Failed to resize the " << kind << " tickets to " << newSize << ": "
+                  << status;
+        return;
+    }
+    LOG(1) << "Resized the " << kind << " tickets from " << oldSize << " to " << newSize;
+}
+
+}  // namespace mongo
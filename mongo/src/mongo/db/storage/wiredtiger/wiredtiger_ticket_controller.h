@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/background.h"
+#include "mongo/util/concurrency/adaptive_ticket_controller.h"
+
+namespace mongo {
+
+class TicketHolder;
+class WiredTigerSessionCache;
+
+/**
+ * Adjusts the sizes of the read and write ticket pools once per second when
+ * wiredTigerAdaptiveConcurrency is on. See AdaptiveTicketController.
+ */
+class WiredTigerTicketController : public BackgroundJob {
+    MONGO_DISALLOW_COPYING(WiredTigerTicketController);
+
+public:
+    // Bounds of the sizes chosen for the read and write ticket pools.
+    static const int kMinTickets = 16;
+    static const int kMaxTickets = 1024;
+
+    WiredTigerTicketController(WiredTigerSessionCache* sessionCache,
+                               TicketHolder* readTickets,
+                               TicketHolder* writeTickets);
+
+    std::string name() const override;
+
+    void run() override;
+
+    void shutdown();
+
+    /**
+     * Resizes the read and write ticket pools from what happened since the previous call.
+     * 'cachePressure' is whether the cache is past its eviction trigger, and 'dirtyCachePressure'
+     * whether it is past its dirty eviction trigger. Called once per second by run().
+     */
+    void adjustTickets(bool cachePressure, bool dirtyCachePressure);
+
+private:
+    /**
+     * Sets 'cachePressure' if the cache is full enough that application threads are evicting,
+     * and 'dirtyCachePressure' if the same holds for the dirty bytes in the cache.
+     */
+    void _getCachePressure(bool* cachePressure, bool* dirtyCachePressure);
+
+    void _resize(TicketHolder* holder, int newSize, StringData kind);
+
+    WiredTigerSessionCache* const _sessionCache;
+    TicketHolder* const _readTickets;
+    TicketHolder* const _writeTickets;
+
+    AdaptiveTicketController _readController{kMinTickets, kMaxTickets};
+    AdaptiveTicketController _writeController{kMinTickets, kMaxTickets};
+
+    // Values of numReleased() at the previous call to adjustTickets().
+    long long _lastReadsReleased;
+    long long _lastWritesReleased;
+
+    AtomicBool _shuttingDown{false};
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _condvar;
+};
+
+}  // namespace mongo
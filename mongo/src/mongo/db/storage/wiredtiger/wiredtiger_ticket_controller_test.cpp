@@ -0,0 +1,118 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
+
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+TEST(WiredTigerTicketControllerTest, RevertsGrowthWhenOnlyResizingAddedThroughput) {
+    TicketHolder readTickets(16);
+    TicketHolder writeTickets(16);
+    WiredTigerTicketController controller(nullptr, &readTickets, &writeTickets);
+
+    // Every read ticket is in use, 100 reads complete and one more is queued.
+    for (int i = 0; i < 16; i++) {
+        readTickets.waitForTicket();
+    }
+    for (int i = 0; i < 100; i++) {
+        readTickets.release();
+        readTickets.waitForTicket();
+    }
+    stdx::thread queuedRead([&] { readTickets.waitForTicket(); });
+    while (readTickets.waiting() == 0) {
+        sleepmillis(1);
+    }
+
+    controller.adjustTickets(false, false);
+    ASSERT_EQ(readTickets.outof(), 18);
+    ASSERT_EQ(writeTickets.outof(), 16);
+    queuedRead.join();
+    ASSERT_EQ(readTickets.numReleased(), 100);
+
+    // 101 reads complete with the larger pool, which is not enough of a gain over 100 to keep it.
+    // The tickets added by the controller itself must not make up for the difference.
+    for (int i = 0; i < 17; i++) {
+        readTickets.release();
+    }
+    for (int i = 0; i < 84; i++) {
+        readTickets.waitForTicket();
+        readTickets.release();
+    }
+
+    controller.adjustTickets(false, false);
+    ASSERT_EQ(readTickets.outof(), 16);
+    ASSERT_EQ(readTickets.numReleased(), 201);
+    ASSERT_EQ(readTickets.waiting(), 0);
+    ASSERT_EQ(writeTickets.outof(), 16);
+}
+
+#if defined(__linux__)
+// Elsewhere, resizing below the number of tickets in use fails rather than waiting for them.
+TEST(WiredTigerTicketControllerTest, ShrinkingIsNotCountedAsQueueing) {
+    TicketHolder readTickets(16);
+    TicketHolder writeTickets(16);
+    WiredTigerTicketController controller(nullptr, &readTickets, &writeTickets);
+
+    for (int i = 0; i < 16; i++) {
+        readTickets.waitForTicket();
+    }
+
+    // Backing off by a quarter under cache pressure waits for 4 of the reads to complete, which
+    // must not look like reads queueing for a ticket.
+    stdx::thread backOff([&] { controller.adjustTickets(true, false); });
+    sleepmillis(100);
+    ASSERT_EQ(readTickets.outof(), 16);
+    ASSERT_EQ(readTickets.waiting(), 0);
+
+    for (int i = 0; i < 4; i++) {
+        readTickets.release();
+    }
+    backOff.join();
+    ASSERT_EQ(readTickets.outof(), 12);
+    ASSERT_EQ(readTickets.used(), 12);
+    ASSERT_EQ(readTickets.waiting(), 0);
+    ASSERT_EQ(readTickets.numReleased(), 4);
+    ASSERT_EQ(writeTickets.outof(), 12);
+
+    for (int i = 0; i < 12; i++) {
+        readTickets.release();
+    }
+}
+#endif
+
+}  // namespace
+}  // namespace mongo
@@ -497,6 +497,69 @@ Status WiredTigerUtil::setTableLogging(WT_SESSION* session, const std::string& u
     return Status::OK();
 }
 
+Status WiredTigerUtil::truncatePrefix(WT_SESSION* session,
+                                      const std::string& uri,
+                                      int64_t prefix) {
+    WT_CURSOR* start = NULL;
+    invariantWTOK(session->open_cursor(session, uri.c_str(), NULL, NULL, &start));
+    ON_BLOCK_EXIT([&] { start->close(start); });
+    WT_CURSOR* stop = NULL;
+    invariantWTOK(session->open_cursor(session, uri.c_str(), NULL, NULL, &stop));
+    ON_BLOCK_EXIT([&] { stop->close(stop); });
+
+    const bool isIndex = strcmp(start->key_format, "qu") == 0;
+    invariant(isIndex || strcmp(start->key_format, "qq") == 0);
+
+    // Sets the smallest key that can be stored under 'keyPrefix'.
+    auto setLowestKey = [isIndex](WT_CURSOR* cursor, int64_t keyPrefix) {
+        if (isIndex) {
+            WT_ITEM empty = {};
+            cursor->set_key(cursor, keyPrefix, &empty);
+        } else {
+            cursor->set_key(cursor, keyPrefix, std::numeric_limits<int64_t>::min());
+        }
+    };
+
+    // Position 'start' on the first entry of 'prefix', if there is one.
+    setLowestKey(start, prefix);
+    int exact;
+    int ret = start->search_near(start, &exact);
+    if (ret == 0 && exact < 0) {
+        ret = start->next(start);
+    }
+    if (ret == WT_NOTFOUND) {
+        return Status::OK();
+    }
+    if (ret != 0) {
+        return wtRCToStatus(ret);
+    }
+
+    int64_t startPrefix;
+    if (isIndex) {
+        WT_ITEM item;
+        invariantWTOK(start->get_key(start, &startPrefix, &item));
+    } else {
+        int64_t recordId;
+        invariantWTOK(start->get_key(start, &startPrefix, &recordId));
+    }
+    if (startPrefix != prefix) {
+        return Status::OK();
+    }
+
+    // Position 'stop' on the last entry of 'prefix', which is the last entry before the first key
+    // of the next prefix. It can't run off the table since 'start' is before it.
+    setLowestKey(stop, prefix + 1);
+    ret = stop->search_near(stop, &exact);
+    if (ret == 0 && exact >= 0) {
+        ret = stop->prev(stop);
+    }
+    if (ret != 0) {
+        return wtRCToStatus(ret);
+    }
+
+    return wtRCToStatus(session->truncate(session, NULL, start, stop, NULL));
+}
+
 Status WiredTigerUtil::exportTableToBSON(WT_SESSION* session,
                                          const std::string& uri,
                                          const std::string& config,
@@ -225,6 +225,13 @@ public:
 
     static Status setTableLogging(WT_SESSION* session, const std::string& uri, bool on);
 
+    /**
+     * Removes every entry whose key starts with 'prefix' from the prefixed table 'uri', leaving
+     * the entries of the other prefixes sharing the table untouched. The table's key format must
+     * be "qq" (record stores) or "qu" (indexes). Runs in the current transaction of 'session'.
+     */
+    static Status truncatePrefix(WT_SESSION* session, const std::string& uri, int64_t prefix);
+
 private:
     /**
      * Casts unsigned 64-bit statistics value to T.
@@ -32,6 +32,7 @@
 
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/operation_context_noop.h"
@@ -40,8 +41,12 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -303,6 +308,114 @@ TEST(WiredTigerUtilTest, GetStatisticsValueInvalidKey) {
     ASSERT_EQUALS(ErrorCodes::NoSuchKey, result.getStatus().code());
 }
 
+TEST(WiredTigerSessionCacheTest, ThreadGetsBackTheSessionItReleased) {
+    unittest::TempDir dbpath("wt_test");
+    WiredTigerConnection connection(dbpath.path(), "");
+    WiredTigerSessionCache sessionCache(connection.getConnection(), 4);
+
+    auto first = sessionCache.getSession();
+    auto second = sessionCache.getSession();
+    ASSERT_NOT_EQUALS(first.get(), second.get());
+
+    WiredTigerSession* released = second.get();
+    first.reset();
+    second.reset();
+
+    // The session released last on this thread's stripe is handed out first.
+    auto session = sessionCache.getSession();
+    ASSERT_EQUALS(released, session.get());
+}
+
+TEST(WiredTigerSessionCacheTest, SessionsCachedByOtherThreadsAreReused) {
+    unittest::TempDir dbpath("wt_test");
+    WiredTigerConnection connection(dbpath.path(), "");
+    WiredTigerSessionCache sessionCache(connection.getConnection(), 4);
+
+    WiredTigerSession* released = nullptr;
+    stdx::thread([&] {
+        auto session = sessionCache.getSession();
+        released = session.get();
+    }).join();
+
+    auto session = sessionCache.getSession();
+    ASSERT_EQUALS(released, session.get());
+}
+
+/**
+ * Counts the flushes reported to it. While blocking, a flush does not complete until unblock().
+ */
+class BlockingJournalListener : public JournalListener {
+public:
+    Token getToken() override {
+        return Token();
+    }
+
+    void onDurable(const Token& token) override {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        ++_numFlushes;
+        _cv.notify_all();
+        _cv.wait(lk, [&] { return !_blocking; });
+    }
+
+    void waitForFlushes(int numFlushes) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [&] { return _numFlushes >= numFlushes; });
+    }
+
+    void unblock() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _blocking = false;
+        _cv.notify_all();
+    }
+
+    int numFlushes() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _numFlushes;
+    }
+
+private:
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    bool _blocking = true;
+    int _numFlushes = 0;
+};
+
+TEST(WiredTigerSessionCacheTest, WaitersBehindAFlushShareTheNextOne) {
+    unittest::TempDir dbpath("wt_test");
+    WiredTigerConnection connection(dbpath.path(), "");
+    WiredTigerSessionCache sessionCache(connection.getConnection());
+    BlockingJournalListener listener;
+    sessionCache.setJournalListener(&listener);
+
+    // Hold a flush in progress.
+    stdx::thread leader([&] { sessionCache.waitUntilDurable(false, false); });
+    listener.waitForFlushes(1);
+
+    // Waits which start during that flush are not covered by it.
+    const int kNumWaiters = 8;
+    std::vector<stdx::thread> waiters;
+    for (int i = 0; i < kNumWaiters; ++i) {
+        waiters.emplace_back([&] { sessionCache.waitUntilDurable(false, false); });
+    }
+    while (sessionCache.numPendingFlushWaiters() < static_cast<uint64_t>(kNumWaiters)) {
+        sleepmillis(1);
+    }
+    ASSERT_EQ(1, listener.numFlushes());
+
+    // All of them are covered by a single follow-up flush.
+    listener.unblock();
+    leader.join();
+    for (auto& waiter : waiters) {
+        waiter.join();
+    }
+    ASSERT_EQ(2, listener.numFlushes());
+    ASSERT_EQ(0U, sessionCache.numPendingFlushWaiters());
+
+    // A wait which starts after all others have finished always gets a flush of its own.
+    sessionCache.waitUntilDurable(false, false);
+    ASSERT_EQ(3, listener.numFlushes());
+}
+
 TEST(WiredTigerUtilTest, GetStatisticsValueValidKey) {
     WiredTigerUtilHarnessHelper harnessHelper("statistics=(all)");
     WiredTigerRecoveryUnit recoveryUnit(harnessHelper.getSessionCache(),
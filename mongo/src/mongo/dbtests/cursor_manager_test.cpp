@@ -43,10 +43,12 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -428,6 +430,89 @@ TEST_F(CursorManagerTest, CursorShouldNotTimeOutUntilIdleForLongEnoughAfterBeing
     ASSERT_EQ(0UL, cursorManager->numCursors());
 }
 
+/**
+ * Test that prefetched getMore batches are charged against the prefetch budget until they are
+ * claimed or their cursor is disposed.
+ */
+TEST_F(CursorManagerTest, PrefetchedBytesAreChargedUntilReleased) {
+    const int oldBudget = internalQueryGetMorePrefetchMaxBytes.load();
+    ON_BLOCK_EXIT([&] { internalQueryGetMorePrefetchMaxBytes.store(oldBudget); });
+    internalQueryGetMorePrefetchMaxBytes.store(100);
+
+    CursorManager* cursorManager = useCursorManager();
+    auto first = cursorManager->registerCursor(
+        _opCtx.get(), {makeFakePlanExecutor(), kTestNss, {}, false, BSONObj()});
+    auto second = cursorManager->registerCursor(
+        _opCtx.get(), {makeFakePlanExecutor(), kTestNss, {}, false, BSONObj()});
+    const CursorId firstId = first.getCursor()->cursorid();
+    const CursorId secondId = second.getCursor()->cursorid();
+
+    // A cursor can only have one prefetched batch.
+    ASSERT_EQ(80UL, CursorManager::beginPrefetch(kTestNss, firstId, 80));
+    ASSERT_EQ(0UL, CursorManager::beginPrefetch(kTestNss, firstId, 80));
+    CursorManager::endPrefetch(firstId, 60, Status::OK());
+    ASSERT_EQ(0UL, CursorManager::beginPrefetch(kTestNss, firstId, 80));
+
+    // Only the bytes actually buffered stay charged.
+    ASSERT_EQ(40UL, CursorManager::beginPrefetch(kTestNss, secondId, 80));
+    CursorManager::endPrefetch(secondId, 0, Status::OK());
+
+    // Claiming the batch returns its bytes to the budget.
+    CursorManager::waitForPrefetch(_opCtx.get(), firstId);
+    ASSERT_OK(CursorManager::releasePrefetch(firstId));
+    ASSERT_EQ(80UL, CursorManager::beginPrefetch(kTestNss, secondId, 80));
+    CursorManager::endPrefetch(secondId, 80, Status::OK());
+
+    // Disposing of the cursor does too.
+    second.deleteUnderlying();
+    ASSERT_EQ(100UL, CursorManager::beginPrefetch(kTestNss, firstId, 200));
+    CursorManager::endPrefetch(firstId, 0, Status::OK());
+}
+
+/**
+ * Test that the error a prefetch failed with is kept, with its code, for the next getMore.
+ */
+TEST_F(CursorManagerTest, PrefetchErrorIsKeptUntilReleased) {
+    CursorManager* cursorManager = useCursorManager();
+    auto pin = cursorManager->registerCursor(
+        _opCtx.get(), {makeFakePlanExecutor(), kTestNss, {}, false, BSONObj()});
+    const CursorId id = pin.getCursor()->cursorid();
+
+    ASSERT_GT(CursorManager::beginPrefetch(kTestNss, id, 80), 0UL);
+    CursorManager::endPrefetch(
+        id, 0, {ErrorCodes::ExceededTimeLimit, "operation exceeded time limit"});
+
+    // The failed prefetch still counts as the cursor's prefetch until the error is claimed.
+    ASSERT_EQ(0UL, CursorManager::beginPrefetch(kTestNss, id, 80));
+    CursorManager::waitForPrefetch(_opCtx.get(), id);
+    ASSERT_EQ(ErrorCodes::ExceededTimeLimit, CursorManager::releasePrefetch(id));
+    ASSERT_OK(CursorManager::releasePrefetch(id));
+}
+
+/**
+ * Test that the error of a failed prefetch is dropped if no getMore claims it within a cursor
+ * timeout, since the cursor it killed is gone.
+ */
+TEST_F(CursorManagerTest, UnclaimedPrefetchErrorTimesOut) {
+    CursorManager* cursorManager = useCursorManager();
+    auto pin = cursorManager->registerCursor(
+        _opCtx.get(), {makeFakePlanExecutor(), kTestNss, {}, false, BSONObj()});
+    const CursorId id = pin.getCursor()->cursorid();
+
+    // The prefetch kills the cursor, which is disposed of while the prefetch is still running.
+    ASSERT_GT(CursorManager::beginPrefetch(kTestNss, id, 80), 0UL);
+    pin.deleteUnderlying();
+    const Date_t failDate = Date_t::now();
+    CursorManager::endPrefetch(id, 0, {ErrorCodes::QueryPlanKilled, "PlanExecutor killed"});
+
+    ASSERT_EQ(0UL, CursorManager::timeoutPrefetchErrors(failDate));
+    ASSERT_EQ(0UL, CursorManager::beginPrefetch(kTestNss, id, 80));
+
+    const Date_t timeoutDate = Date_t::now() + Milliseconds(getCursorTimeoutMillis());
+    ASSERT_EQ(1UL, CursorManager::timeoutPrefetchErrors(timeoutDate));
+    ASSERT_OK(CursorManager::releasePrefetch(id));
+}
+
 /**
  * Test that cursors inherit the logical session id from their operation context
  */
@@ -30,6 +30,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/bson/json.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
@@ -40,12 +41,15 @@
 #include "mongo/db/pipeline/dependencies.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/document_source_parallel_pipeline.h"
 #include "mongo/db/pipeline/document_value_test_util.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/pipeline/pipeline_d.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/mock_yield_policies.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/stage_builder.h"
 #include "mongo/dbtests/dbtests.h"
@@ -467,5 +471,86 @@ TEST_F(DocumentSourceCursorTest, NormalCursorShouldErrorAfterBeingKilled) {
     ASSERT_THROWS_CODE(cursor->getNext().isEOF(), AssertionException, ErrorCodes::QueryPlanKilled);
 }
 
+//
+// Test running the stages following the cursor on several threads.
+//
+TEST_F(DocumentSourceCursorTest, ParallelPipelineLeavesStagesWorkersCannotRunUnsplit) {
+    const int originalThreads = internalDocumentSourceParallelPipelineThreads.load();
+    internalDocumentSourceParallelPipelineThreads.store(4);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceParallelPipelineThreads.store(originalThreads); });
+
+    for (int i = 0; i < 10; i++) {
+        client.insert(nss.ns(), BSON("_id" << i << "a" << BSON_ARRAY(i << i + 1)));
+    }
+
+    // Either the shards half of these pipelines would be empty, or it would contain a stage which
+    // only the merging thread can run.
+    const std::vector<std::vector<BSONObj>> specs = {
+        {fromjson("{$sort: {_id: 1}}")},
+        {fromjson("{$limit: 5}")},
+        {fromjson("{$match: {_id: {$gte: 2}}}"), fromjson("{$skip: 3}")},
+        {fromjson("{$unwind: '$a'}")},
+        {fromjson("{$project: {a: 1}}"), fromjson("{$sort: {_id: -1}}"), fromjson("{$limit: 2}")},
+    };
+
+    for (auto&& spec : specs) {
+        createSource();
+        auto pipeline = uassertStatusOK(Pipeline::parse(spec, ctx()));
+        pipeline->addInitialSource(source());
+        const auto serialized = pipeline->serialize();
+        const auto numSources = pipeline->getSources().size();
+
+        PipelineD::addParallelPipeline(pipeline.get());
+
+        ASSERT_TRUE(pipeline->isUnsplit());
+        ASSERT_EQ(pipeline->getSources().size(), numSources);
+        ASSERT_VALUE_EQ(Value(pipeline->serialize()), Value(serialized));
+
+        size_t numResults = 0;
+        while (pipeline->getNext()) {
+            ++numResults;
+        }
+        ASSERT_GT(numResults, 0U);
+    }
+}
+
+TEST_F(DocumentSourceCursorTest, ParallelPipelineRunsShardsHalfOnWorkers) {
+    const int originalThreads = internalDocumentSourceParallelPipelineThreads.load();
+    internalDocumentSourceParallelPipelineThreads.store(3);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceParallelPipelineThreads.store(originalThreads); });
+
+    const int numDocs = 3 * DocumentSourceParallelPipeline::kMorselSize + 11;
+    std::vector<BSONObj> docs;
+    long long expectedTotal = 0;
+    for (int i = 0; i < numDocs; i++) {
+        docs.push_back(BSON("_id" << i << "a" << i));
+        if (i % 2 == 0) {
+            expectedTotal += i;
+        }
+    }
+    client.insert(nss.ns(), docs);
+
+    createSource();
+    auto pipeline = uassertStatusOK(
+        Pipeline::parse({fromjson("{$match: {a: {$mod: [2, 0]}}}"),
+                         fromjson("{$group: {_id: null, total: {$sum: '$a'}, n: {$sum: 1}}}")},
+                        ctx()));
+    pipeline->addInitialSource(source());
+
+    PipelineD::addParallelPipeline(pipeline.get());
+
+    ASSERT_TRUE(pipeline->isUnsplit());
+    auto sources = pipeline->getSources();
+    ASSERT_EQ(sources.size(), 3U);
+    ASSERT_EQ(sources.front().get(), source());
+    ASSERT_TRUE(dynamic_cast<DocumentSourceParallelPipeline*>(std::next(sources.begin())->get()));
+
+    auto result = pipeline->getNext();
+    ASSERT_TRUE(result);
+    ASSERT_VALUE_EQ((*result)["total"], Value(expectedTotal));
+    ASSERT_VALUE_EQ((*result)["n"], Value((numDocs + 1) / 2));
+    ASSERT_FALSE(pipeline->getNext());
+}
+
 }  // namespace
 }  // namespace mongo
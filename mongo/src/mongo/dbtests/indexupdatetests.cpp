@@ -34,13 +34,18 @@
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/catalog/index_catalog_entry.h"
 #include "mongo/db/catalog/index_create.h"
 #include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index/multikey_paths.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_d.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/dbtests/dbtests.h"
 
 namespace IndexUpdateTests {
@@ -803,6 +808,195 @@ public:
     }
 };
 
+/**
+ * Fixture for foreground index builds which generate their keys on several threads. Inserts
+ * enough documents for the collection scan to hand out many batches to the key generators.
+ */
+class ParallelIndexBuildBase : public IndexBuildBase {
+public:
+    ParallelIndexBuildBase() {
+        _setMaxIndexBuildThreads(kNumThreads);
+    }
+    ~ParallelIndexBuildBase() {
+        _setMaxIndexBuildThreads(1);
+    }
+
+protected:
+    static const int kNumThreads = 4;
+    static const int kNumDocs = 5000;
+
+    void _setMaxIndexBuildThreads(int numThreads) {
+        ServerParameter* param =
+            ServerParameterSet::getGlobal()->getMap().at("maxIndexBuildThreads");
+        ASSERT_OK(param->setFromString(std::to_string(numThreads)));
+    }
+
+    /** Inserts kNumDocs documents, letting 'makeDoc' build the document with the given _id. */
+    template <typename MakeDoc>
+    void _insertDocuments(MakeDoc makeDoc) {
+        WriteUnitOfWork wunit(&_opCtx);
+        OpDebug* const nullOpDebug = nullptr;
+        for (int i = 0; i < kNumDocs; i++) {
+            ASSERT_OK(collection()->insertDocument(
+                &_opCtx, InsertStatement(makeDoc(i)), nullOpDebug, true));
+        }
+        wunit.commit();
+    }
+
+    BSONObj _indexSpec(const BSONObj& keyPattern, bool unique) {
+        return BSON("name"
+                    << "parallel"
+                    << "ns"
+                    << _ns
+                    << "key"
+                    << keyPattern
+                    << "v"
+                    << static_cast<int>(kIndexVersion)
+                    << "unique"
+                    << unique);
+    }
+
+    /** Builds the index in the foreground and commits it if all documents were indexed. */
+    Status _buildIndex(const BSONObj& spec,
+                       bool ignoreUnique = false,
+                       std::set<RecordId>* dups = nullptr) {
+        MultiIndexBlock indexer(&_opCtx, collection());
+        if (ignoreUnique)
+            indexer.ignoreUniqueConstraint();
+
+        Status status = indexer.init(spec).getStatus();
+        if (!status.isOK())
+            return status;
+        status = indexer.insertAllDocumentsInCollection(dups);
+        if (!status.isOK())
+            return status;
+
+        WriteUnitOfWork wunit(&_opCtx);
+        indexer.commit();
+        wunit.commit();
+        return Status::OK();
+    }
+
+    IndexDescriptor* _findIndex() {
+        IndexDescriptor* desc =
+            collection()->getIndexCatalog()->findIndexByName(&_opCtx, "parallel");
+        ASSERT(desc);
+        return desc;
+    }
+
+    /** Returns every key of the index in index order. */
+    std::vector<IndexKeyEntry> _indexKeys() {
+        IndexAccessMethod* iam = collection()->getIndexCatalog()->getIndex(_findIndex());
+        auto cursor = iam->newCursor(&_opCtx);
+        std::vector<IndexKeyEntry> keys;
+        for (auto kv = cursor->seek(kMinBSONKey, true); kv; kv = cursor->next()) {
+            keys.push_back(*kv);
+        }
+        return keys;
+    }
+
+    void _dropIndex() {
+        WriteUnitOfWork wunit(&_opCtx);
+        ASSERT_OK(collection()->getIndexCatalog()->dropIndex(&_opCtx, _findIndex()));
+        wunit.commit();
+    }
+};
+
+/** A parallel build of a unique index fails on a duplicate key found by any of the threads. */
+class ParallelBuildEnforceUnique : public ParallelIndexBuildBase {
+public:
+    void run() {
+        // The duplicates are several batches apart, so different threads generate their keys.
+        _insertDocuments([](int i) { return BSON("_id" << i << "a" << (i == 4500 ? 10 : i)); });
+
+        const Status status = _buildIndex(_indexSpec(BSON("a" << 1), true));
+        ASSERT_EQUALS(status.code(), ErrorCodes::DuplicateKey);
+        ASSERT_FALSE(collection()->getIndexCatalog()->findIndexByName(&_opCtx, "parallel"));
+    }
+};
+
+/** A parallel build of a unique index reports one of the duplicates rather than failing. */
+class ParallelBuildFillDups : public ParallelIndexBuildBase {
+public:
+    void run() {
+        _insertDocuments([](int i) { return BSON("_id" << i << "a" << (i == 4500 ? 10 : i)); });
+
+        std::set<RecordId> dups;
+        ASSERT_OK(_buildIndex(_indexSpec(BSON("a" << 1), true), false, &dups));
+
+        // Either document could be the duplicate, but not both.
+        ASSERT_EQUALS(dups.size(), 1U);
+        BSONObj obj = collection()->docFor(&_opCtx, *dups.begin()).value();
+        int id = obj["_id"].Int();
+        ASSERT(id == 10 || id == 4500);
+    }
+};
+
+/** A parallel build of a unique index keeps every key when told to ignore the constraint. */
+class ParallelBuildIgnoreUnique : public ParallelIndexBuildBase {
+public:
+    void run() {
+        _insertDocuments([](int i) { return BSON("_id" << i << "a" << (i == 4500 ? 10 : i)); });
+
+        ASSERT_OK(_buildIndex(_indexSpec(BSON("a" << 1), true), true));
+        ASSERT_EQUALS(_indexKeys().size(), static_cast<size_t>(kNumDocs));
+    }
+};
+
+/** The multikey paths seen by any of the threads end up in the catalog. */
+class ParallelBuildSetsMultikeyPaths : public ParallelIndexBuildBase {
+public:
+    void run() {
+        // Only a single document late in the scan has an array, and only under "a".
+        _insertDocuments([](int i) {
+            if (i == 4321)
+                return BSON("_id" << i << "a" << BSON_ARRAY(i << -i) << "b" << i);
+            return BSON("_id" << i << "a" << i << "b" << i);
+        });
+
+        ASSERT_OK(_buildIndex(_indexSpec(BSON("a" << 1 << "b" << 1), false)));
+
+        const IndexCatalogEntry* entry = collection()->getIndexCatalog()->getEntry(_findIndex());
+        ASSERT_TRUE(entry->isMultikey());
+
+        // Path-level multikey tracking is supported by every storage engine but MMAPv1.
+        if (!getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1()) {
+            const MultikeyPaths expectedPaths{{0U}, std::set<size_t>{}};
+            ASSERT_TRUE(entry->getMultikeyPaths(&_opCtx) == expectedPaths);
+        }
+        ASSERT_EQUALS(_indexKeys().size(), static_cast<size_t>(kNumDocs + 1));
+    }
+};
+
+/** A parallel build produces the same keys, in the same order, as a build on a single thread. */
+class ParallelBuildMatchesSerialBuild : public ParallelIndexBuildBase {
+public:
+    void run() {
+        // Many documents share a key, so the order of the RecordIds within a key is checked too.
+        _insertDocuments([](int i) {
+            if (i % 13 == 0)
+                return BSON("_id" << i << "a" << i % 97 << "b" << BSON_ARRAY(i % 7 << i % 11));
+            return BSON("_id" << i << "a" << i % 97 << "b" << i % 7);
+        });
+        const BSONObj spec = _indexSpec(BSON("a" << 1 << "b" << 1), false);
+
+        ASSERT_OK(_buildIndex(spec));
+        const std::vector<IndexKeyEntry> parallelKeys = _indexKeys();
+        _dropIndex();
+
+        _setMaxIndexBuildThreads(1);
+        ASSERT_OK(_buildIndex(spec));
+        const std::vector<IndexKeyEntry> serialKeys = _indexKeys();
+
+        ASSERT_EQUALS(parallelKeys.size(), serialKeys.size());
+        ASSERT_GT(serialKeys.size(), static_cast<size_t>(kNumDocs));
+        for (size_t i = 0; i < serialKeys.size(); i++) {
+            ASSERT_BSONOBJ_EQ(parallelKeys[i].key, serialKeys[i].key);
+            ASSERT_EQUALS(parallelKeys[i].loc, serialKeys[i].loc);
+        }
+    }
+};
+
 class IndexUpdateTests : public Suite {
 public:
     IndexUpdateTests() : Suite("indexupdate") {}
@@ -835,6 +1029,12 @@ public:
         add<InsertSymbolInsideNestedArrayIntoIndexWithCollationFails>();
         add<BuildingIndexWithCollationWhenSymbolDataExistsShouldFail>();
         add<IndexingSymbolWithInheritedCollationShouldFail>();
+
+        add<ParallelBuildEnforceUnique>();
+        add<ParallelBuildFillDups>();
+        add<ParallelBuildIgnoreUnique>();
+        add<ParallelBuildSetsMultikeyPaths>();
+        add<ParallelBuildMatchesSerialBuild>();
     }
 } indexUpdateTests;
 
@@ -35,6 +35,7 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/executor/connection_pool_stats.h"
 #include "mongo/executor/remote_command_request.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/destructor_guard.h"
@@ -52,6 +53,21 @@
 namespace mongo {
 namespace executor {
 
+/**
+ * One lock's worth of the connection pool: the specific pools for every host this sub-pool has
+ * served, along with the share of the connection limits that applies to each of them.
+ */
+struct ConnectionPool::SubPool {
+    SubPool(size_t index, Options options) : index(index), options(std::move(options)) {}
+
+    const size_t index;
+    const Options options;
+
+    // Guards the specific pools of this sub-pool and their generation counters
+    mutable stdx::mutex mutex;
+    stdx::unordered_map<HostAndPort, std::unique_ptr<SpecificPool>> pools;
+};
+
 /**
  * A pool for a specific HostAndPort
  *
@@ -78,7 +94,7 @@ public:
      */
     template <typename Callback>
     void runWithActiveClient(Callback&& cb) {
-        runWithActiveClient(stdx::unique_lock<stdx::mutex>(_parent->_mutex),
+        runWithActiveClient(stdx::unique_lock<stdx::mutex>(_subPool->mutex),
                             std::forward<Callback>(cb));
     }
 
@@ -90,7 +106,7 @@ public:
 
         const auto guard = MakeGuard([&] {
             invariant(!lk.owns_lock());
-            stdx::lock_guard<stdx::mutex> lk(_parent->_mutex);
+            stdx::lock_guard<stdx::mutex> lk(_subPool->mutex);
             _activeClients--;
         });
 
@@ -100,7 +116,7 @@ public:
         }
     }
 
-    SpecificPool(ConnectionPool* parent, const HostAndPort& hostAndPort);
+    SpecificPool(ConnectionPool* parent, SubPool* subPool, const HostAndPort& hostAndPort);
     ~SpecificPool();
 
     /**
@@ -125,6 +141,12 @@ public:
      */
     void returnConnection(ConnectionInterface* connection, stdx::unique_lock<stdx::mutex> lk);
 
+    /**
+     * Checks out a ready connection on behalf of a request routed to a sibling sub-pool. Returns
+     * nullptr if this pool has requests of its own waiting or no healthy ready connection.
+     */
+    ConnectionInterface* lendConnection(const stdx::unique_lock<stdx::mutex>& lk);
+
     /**
      * Returns the number of connections currently checked out of the pool.
      */
@@ -182,6 +204,8 @@ private:
 private:
     ConnectionPool* const _parent;
 
+    SubPool* const _subPool;
+
     const HostAndPort _hostAndPort;
 
 
@@ -265,26 +289,94 @@ constexpr Milliseconds ConnectionPool::kDefaultRefreshTimeout;
 const Status ConnectionPool::kConnectionStateUnknown =
     Status(ErrorCodes::InternalError, "Connection is in an unknown state");
 
+namespace {
+
+/**
+ * Returns the options for one of 'numSubPools' sub-pools, each of which gets an even share of the
+ * per-host connection limits. Shares are rounded up so that every sub-pool can open a connection.
+ */
+ConnectionPool::Options makeSubPoolOptions(ConnectionPool::Options options, size_t numSubPools) {
+    auto share = [numSubPools](size_t limit) {
+        if (limit == std::numeric_limits<size_t>::max()) {
+            return limit;
+        }
+        return limit / numSubPools + (limit % numSubPools ? 1 : 0);
+    };
+
+    options.minConnections = share(options.minConnections);
+    options.maxConnections = share(options.maxConnections);
+    options.maxConnecting = share(options.maxConnecting);
+    return options;
+}
+
+}  // namespace
+
 ConnectionPool::ConnectionPool(std::unique_ptr<DependentTypeFactoryInterface> impl,
                                std::string name,
                                Options options)
-    : _name(std::move(name)), _options(std::move(options)), _factory(std::move(impl)) {}
+    : _name(std::move(name)), _options(std::move(options)), _factory(std::move(impl)) {
+    const auto numSubPools = std::max(_options.numSubPools, size_t(1));
+    const auto subPoolOptions = makeSubPoolOptions(_options, numSubPools);
+    for (size_t i = 0; i < numSubPools; ++i) {
+        _subPools.push_back(stdx::make_unique<SubPool>(i, subPoolOptions));
+    }
+}
 
 ConnectionPool::~ConnectionPool() = default;
 
+size_t ConnectionPool::_subPoolForCurrentThread() const {
+    if (_subPools.size() == 1) {
+        return 0;
+    }
+
+    // Threads are spread round-robin across sub-pools on their first request, and keep using the
+    // same sub-pool afterwards so that their connections stay warm in it.
+    static AtomicUInt32 nextThreadSlot;
+    thread_local const unsigned threadSlot = nextThreadSlot.fetchAndAdd(1);
+    return threadSlot % _subPools.size();
+}
+
+ConnectionPool::ConnectionInterface* ConnectionPool::_borrowIdleConnection(
+    const HostAndPort& hostAndPort, size_t borrower, size_t* lender) {
+    for (size_t offset = 1; offset < _subPools.size(); ++offset) {
+        const auto index = (borrower + offset) % _subPools.size();
+        auto& subPool = *_subPools[index];
+
+        // Never wait on a sibling's lock; a busy sub-pool is unlikely to have idle connections.
+        stdx::unique_lock<stdx::mutex> lk(subPool.mutex, stdx::try_to_lock);
+        if (!lk.owns_lock()) {
+            continue;
+        }
+
+        auto iter = subPool.pools.find(hostAndPort);
+        if (iter == subPool.pools.end()) {
+            continue;
+        }
+
+        if (auto connPtr = iter->second->lendConnection(lk)) {
+            *lender = index;
+            return connPtr;
+        }
+    }
+
+    return nullptr;
+}
+
 void ConnectionPool::dropConnections(const HostAndPort& hostAndPort) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    for (auto&& subPool : _subPools) {
+        stdx::unique_lock<stdx::mutex> lk(subPool->mutex);
 
-    auto iter = _pools.find(hostAndPort);
+        auto iter = subPool->pools.find(hostAndPort);
 
-    if (iter == _pools.end())
-        return;
+        if (iter == subPool->pools.end())
+            continue;
 
-    iter->second->runWithActiveClient(std::move(lk), [&](decltype(lk) lk) {
-        iter->second->processFailure(
-            Status(ErrorCodes::PooledConnectionsDropped, "Pooled connections dropped"),
-            std::move(lk));
-    });
+        iter->second->runWithActiveClient(std::move(lk), [&](decltype(lk) lk) {
+            iter->second->processFailure(
+                Status(ErrorCodes::PooledConnectionsDropped, "Pooled connections dropped"),
+                std::move(lk));
+        });
+    }
 }
 
 //NetworkInterfaceASIO::startCommandе
@@ -293,14 +385,29 @@ void ConnectionPool::get(const HostAndPort& hostAndPort,
                          GetConnectionCallback cb) {
     SpecificPool* pool;
 
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    const auto subPoolIndex = _subPoolForCurrentThread();
+    auto& subPool = *_subPools[subPoolIndex];
+
+    stdx::unique_lock<stdx::mutex> lk(subPool.mutex);
+
+    auto iter = subPool.pools.find(hostAndPort);
+
+    // Rather than opening a new connection, use one that is sitting idle in a sibling sub-pool.
+    if (_subPools.size() > 1 &&
+        (iter == subPool.pools.end() || !iter->second->availableConnections(lk))) {
+        size_t lender;
+        if (auto connPtr = _borrowIdleConnection(hostAndPort, subPoolIndex, &lender)) {
+            lk.unlock();
+            cb(ConnectionHandle(connPtr, ConnectionHandleDeleter(this, lender)));
+            return;
+        }
+    }
 
-    auto iter = _pools.find(hostAndPort);
 	//ȡhostAndPortӦӳ
-    if (iter == _pools.end()) {
-        auto handle = stdx::make_unique<SpecificPool>(this, hostAndPort);
+    if (iter == subPool.pools.end()) {
+        auto handle = stdx::make_unique<SpecificPool>(this, &subPool, hostAndPort);
         pool = handle.get();
-        _pools[hostAndPort] = std::move(handle);
+        subPool.pools[hostAndPort] = std::move(handle);
     } else {
         pool = iter->second.get();
     }
@@ -314,44 +421,53 @@ void ConnectionPool::get(const HostAndPort& hostAndPort,
 }
 
 void ConnectionPool::appendConnectionStats(ConnectionPoolStats* stats) const {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    for (const auto& kv : _pools) {
-        HostAndPort host = kv.first;
-
-        auto& pool = kv.second;
-        ConnectionStatsPer hostStats{pool->inUseConnections(lk),
-                                     pool->availableConnections(lk),
-                                     pool->createdConnections(lk),
-                                     pool->refreshingConnections(lk)};
-        stats->updateStatsForHost(_name, host, hostStats);
+    for (const auto& subPool : _subPools) {
+        stdx::unique_lock<stdx::mutex> lk(subPool->mutex);
+
+        for (const auto& kv : subPool->pools) {
+            HostAndPort host = kv.first;
+
+            auto& pool = kv.second;
+            ConnectionStatsPer hostStats{pool->inUseConnections(lk),
+                                         pool->availableConnections(lk),
+                                         pool->createdConnections(lk),
+                                         pool->refreshingConnections(lk)};
+            stats->updateStatsForHost(_name, host, hostStats, subPool->index);
+        }
     }
 }
 
 size_t ConnectionPool::getNumConnectionsPerHost(const HostAndPort& hostAndPort) const {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-    auto iter = _pools.find(hostAndPort);
-    if (iter != _pools.end()) {
-        return iter->second->openConnections(lk);
+    size_t numConnections = 0;
+    for (const auto& subPool : _subPools) {
+        stdx::unique_lock<stdx::mutex> lk(subPool->mutex);
+        auto iter = subPool->pools.find(hostAndPort);
+        if (iter != subPool->pools.end()) {
+            numConnections += iter->second->openConnections(lk);
+        }
     }
 
-    return 0;
+    return numConnections;
 }
 
-void ConnectionPool::returnConnection(ConnectionInterface* conn) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+void ConnectionPool::returnConnection(ConnectionInterface* conn, size_t subPoolIndex) {
+    auto& subPool = *_subPools[subPoolIndex];
+    stdx::unique_lock<stdx::mutex> lk(subPool.mutex);
 
-    auto iter = _pools.find(conn->getHostAndPort());
+    auto iter = subPool.pools.find(conn->getHostAndPort());
 
-    invariant(iter != _pools.end());
+    invariant(iter != subPool.pools.end());
 
     iter->second->runWithActiveClient(std::move(lk), [&](decltype(lk) lk) {
         iter->second->returnConnection(conn, std::move(lk));
     });
 }
 
-ConnectionPool::SpecificPool::SpecificPool(ConnectionPool* parent, const HostAndPort& hostAndPort)
+ConnectionPool::SpecificPool::SpecificPool(ConnectionPool* parent,
+                                           SubPool* subPool,
+                                           const HostAndPort& hostAndPort)
     : _parent(parent),
+      _subPool(subPool),
       _hostAndPort(hostAndPort),
       _readyPool(std::numeric_limits<size_t>::max()),
       _requestTimer(parent->_factory->makeTimer()),
@@ -395,8 +511,8 @@ void ConnectionPool::SpecificPool::getConnection(const HostAndPort& hostAndPort,
                                                  Milliseconds timeout,
                                                  stdx::unique_lock<stdx::mutex> lk,
                                                  GetConnectionCallback cb) { //cbֵNetworkInterfaceASIO::startCommand
-    if (timeout < Milliseconds(0) || timeout > _parent->_options.refreshTimeout) {
-        timeout = _parent->_options.refreshTimeout;
+    if (timeout < Milliseconds(0) || timeout > _subPool->options.refreshTimeout) {
+        timeout = _subPool->options.refreshTimeout;
     }
 
     const auto expiration = _parent->_factory->now() + timeout;
@@ -411,7 +527,7 @@ void ConnectionPool::SpecificPool::getConnection(const HostAndPort& hostAndPort,
 
 void ConnectionPool::SpecificPool::returnConnection(ConnectionInterface* connPtr,
                                                     stdx::unique_lock<stdx::mutex> lk) {
-    auto needsRefreshTP = connPtr->getLastUsed() + _parent->_options.refreshRequirement;
+    auto needsRefreshTP = connPtr->getLastUsed() + _subPool->options.refreshRequirement;
 
     auto conn = takeFromPool(_checkedOutPool, connPtr);
 
@@ -438,7 +554,7 @@ void ConnectionPool::SpecificPool::returnConnection(ConnectionInterface* connPtr
         // If we need to refresh this connection
 
         if (_readyPool.size() + _processingPool.size() + _checkedOutPool.size() >=
-            _parent->_options.minConnections) {
+            _subPool->options.minConnections) {
             // If we already have minConnections, just let the connection lapse
             log() << "Ending idle connection to host " << _hostAndPort
                   << " because the pool meets constraints; " << openConnections(lk)
@@ -451,7 +567,7 @@ void ConnectionPool::SpecificPool::returnConnection(ConnectionInterface* connPtr
         // Unlock in case refresh can occur immediately
         lk.unlock();
         connPtr->refresh(
-            _parent->_options.refreshTimeout, [this](ConnectionInterface* connPtr, Status status) {
+            _subPool->options.refreshTimeout, [this](ConnectionInterface* connPtr, Status status) {
                 connPtr->indicateUsed(); //
 
                 runWithActiveClient([&](stdx::unique_lock<stdx::mutex> lk) {
@@ -513,7 +629,7 @@ void ConnectionPool::SpecificPool::addToReady(stdx::unique_lock<stdx::mutex>& lk
     // Our strategy for refreshing connections is to check them out and
     // immediately check them back in (which kicks off the refresh logic in
     // returnConnection
-    connPtr->setTimeout(_parent->_options.refreshRequirement, [this, connPtr]() {
+    connPtr->setTimeout(_subPool->options.refreshRequirement, [this, connPtr]() {
         OwnedConnection conn;
 
         runWithActiveClient([&](stdx::unique_lock<stdx::mutex> lk) {
@@ -540,6 +656,36 @@ void ConnectionPool::SpecificPool::addToReady(stdx::unique_lock<stdx::mutex>& lk
     fulfillRequests(lk);//Ӽɹ󣬼ͻϴεʱûппӣͿͨＤ
 }
 
+ConnectionPool::ConnectionInterface* ConnectionPool::SpecificPool::lendConnection(
+    const stdx::unique_lock<stdx::mutex>& lk) {
+    // Our own waiters come first; fulfillRequests() will hand them the ready connections.
+    if (_requests.size())
+        return nullptr;
+
+    while (!_readyPool.empty()) {
+        auto iter = _readyPool.begin();
+
+        auto conn = std::move(iter->second);
+        _readyPool.erase(iter);
+        conn->cancelTimeout();
+
+        if (!conn->isHealthy()) {
+            log() << "dropping unhealthy pooled connection to " << conn->getHostAndPort();
+            continue;
+        }
+
+        auto connPtr = conn.get();
+        _checkedOutPool[connPtr] = std::move(conn);
+
+        updateStateInLock();
+
+        connPtr->resetToUnknown();
+        return connPtr;
+    }
+
+    return nullptr;
+}
+
 // Drop connections and fail all requests
 void ConnectionPool::SpecificPool::processFailure(const Status& status,
                                                   stdx::unique_lock<stdx::mutex> lk) {
@@ -636,7 +782,7 @@ void ConnectionPool::SpecificPool::fulfillRequests(stdx::unique_lock<stdx::mutex
         // pass it to the user
         connPtr->resetToUnknown();
         lk.unlock();
-        cb(ConnectionHandle(connPtr, ConnectionHandleDeleter(_parent)));
+        cb(ConnectionHandle(connPtr, ConnectionHandleDeleter(_parent, _subPool->index)));
         lk.lock();
     }
 }
@@ -661,13 +807,13 @@ void ConnectionPool::SpecificPool::spawnConnections(stdx::unique_lock<stdx::mute
     // We want minConnections <= outstanding requests <= maxConnections
     auto target = [&] {
         return std::max(
-            _parent->_options.minConnections,
-            std::min(_requests.size() + _checkedOutPool.size(), _parent->_options.maxConnections));
+            _subPool->options.minConnections,
+            std::min(_requests.size() + _checkedOutPool.size(), _subPool->options.maxConnections));
     };
 
     // While all of our inflight connections are less than our target
     while ((_readyPool.size() + _processingPool.size() + _checkedOutPool.size() < target()) &&
-           (_processingPool.size() < _parent->_options.maxConnecting)) {
+           (_processingPool.size() < _subPool->options.maxConnecting)) {
         std::unique_ptr<ConnectionPool::ConnectionInterface> handle;
         try {
             // make a new connection and put it in processing
@@ -687,7 +833,7 @@ void ConnectionPool::SpecificPool::spawnConnections(stdx::unique_lock<stdx::mute
         lk.unlock();
 		//ʼ ASIOConnection::setup
         connPtr->setup(
-            _parent->_options.refreshTimeout, 
+            _subPool->options.refreshTimeout, 
             //ӽɹִлߺӦݺִУ NetworkInterfaceASIO::AsyncOp::finish
             [this](ConnectionInterface* connPtr, Status status) {
                 connPtr->indicateUsed();
@@ -722,7 +868,7 @@ void ConnectionPool::SpecificPool::spawnConnections(stdx::unique_lock<stdx::mute
 
 // Called every second after hostTimeout until all processing connections reap
 void ConnectionPool::SpecificPool::shutdown() {
-    stdx::unique_lock<stdx::mutex> lk(_parent->_mutex);
+    stdx::unique_lock<stdx::mutex> lk(_subPool->mutex);
 
     // We're racing:
     //
@@ -756,7 +902,7 @@ void ConnectionPool::SpecificPool::shutdown() {
     invariant(_requests.empty());
     invariant(_checkedOutPool.empty());
 
-    _parent->_pools.erase(_hostAndPort);
+    _subPool->pools.erase(_hostAndPort);
 }
 
 template <typename OwnershipPoolType>
@@ -840,9 +986,9 @@ void ConnectionPool::SpecificPool::updateStateInLock() {
 
         _requestTimer->cancelTimeout();
 
-        _requestTimerExpiration = _parent->_factory->now() + _parent->_options.hostTimeout;
+        _requestTimerExpiration = _parent->_factory->now() + _subPool->options.hostTimeout;
 
-        auto timeout = _parent->_options.hostTimeout;
+        auto timeout = _subPool->options.hostTimeout;
 
         // Set the shutdown timer
         _requestTimer->setTimeout(timeout, [this]() { shutdown(); });
@@ -29,6 +29,7 @@
 
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/stdx/chrono.h"
@@ -74,6 +75,7 @@ droppedProcessingPool
 class ConnectionPool {
     class ConnectionHandleDeleter;
     class SpecificPool;
+    struct SubPool;
 
 public:
     class ConnectionInterface;
@@ -133,6 +135,15 @@ public:
          * out connections or new requests
          */
         Milliseconds hostTimeout = kDefaultHostTimeout;
+
+        /**
+         * The number of independent sub-pools the connections to each host are split across.
+         * Every sub-pool has its own lock, and minConnections, maxConnections and maxConnecting
+         * are divided evenly between sub-pools, rounding up. Each calling thread is routed to
+         * one sub-pool, and borrows an idle connection from a sibling sub-pool when its own has
+         * none ready.
+         */
+        size_t numSubPools = 1;
     };
 
     explicit ConnectionPool(std::unique_ptr<DependentTypeFactoryInterface> impl,
@@ -150,7 +161,21 @@ public:
     size_t getNumConnectionsPerHost(const HostAndPort& hostAndPort) const;
 
 private:
-    void returnConnection(ConnectionInterface* connection);
+    void returnConnection(ConnectionInterface* connection, size_t subPoolIndex);
+
+    /**
+     * Returns the index of the sub-pool serving requests from the calling thread.
+     */
+    size_t _subPoolForCurrentThread() const;
+
+    /**
+     * Checks out an idle connection to 'hostAndPort' from any sub-pool other than 'borrower'
+     * whose lock is uncontended. On success, returns the connection and stores the index of the
+     * sub-pool it must be returned to in 'lender'. Returns nullptr if no idle connection was found.
+     */
+    ConnectionInterface* _borrowIdleConnection(const HostAndPort& hostAndPort,
+                                               size_t borrower,
+                                               size_t* lender);
 
     std::string _name;
 
@@ -160,23 +185,25 @@ private:
 
     const std::unique_ptr<DependentTypeFactoryInterface> _factory;
 
-    // The global mutex for specific pool access and the generation counter
-    mutable stdx::mutex _mutex;
-    stdx::unordered_map<HostAndPort, std::unique_ptr<SpecificPool>> _pools;
+    // Never empty; the sub-pools each own a lock and a set of specific pools, and are not added
+    // or removed after construction
+    std::vector<std::unique_ptr<SubPool>> _subPools;
 };
 
 class ConnectionPool::ConnectionHandleDeleter {
 public:
     ConnectionHandleDeleter() = default;
-    ConnectionHandleDeleter(ConnectionPool* pool) : _pool(pool) {}
+    ConnectionHandleDeleter(ConnectionPool* pool, size_t subPoolIndex = 0)
+        : _pool(pool), _subPoolIndex(subPoolIndex) {}
 
     void operator()(ConnectionInterface* connection) {
         if (_pool && connection)
-            _pool->returnConnection(connection);
+            _pool->returnConnection(connection, _subPoolIndex);
     }
 
 private:
     ConnectionPool* _pool = nullptr;
+    size_t _subPoolIndex = 0;
 };
 
 /**
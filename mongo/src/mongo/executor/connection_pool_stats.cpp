@@ -55,12 +55,19 @@ ConnectionStatsPer& ConnectionStatsPer::operator+=(const ConnectionStatsPer& oth
 
 void ConnectionPoolStats::updateStatsForHost(std::string pool,
                                              HostAndPort host,
-                                             ConnectionStatsPer newStats) {
+                                             ConnectionStatsPer newStats,
+                                             size_t subPool) {
     // Update stats for this host.
     statsByPool[pool] += newStats;
     statsByHost[host] += newStats;
     statsByPoolHost[pool][host] += newStats;
 
+    auto& subPoolStats = statsByPoolSubPool[pool];
+    if (subPoolStats.size() <= subPool) {
+        subPoolStats.resize(subPool + 1);
+    }
+    subPoolStats[subPool] += newStats;
+
     // Update total connection stats.
     totalInUse += newStats.inUse;
     totalAvailable += newStats.available;
@@ -83,6 +90,17 @@ void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result) {
             poolInfo.appendNumber("poolAvailable", poolStats.available);
             poolInfo.appendNumber("poolCreated", poolStats.created);
             poolInfo.appendNumber("poolRefreshing", poolStats.refreshing);
+            const auto& subPoolStats = statsByPoolSubPool[pool.first];
+            if (subPoolStats.size() > 1) {
+                BSONArrayBuilder subPoolsBuilder(poolInfo.subarrayStart("subPools"));
+                for (auto&& stats : subPoolStats) {
+                    BSONObjBuilder subPoolInfo(subPoolsBuilder.subobjStart());
+                    subPoolInfo.appendNumber("inUse", stats.inUse);
+                    subPoolInfo.appendNumber("available", stats.available);
+                    subPoolInfo.appendNumber("created", stats.created);
+                    subPoolInfo.appendNumber("refreshing", stats.refreshing);
+                }
+            }
             for (auto&& host : statsByPoolHost[pool.first]) {
                 BSONObjBuilder hostInfo(poolInfo.subobjStart(host.first.toString()));
                 auto hostStats = host.second;
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/stdx/unordered_map.h"
 #include "mongo/util/net/hostandport.h"
 
@@ -55,9 +57,15 @@ struct ConnectionStatsPer {
  * Aggregates connection information for the connPoolStats command. Connection pools should
  * use the updateStatsForHost() method to append their host-specific information to this object.
  * Total connection counts will then be updated accordingly.
+ *
+ * Pools that are split into sub-pools pass the index of the sub-pool the stats belong to, and get
+ * a per-sub-pool breakdown in addition to their usual totals.
  */
 struct ConnectionPoolStats {
-    void updateStatsForHost(std::string pool, HostAndPort host, ConnectionStatsPer newStats);
+    void updateStatsForHost(std::string pool,
+                            HostAndPort host,
+                            ConnectionStatsPer newStats,
+                            size_t subPool = 0);
 
     void appendToBSON(mongo::BSONObjBuilder& result);
 
@@ -70,6 +78,7 @@ struct ConnectionPoolStats {
     stdx::unordered_map<HostAndPort, ConnectionStatsPer> statsByHost;
     stdx::unordered_map<std::string, stdx::unordered_map<HostAndPort, ConnectionStatsPer>>
         statsByPoolHost;
+    stdx::unordered_map<std::string, std::vector<ConnectionStatsPer>> statsByPoolSubPool;
 };
 
 }  // namespace executor
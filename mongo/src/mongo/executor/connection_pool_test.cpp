@@ -34,8 +34,10 @@
 #include "mongo/executor/connection_pool_test_fixture.h"
 
 #include "mongo/executor/connection_pool.h"
+#include "mongo/executor/connection_pool_stats.h"
 #include "mongo/stdx/future.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/scopeguard.h"
 
@@ -1308,6 +1310,49 @@ TEST_F(ConnectionPoolTest, RefreshTimeoutsDontTimeoutRequests) {
     ASSERT(!conn2);
 }
 
+/**
+ * Verify that a thread routed to a sub-pool with no ready connections borrows the idle connection
+ * of a sibling sub-pool rather than opening a new one.
+ */
+TEST_F(ConnectionPoolTest, SubPoolsLendIdleConnections) {
+    ConnectionPool::Options options;
+    options.numSubPools = 2;
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test pool", options);
+
+    // Open a connection from this thread's sub-pool and return it as idle.
+    size_t conn1Id = 0;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(HostAndPort(),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 conn1Id = CONN2ID(swConn);
+                 doneWith(swConn.getValue());
+             });
+
+    // The next thread to use the pool is routed to the other sub-pool. No setup is pushed, so
+    // the request can only be served by borrowing.
+    size_t conn2Id = 0;
+    stdx::thread([&] {
+        pool.get(HostAndPort(),
+                 Milliseconds(5000),
+                 [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                     conn2Id = CONN2ID(swConn);
+                     doneWith(swConn.getValue());
+                 });
+    }).join();
+
+    ASSERT(conn1Id);
+    ASSERT_EQ(conn1Id, conn2Id);
+    ASSERT_EQ(1U, pool.getNumConnectionsPerHost(HostAndPort()));
+
+    // The borrowed connection was returned to its own sub-pool.
+    ConnectionPoolStats stats;
+    pool.appendConnectionStats(&stats);
+    ASSERT_EQ(1U, stats.totalCreated);
+    ASSERT_EQ(1U, stats.totalAvailable);
+    ASSERT_EQ(0U, stats.totalInUse);
+}
+
 }  // namespace connection_pool_test_details
 }  // namespace executor
 }  // namespace mongo
@@ -38,10 +38,12 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/query/cluster_query_knobs.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 
@@ -51,6 +53,14 @@ namespace {
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+// Ordering can only describe the directions of up to this many sort key fields. Sorts with more
+// fields than this are merged by comparing the BSON sort keys directly.
+const int kMaxKeyStringSortFields = 32;
+
+// Upper bound on the number of batches buffered or in flight for a single remote when read-ahead
+// is enabled: the batch being returned and at most one more.
+const size_t kMaxReadAheadBatches = 2;
+
 /**
  * Returns the sort key out of the $sortKey metadata field in 'obj'. This object is of the form
  * {'': 'firstSortKey', '': 'secondSortKey', ...}.
@@ -81,6 +91,17 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
       _executor(executor),
       _params(params),
       _mergeQueue(MergingComparator(_remotes, _params->sort)) {
+    // Encode sort keys as KeyStrings on arrival so the merge only has to memcmp them. This must be
+    // decided before the initial batches are buffered below.
+    if (!_params->sort.isEmpty() && _params->sort.nFields() <= kMaxKeyStringSortFields) {
+        _sortKeyOrdering = Ordering::make(_params->sort);
+        _compareKeyStrings = true;
+    }
+
+    // Tailable cursors pass each remote batch through as-is, so they never read ahead.
+    _readAhead = internalQueryAsyncResultsMergerReadAhead.load() &&
+        _params->tailableMode == TailableMode::kNormal;
+
     size_t remoteIndex = 0;
     for (const auto& remote : _params->remotes) {
         _remotes.emplace_back(remote.hostAndPort,
@@ -217,7 +238,7 @@ bool AsyncResultsMerger::_readySortedTailable(WithLock) {
     }
 
     auto smallestRemote = _mergeQueue.top();
-    auto smallestResult = _remotes[smallestRemote].docBuffer.front();
+    const auto& smallestResult = _remotes[smallestRemote].docBuffer.front().result;
     auto keyWeWantToReturn = extractSortKey(*smallestResult.getResult());
     for (const auto& remote : _remotes) {
         if (!remote.promisedMinSortKey) {
@@ -268,7 +289,7 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     return hasSort ? _nextReadySorted(lk) : _nextReadyUnsorted(lk);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock lk) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_params->tailableMode != TailableMode::kTailable);
 
@@ -282,8 +303,7 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    ClusterQueryResult front = _popBufferedResult(lk, smallestRemote);
 
     // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
     // next result.
@@ -294,15 +314,14 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     return front;
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock lk) {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
         // It is illegal to call this method if there is an error received from any shard.
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
-            _remotes[_gettingFromRemote].docBuffer.pop();
+            ClusterQueryResult front = _popBufferedResult(lk, _gettingFromRemote);
 
             if (_params->tailableMode == TailableMode::kTailable &&
                 !_remotes[_gettingFromRemote].hasNext()) {
@@ -325,6 +344,33 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
     return {};
 }
 
+ClusterQueryResult AsyncResultsMerger::_popBufferedResult(WithLock lk, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+    invariant(!remote.docBuffer.empty());
+
+    auto& buffered = remote.docBuffer.front();
+    ClusterQueryResult front = std::move(buffered.result);
+    if (buffered.endOfBatch) {
+        --remote.numBufferedBatches;
+    }
+    remote.docBuffer.pop();
+
+    // The remote may have just dropped below its read-ahead limit.
+    _scheduleReadAhead(lk, remoteIndex);
+    return front;
+}
+
+void AsyncResultsMerger::_scheduleReadAhead(WithLock lk, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+    if (!_readAhead || _lifecycleState != kAlive || !remote.status.isOK() || remote.exhausted() ||
+        remote.cbHandle.isValid() || remote.numBufferedBatches >= kMaxReadAheadBatches) {
+        return;
+    }
+
+    // Any scheduling failure is stored on the remote and reported by the next call to ready().
+    remote.status = _askForNextBatch(lk, remoteIndex);
+}
+
 Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     auto& remote = _remotes[remoteIndex];
 
@@ -403,6 +449,8 @@ StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent()
             if (!nextBatchStatus.isOK()) {
                 return nextBatchStatus;
             }
+        } else {
+            _scheduleReadAhead(lk, i);
         }
     }
 
@@ -531,8 +579,9 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
         remote.status = Status::OK();
 
         // Clear the results buffer and cursor id.
-        std::queue<ClusterQueryResult> emptyBuffer;
+        std::queue<BufferedResult> emptyBuffer;
         std::swap(remote.docBuffer, emptyBuffer);
+        remote.numBufferedBatches = 0;
         remote.cursorId = 0;
     }
 }
@@ -574,6 +623,9 @@ void AsyncResultsMerger::_processBatchResults(WithLock lk,
         // If this is normal or tailable-awaitData cursor and we still don't have anything buffered
         // after receiving this batch, we can schedule work to retrieve the next batch right away.
         remote.status = _askForNextBatch(lk, remoteIndex);
+    } else {
+        // Fetch the following batch while this one is being consumed.
+        _scheduleReadAhead(lk, remoteIndex);
     }
 }
 
@@ -582,7 +634,17 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
                                            const CursorResponse& response) {
     auto& remote = _remotes[remoteIndex];
     updateRemoteMetadata(&remote, response);
-    for (const auto& obj : response.getBatch()) {
+
+    const auto& batch = response.getBatch();
+    const bool encodeSortKeys = _compareKeyStrings && !batch.empty();
+
+    // The KeyString-encoded sort keys for the whole batch share a single buffer, and each buffered
+    // result refers to its key by offset once the buffer is complete.
+    BufBuilder sortKeyBuilder(0);
+    std::vector<int> sortKeyEnds;
+    KeyString keyString(KeyString::Version::V1);
+
+    for (const auto& obj : batch) {
         // If there's a sort, we're expecting the remote node to have given us back a sort key.
         if (!_params->sort.isEmpty() &&
             obj[ClusterClientCursorParams::kSortKeyField].type() != BSONType::Object) {
@@ -594,14 +656,40 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
             return false;
         }
 
-        ClusterQueryResult result(obj);
-        remote.docBuffer.push(result);
+        if (encodeSortKeys) {
+            keyString.resetToKey(extractSortKey(obj), _sortKeyOrdering);
+            sortKeyBuilder.appendBuf(keyString.getBuffer(), keyString.getSize());
+            sortKeyEnds.push_back(sortKeyBuilder.len());
+        }
+    }
+
+    ConstSharedBuffer sortKeyStorage;
+    if (encodeSortKeys) {
+        sortKeyStorage = sortKeyBuilder.release();
+    }
+
+    int sortKeyBegin = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        BufferedResult buffered;
+        buffered.result = ClusterQueryResult(batch[i]);
+        if (encodeSortKeys) {
+            buffered.sortKey =
+                StringData(sortKeyStorage.get() + sortKeyBegin, sortKeyEnds[i] - sortKeyBegin);
+            buffered.sortKeyStorage = sortKeyStorage;
+            sortKeyBegin = sortKeyEnds[i];
+        }
+        buffered.endOfBatch = (i + 1 == batch.size());
+        remote.docBuffer.push(std::move(buffered));
         ++remote.fetchedCount;
     }
 
+    if (!batch.empty()) {
+        ++remote.numBufferedBatches;
+    }
+
     // If we're doing a sorted merge, then we have to make sure to put this remote onto the
     // merge queue.
-    if (!_params->sort.isEmpty() && !response.getBatch().empty()) {
+    if (!_params->sort.isEmpty() && !batch.empty()) {
         _mergeQueue.push(remoteIndex);
     }
     return true;
@@ -712,11 +800,16 @@ std::shared_ptr<Shard> AsyncResultsMerger::RemoteCursorData::getShard() {
 //
 
 bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
-    const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
-    const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
+    const BufferedResult& leftDoc = _remotes[lhs].docBuffer.front();
+    const BufferedResult& rightDoc = _remotes[rhs].docBuffer.front();
+
+    // KeyStrings already encode the sort directions, so a byte comparison gives the merge order.
+    if (!leftDoc.sortKey.empty() && !rightDoc.sortKey.empty()) {
+        return leftDoc.sortKey.compare(rightDoc.sortKey) > 0;
+    }
 
-    return compareSortKeys(extractSortKey(*leftDoc.getResult()),
-                           extractSortKey(*rightDoc.getResult()),
+    return compareSortKeys(extractSortKey(*leftDoc.result.getResult()),
+                           extractSortKey(*rightDoc.result.getResult()),
                            _sort) > 0;
 }
 
@@ -34,7 +34,9 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
@@ -42,6 +44,7 @@
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/shared_buffer.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
@@ -203,6 +206,24 @@ public:
     executor::TaskExecutor::EventHandle kill(OperationContext* opCtx);
 
 private:
+    /**
+     * A result retrieved from a remote. When merging in sorted order, the result's $sortKey is
+     * encoded as a KeyString as soon as its batch arrives, so that comparing two results while
+     * merging is a single memcmp.
+     */
+    struct BufferedResult {
+        ClusterQueryResult result;
+
+        // Points into 'sortKeyStorage'. Empty if the results are not merged by KeyString.
+        StringData sortKey;
+
+        // The encoded sort keys of every result in the batch this result arrived with.
+        ConstSharedBuffer sortKeyStorage;
+
+        // Set on the last result of a batch.
+        bool endOfBatch = false;
+    };
+
     /**
      * We instantiate one of these per remote host. It contains the buffer of results we've
      * retrieved from the host but not yet returned, as well as the cursor id, and any error
@@ -253,7 +274,10 @@ private:
         HostAndPort shardHostAndPort;
 
         // The buffer of results that have been retrieved but not yet returned to the caller.
-        std::queue<ClusterQueryResult> docBuffer;
+        std::queue<BufferedResult> docBuffer;
+
+        // The number of batches with results in 'docBuffer', including the one being drained.
+        size_t numBufferedBatches = 0;
 
         // Is valid if there is currently a pending request to this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
@@ -300,6 +324,17 @@ private:
      */
     Status _askForNextBatch(WithLock, size_t remoteIndex);
 
+    /**
+     * If read-ahead is enabled and the remote has at most one batch buffered, asks the remote for
+     * its next batch so that it arrives while the buffered one drains.
+     */
+    void _scheduleReadAhead(WithLock, size_t remoteIndex);
+
+    /**
+     * Removes and returns the next buffered result of the remote at 'remoteIndex'.
+     */
+    ClusterQueryResult _popBufferedResult(WithLock, size_t remoteIndex);
+
     /**
      * Checks whether or not the remote cursors are all exhausted.
      */
@@ -396,6 +431,15 @@ private:
     // next document to return, according to the sort order. Used only if there is a sort.
     std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
 
+    // Set if the results are merged in sorted order by comparing the KeyString encodings of their
+    // sort keys. The sort pattern is then described by '_sortKeyOrdering'.
+    bool _compareKeyStrings = false;
+    Ordering _sortKeyOrdering = Ordering::make(BSONObj());
+
+    // Set if the next batch should be requested from each remote while the current one is being
+    // returned, rather than once it has been exhausted.
+    bool _readAhead = false;
+
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
     size_t _gettingFromRemote = 0;
@@ -41,6 +41,7 @@
 #include "mongo/executor/thread_pool_task_executor_test_fixture.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/client/shard_registry.h"
+#include "mongo/s/query/cluster_query_knobs.h"
 #include "mongo/s/sharding_test_fixture.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
@@ -682,6 +683,78 @@ TEST_F(AsyncResultsMergerTest, HasFirstBatch) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortedMergeAcrossTypesAndDirections) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: 1, b: -1}}");
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': null, '': 1}}"),
+                                   fromjson("{$sortKey: {'': 1.5, '': 'x'}}"),
+                                   fromjson("{$sortKey: {'': 'abc', '': 2}}")};
+    std::vector<BSONObj> batch2 = {fromjson("{$sortKey: {'': 1, '': 3}}"),
+                                   fromjson("{$sortKey: {'': 1.5, '': 7}}"),
+                                   fromjson("{$sortKey: {'': {$numberLong: '2'}, '': 0}}")};
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 0, std::move(batch1)));
+    cursors.emplace_back(
+        kTestShardIds[1], kTestShardHosts[1], CursorResponse(_nss, 0, std::move(batch2)));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    // Numbers of different types compare by value, and strings sort after numbers. Within equal
+    // values of 'a', 'b' is descending.
+    std::vector<BSONObj> expected = {fromjson("{$sortKey: {'': null, '': 1}}"),
+                                     fromjson("{$sortKey: {'': 1, '': 3}}"),
+                                     fromjson("{$sortKey: {'': 1.5, '': 'x'}}"),
+                                     fromjson("{$sortKey: {'': 1.5, '': 7}}"),
+                                     fromjson("{$sortKey: {'': {$numberLong: '2'}, '': 0}}"),
+                                     fromjson("{$sortKey: {'': 'abc', '': 2}}")};
+    for (const auto& obj : expected) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(obj, *unittest::assertGet(arm->nextReady()).getResult());
+    }
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, ReadAheadRequestsNextBatchBeforeBufferIsDrained) {
+    const bool oldReadAhead = internalQueryAsyncResultsMergerReadAhead.load();
+    internalQueryAsyncResultsMergerReadAhead.store(true);
+
+    std::vector<BSONObj> firstBatch = {fromjson("{_id: 1}"), fromjson("{_id: 2}")};
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, std::move(firstBatch)));
+    makeCursorFromExistingCursors(std::move(cursors));
+
+    // No getMore is sent until the client starts consuming the first batch.
+    ASSERT_TRUE(arm->ready());
+    network()->enterNetwork();
+    ASSERT_FALSE(network()->hasReadyRequests());
+    network()->exitNetwork();
+
+    // Returning the first result schedules the getMore while a result is still buffered.
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    auto request = getFirstPendingRequest();
+    ASSERT_EQ(unittest::assertGet(GetMoreRequest::parseFromBSON("testdb", request.cmdObj)).cursorid,
+              5);
+
+    // The next batch arrives while the client is still reading the first one.
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch = {fromjson("{_id: 3}")};
+    responses.emplace_back(_nss, CursorId(0), batch);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    ASSERT_TRUE(arm->remotesExhausted());
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+
+    internalQueryAsyncResultsMergerReadAhead.store(oldReadAhead);
+}
+
 TEST_F(AsyncResultsMergerTest, OneShardHasInitialBatchOtherShardExhausted) {
     std::vector<BSONObj> firstBatch = {
         fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}")};
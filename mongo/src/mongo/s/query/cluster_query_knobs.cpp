@@ -36,5 +36,6 @@ namespace mongo {
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryAlwaysMergeOnPrimaryShard, bool, false);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryProhibitMergingOnMongoS, bool, false);
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryAsyncResultsMergerReadAhead, bool, false);
 
 }  // namespace mongo
@@ -45,4 +45,10 @@ extern AtomicBool internalQueryAlwaysMergeOnPrimaryShard;
 // of merging on mongoS will always do so.
 extern AtomicBool internalQueryProhibitMergingOnMongoS;
 
+// If set to true on mongos, the AsyncResultsMerger requests the next batch from a remote cursor as
+// soon as the current one arrives, keeping at most one extra batch buffered or in flight per
+// shard. This hides the getMore round trip from sorted merges at the cost of reading further
+// ahead on each shard. Tailable cursors never read ahead. False by default.
+extern AtomicBool internalQueryAsyncResultsMergerReadAhead;
+
 }  // namespace mongo
@@ -99,6 +99,11 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolRefreshTimeoutMS,
                                       int,
                                       ConnectionPool::kDefaultRefreshTimeout.count());
 
+// Splits each connection pool into this many independently locked sub-pools, which share the
+// per-host limits above and lend idle connections to each other. Only worth raising on routers
+// where checkouts and returns contend on the pool lock.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolNumSubPools, int, 1);
+
 namespace {
 
 using executor::NetworkInterface;
@@ -209,6 +214,8 @@ Status initializeGlobalShardingState(OperationContext* opCtx,
     connPoolOptions.minConnections = ShardingTaskExecutorPoolMinSize;
     connPoolOptions.refreshRequirement = Milliseconds(ShardingTaskExecutorPoolRefreshRequirementMS);
     connPoolOptions.refreshTimeout = Milliseconds(ShardingTaskExecutorPoolRefreshTimeoutMS);
+    connPoolOptions.numSubPools =
+        static_cast<size_t>(std::max(ShardingTaskExecutorPoolNumSubPools, 1));
 
     if (connPoolOptions.refreshRequirement <= connPoolOptions.refreshTimeout) {
         auto newRefreshTimeout = connPoolOptions.refreshRequirement - Milliseconds(1);
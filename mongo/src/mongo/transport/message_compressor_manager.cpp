@@ -105,6 +105,13 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
         return {msg};
     }
 
+    if (msg.isSegmented()) {
+        // The compressor reads the body as one buffer.
+        Message flat = msg;
+        flat.flatten();
+        return compressMessage(flat, compressorId);
+    }
+
     LOG(3) << "Compressing message with " << compressor->getName();
 
     auto inputHeader = msg.header();
@@ -101,6 +101,10 @@ public:
         //sync߳ģʽЧ,һ󲢷ظͻ˺󣬽һʱ
         //ServiceStateMachine::_sinkCallbackֵʹãЧServiceExecutorSynchronous::schedule
         kMayYieldBeforeSchedule = 1 << 3, //ȴһȵʱ䣬´ִ
+
+        // SourceTask indicates that the task only starts receiving the next message of a session,
+        // and does no request processing, so the executor may run it on its network I/O threads.
+        kSourceTask = 1 << 4,
     };
 
     /*
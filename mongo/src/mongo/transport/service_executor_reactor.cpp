@@ -0,0 +1,263 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor;
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_reactor.h"
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/transport/service_entry_point_utils.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+// The number of threads running the network event loop. -1 means one per four cores.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(reactorServiceExecutorEventLoopThreads, int, -1);
+
+// The number of threads processing requests. -1 means two per core.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(reactorServiceExecutorWorkerThreads, int, -1);
+
+// How long an event-loop thread runs the io_context before checking for shutdown
+constexpr Milliseconds kEventLoopRunTime{1000};
+
+constexpr auto kTotalQueued = "totalQueued"_sd;
+constexpr auto kTotalExecuted = "totalExecuted"_sd;
+constexpr auto kTasksQueued = "tasksQueued"_sd;
+constexpr auto kDeferredTasksQueued = "deferredTasksQueued"_sd;
+constexpr auto kThreadsInUse = "threadsInUse"_sd;
+constexpr auto kEventLoopThreadsRunning = "eventLoopThreadsRunning"_sd;
+constexpr auto kWorkerThreadsRunning = "workerThreadsRunning"_sd;
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "reactor"_sd;
+
+int numAvailableCores() {
+    ProcessInfo pi;
+    return static_cast<int>(pi.getNumAvailableCores().value_or(pi.getNumCores()));
+}
+
+struct ServerParameterOptions : public ServiceExecutorReactor::Options {
+    int eventLoopThreads() const final {
+        int value = reactorServiceExecutorEventLoopThreads;
+        if (value <= 0) {
+            value = std::max(numAvailableCores() / 4, 1);
+        }
+        return value;
+    }
+
+    int workerThreads() const final {
+        int value = reactorServiceExecutorWorkerThreads;
+        if (value <= 0) {
+            value = std::max(numAvailableCores() * 2, 2);
+        }
+        return value;
+    }
+};
+
+}  // namespace
+
+ServiceExecutorReactor::ServiceExecutorReactor(ServiceContext* ctx,
+                                               std::shared_ptr<asio::io_context> ioCtx)
+    : ServiceExecutorReactor(ctx, std::move(ioCtx), stdx::make_unique<ServerParameterOptions>()) {}
+
+ServiceExecutorReactor::ServiceExecutorReactor(ServiceContext* ctx,
+                                               std::shared_ptr<asio::io_context> ioCtx,
+                                               std::unique_ptr<Options> config)
+    : _ioContext(std::move(ioCtx)), _config(std::move(config)) {}
+
+ServiceExecutorReactor::~ServiceExecutorReactor() {
+    invariant(!_isRunning.load());
+}
+
+Status ServiceExecutorReactor::start() {
+    invariant(!_isRunning.load());
+    _isRunning.store(true);
+
+    const auto eventLoopThreads = _config->eventLoopThreads();
+    const auto workerThreads = _config->workerThreads();
+    log() << "Starting reactor executor with " << eventLoopThreads << " event loop threads and "
+          << workerThreads << " worker threads";
+
+    for (int i = 0; i < eventLoopThreads; ++i) {
+        auto status = _startThread(str::stream() << "reactor-" << i,
+                                   &ServiceExecutorReactor::_eventLoopRoutine);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    for (int i = 0; i < workerThreads; ++i) {
+        auto status =
+            _startThread(str::stream() << "worker-" << i, &ServiceExecutorReactor::_workerRoutine);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    return Status::OK();
+}
+
+Status ServiceExecutorReactor::shutdown(Milliseconds timeout) {
+    if (!_isRunning.load())
+        return Status::OK();
+
+    {
+        // Flip the flag under the queue lock so that no worker can miss the wakeup.
+        stdx::lock_guard<stdx::mutex> lk(_queueMutex);
+        _isRunning.store(false);
+    }
+    _queueCondition.notify_all();
+
+    stdx::unique_lock<stdx::mutex> lk(_threadsMutex);
+    _ioContext->stop();
+    bool result = _deathCondition.wait_for(lk, timeout.toSystemDuration(), [&] {
+        return _eventLoopThreadsRunning.load() == 0 && _workerThreadsRunning.load() == 0;
+    });
+
+    return result
+        ? Status::OK()
+        : Status(ErrorCodes::Error::ExceededTimeLimit,
+                 "reactor executor couldn't shutdown all threads within time limit.");
+}
+
+Status ServiceExecutorReactor::schedule(Task task, ScheduleFlags flags) {
+    if (!_isRunning.load()) {
+        return {ErrorCodes::ShutdownInProgress, "Executor is not running"};
+    }
+
+    _totalQueued.addAndFetch(1);
+
+    // A source task only starts the next non-blocking read on a session, so it is run by the
+    // event loop instead of waking up a worker. Every other task, including the deferred Process
+    // tasks of exhaust cursors, may block and goes to the workers.
+    if (flags & kSourceTask) {
+        _deferredTasksQueued.addAndFetch(1);
+        _ioContext->post([ this, task = std::move(task) ] {
+            _deferredTasksQueued.subtractAndFetch(1);
+            task();
+            _totalExecuted.addAndFetch(1);
+        });
+        return Status::OK();
+    }
+
+    _tasksQueued.addAndFetch(1);
+    {
+        stdx::lock_guard<stdx::mutex> lk(_queueMutex);
+        _workerQueue.push_back(std::move(task));
+    }
+    _queueCondition.notify_one();
+
+    return Status::OK();
+}
+
+Status ServiceExecutorReactor::_startThread(std::string name, ThreadRoutine routine) {
+    auto& counter = (routine == &ServiceExecutorReactor::_eventLoopRoutine)
+        ? _eventLoopThreadsRunning
+        : _workerThreadsRunning;
+    counter.addAndFetch(1);
+
+    auto status = launchServiceWorkerThread([ this, name = std::move(name), routine, &counter ] {
+        setThreadName(name);
+
+        const auto guard = MakeGuard([this, &counter] {
+            stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+            counter.subtractAndFetch(1);
+            _deathCondition.notify_one();
+        });
+
+        (this->*routine)();
+    });
+
+    if (!status.isOK()) {
+        warning() << "Failed to launch new reactor executor thread: " << status;
+        counter.subtractAndFetch(1);
+    }
+    return status;
+}
+
+void ServiceExecutorReactor::_eventLoopRoutine() {
+    while (_isRunning.load()) {
+        try {
+            asio::io_context::work work(*_ioContext);
+            _ioContext->run_for(kEventLoopRunTime.toSystemDuration());
+
+            // run_for() returns immediately once the io_context has been stopped, until it is
+            // restarted.
+            if (_ioContext->stopped())
+                _ioContext->restart();
+        } catch (std::exception& e) {
+            log() << "Exception escaped event loop thread: " << e.what();
+        }
+    }
+}
+
+void ServiceExecutorReactor::_workerRoutine() {
+    while (true) {
+        Task task;
+        {
+            stdx::unique_lock<stdx::mutex> lk(_queueMutex);
+            _queueCondition.wait(lk, [&] { return !_workerQueue.empty() || !_isRunning.load(); });
+
+            // Outstanding tasks are dropped on shutdown.
+            if (!_isRunning.load())
+                return;
+
+            task = std::move(_workerQueue.front());
+            _workerQueue.pop_front();
+        }
+
+        _tasksQueued.subtractAndFetch(1);
+        _threadsInUse.addAndFetch(1);
+        task();
+        _threadsInUse.subtractAndFetch(1);
+        _totalExecuted.addAndFetch(1);
+    }
+}
+
+void ServiceExecutorReactor::appendStats(BSONObjBuilder* bob) const {
+    BSONObjBuilder section(bob->subobjStart("serviceExecutorTaskStats"));
+    section << kExecutorLabel << kExecutorName                                //
+            << kTotalQueued << _totalQueued.load()                            //
+            << kTotalExecuted << _totalExecuted.load()                        //
+            << kTasksQueued << _tasksQueued.load()                            //
+            << kDeferredTasksQueued << _deferredTasksQueued.load()            //
+            << kThreadsInUse << _threadsInUse.load()                          //
+            << kEventLoopThreadsRunning << _eventLoopThreadsRunning.load()    //
+            << kWorkerThreadsRunning << _workerThreadsRunning.load();
+    section.doneFast();
+}
+
+}  // namespace transport
+}  // namespace mongo
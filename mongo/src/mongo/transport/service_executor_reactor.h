@@ -0,0 +1,119 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/service_executor.h"
+
+#include <asio.hpp>
+
+namespace mongo {
+namespace transport {
+
+/**
+ * An event-loop based ServiceExecutor for servers with many mostly idle connections.
+ *
+ * A small, fixed number of event-loop threads run the transport layer's io_context, so sockets
+ * are only ever read and written without blocking and all I/O completions are handled there.
+ * Source tasks, which just start the next read on a session, run on the event loop as well.
+ * Every other task processes a request and is handed to a fixed-size pool of worker threads. The
+ * number of threads therefore does not grow with the number of connections, and an idle
+ * connection costs no thread at all.
+ *
+ * A request that blocks for a long time, such as an awaitData getMore, holds a worker for its
+ * whole duration, so the worker pool must be sized for the expected number of such requests.
+ */
+class ServiceExecutorReactor final : public ServiceExecutor {
+public:
+    struct Options {
+        virtual ~Options() = default;
+
+        virtual int eventLoopThreads() const = 0;
+
+        virtual int workerThreads() const = 0;
+    };
+
+    explicit ServiceExecutorReactor(ServiceContext* ctx, std::shared_ptr<asio::io_context> ioCtx);
+    explicit ServiceExecutorReactor(ServiceContext* ctx,
+                                    std::shared_ptr<asio::io_context> ioCtx,
+                                    std::unique_ptr<Options> config);
+
+    ~ServiceExecutorReactor();
+
+    Status start() final;
+    Status shutdown(Milliseconds timeout) final;
+    Status schedule(Task task, ScheduleFlags flags) final;
+
+    Mode transportMode() const final {
+        return Mode::kAsynchronous;
+    }
+
+    void appendStats(BSONObjBuilder* bob) const final;
+
+private:
+    using ThreadRoutine = void (ServiceExecutorReactor::*)();
+
+    Status _startThread(std::string name, ThreadRoutine routine);
+
+    void _eventLoopRoutine();
+    void _workerRoutine();
+
+    std::shared_ptr<asio::io_context> _ioContext;
+    std::unique_ptr<Options> _config;
+
+    AtomicWord<bool> _isRunning{false};
+
+    // Tasks waiting for a worker thread. Guarded by _queueMutex, and workers wait on
+    // _queueCondition for new tasks or shutdown.
+    stdx::mutex _queueMutex;
+    stdx::condition_variable _queueCondition;
+    std::deque<Task> _workerQueue;
+
+    // Signalled by the last thread to exit, with _threadsMutex held
+    mutable stdx::mutex _threadsMutex;
+    stdx::condition_variable _deathCondition;
+
+    AtomicWord<int> _eventLoopThreadsRunning{0};
+    AtomicWord<int> _workerThreadsRunning{0};
+    AtomicWord<int> _threadsInUse{0};
+    AtomicWord<int> _tasksQueued{0};
+    AtomicWord<int> _deferredTasksQueued{0};
+    AtomicWord<int64_t> _totalQueued{0};
+    AtomicWord<int64_t> _totalExecuted{0};
+};
+
+}  // namespace transport
+}  // namespace mongo
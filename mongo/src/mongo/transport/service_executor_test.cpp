@@ -34,8 +34,10 @@
 
 #include "mongo/db/service_context_noop.h"
 #include "mongo/transport/service_executor_adaptive.h"
+#include "mongo/transport/service_executor_reactor.h"
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 
@@ -93,6 +95,31 @@ protected:
     std::shared_ptr<asio::io_context> asioIOCtx;
 };
 
+struct ReactorTestOptions : public ServiceExecutorReactor::Options {
+    int eventLoopThreads() const final {
+        return 1;
+    }
+
+    int workerThreads() const final {
+        return 2;
+    }
+};
+
+class ServiceExecutorReactorFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        auto scOwned = stdx::make_unique<ServiceContextNoop>();
+        setGlobalServiceContext(std::move(scOwned));
+        asioIOCtx = std::make_shared<asio::io_context>();
+
+        executor = stdx::make_unique<ServiceExecutorReactor>(
+            getGlobalServiceContext(), asioIOCtx, stdx::make_unique<ReactorTestOptions>());
+    }
+
+    std::unique_ptr<ServiceExecutorReactor> executor;
+    std::shared_ptr<asio::io_context> asioIOCtx;
+};
+
 class ServiceExecutorSynchronousFixture : public unittest::Test {
 protected:
     void setUp() override {
@@ -134,6 +161,56 @@ TEST_F(ServiceExecutorAdaptiveFixture, ScheduleFailsBeforeStartup) {
     scheduleBasicTask(executor.get(), false);
 }
 
+TEST_F(ServiceExecutorReactorFixture, BasicTaskRuns) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    scheduleBasicTask(executor.get(), true);
+}
+
+/**
+ * Schedules a task with 'flags' on 'exec' and returns the name of the thread it ran on.
+ */
+std::string nameOfThreadRunningTask(ServiceExecutor* exec, ServiceExecutor::ScheduleFlags flags) {
+    stdx::condition_variable cond;
+    stdx::mutex mutex;
+    boost::optional<std::string> threadName;
+    auto task = [&] {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        threadName = getThreadName().toString();
+        cond.notify_all();
+    };
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    ASSERT_OK(exec->schedule(std::move(task), flags));
+    cond.wait(lk, [&] { return threadName.is_initialized(); });
+    return *threadName;
+}
+
+TEST_F(ServiceExecutorReactorFixture, SourceTaskRunsOnEventLoop) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    ASSERT_EQ(nameOfThreadRunningTask(executor.get(),
+                                      ServiceExecutor::kDeferredTask | ServiceExecutor::kSourceTask),
+              "reactor-0");
+}
+
+TEST_F(ServiceExecutorReactorFixture, ExhaustProcessTaskRunsOnWorker) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    // The ServiceStateMachine schedules the next Process task of an exhaust cursor as deferred,
+    // but it processes a request, so it must not run on the event loop.
+    auto threadName = nameOfThreadRunningTask(
+        executor.get(), ServiceExecutor::kDeferredTask | ServiceExecutor::kMayYieldBeforeSchedule);
+    ASSERT_STRING_CONTAINS(threadName, "worker-");
+}
+
+TEST_F(ServiceExecutorReactorFixture, ScheduleFailsBeforeStartup) {
+    scheduleBasicTask(executor.get(), false);
+}
+
 TEST_F(ServiceExecutorSynchronousFixture, BasicTaskRuns) {
     ASSERT_OK(executor->start());
     auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
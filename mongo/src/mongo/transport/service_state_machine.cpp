@@ -479,9 +479,13 @@ void ServiceStateMachine::_sinkCallback(Status status) {
 	//_scheduleCondition֪ͨcontrol߳
 
 	//ӶӦһmongoѾӦɣҪҪһε
-    return _scheduleNextWithGuard(std::move(guard),
-                                  ServiceExecutor::kDeferredTask |
-                                      ServiceExecutor::kMayYieldBeforeSchedule);
+    // In exhaust mode the next task processes the next response, so only a task returning to the
+    // Source state is a source task.
+    auto flags = ServiceExecutor::kDeferredTask | ServiceExecutor::kMayYieldBeforeSchedule;
+    if (!_inExhaust) {
+        flags |= ServiceExecutor::kSourceTask;
+    }
+    return _scheduleNextWithGuard(std::move(guard), flags);
 }
 
 /*
@@ -571,7 +575,8 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
     } else {
         _state.store(State::Source);
         _inMessage.reset();
-        return _scheduleNextWithGuard(std::move(guard), ServiceExecutor::kDeferredTask);
+        return _scheduleNextWithGuard(
+            std::move(guard), ServiceExecutor::kDeferredTask | ServiceExecutor::kSourceTask);
     }
 }
 
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <utility>
+#include <vector>
 
 #include "mongo/base/system_error.h"
 #include "mongo/config.h"
@@ -231,6 +232,39 @@ private:
         //LOG(0) << "yang test ....2..... opportunisticRead:" << size;
     }
 
+    /**
+     * Returns 'buffers' with the first 'size' bytes removed, so that a partially completed
+     * opportunistic write can be resumed asynchronously.
+     */
+    template <typename ConstBufferSequence>
+    static ConstBufferSequence consumeBuffers(const ConstBufferSequence& buffers, size_t size) {
+        ConstBufferSequence out(buffers);
+        if (size > 0) {
+            out += size;
+        }
+        return out;
+    }
+
+    /**
+     * Gather writes of segmented messages pass a vector of buffers; buffers which were written
+     * out completely are dropped and the first partially written one is advanced.
+     */
+    static std::vector<asio::const_buffer> consumeBuffers(
+        const std::vector<asio::const_buffer>& buffers, size_t size) {
+        std::vector<asio::const_buffer> out;
+        out.reserve(buffers.size());
+        for (const auto& buffer : buffers) {
+            const auto bufferSize = asio::buffer_size(buffer);
+            if (size >= bufferSize) {
+                size -= bufferSize;
+                continue;
+            }
+            out.push_back(buffer + size);
+            size = 0;
+        }
+        return out;
+    }
+
     template <typename Stream, typename ConstBufferSequence, typename CompleteHandler>
     void opportunisticWrite(bool sync,
                             Stream& stream,
@@ -250,10 +284,7 @@ private:
             // asio::write is a loop internally, so some of buffers may have been read into already.
             // So we need to adjust the buffers passed into async_write to be offset by size, if
             // size is > 0.
-            ConstBufferSequence asyncBuffers(buffers);
-            if (size > 0) {
-                asyncBuffers += size;
-                }
+            auto asyncBuffers = consumeBuffers(buffers, size);
             //LOG(0) << "yang test ......... opportunisticWrite";
             //ݵöȡhandlerصִмasiowrite_op::operator
             asio::async_write(stream, asyncBuffers, std::forward<CompleteHandler>(handler));
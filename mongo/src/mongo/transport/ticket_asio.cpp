@@ -198,6 +198,21 @@ void TransportLayerASIO::ASIOSinkTicket::fillImpl() {
         return;
 
 	// TransportLayerASIO::ASIOSession::write
+    if (_msgToSend.isSegmented()) {
+        // Hand the head buffer and every segment to a single gather write, so that reply
+        // documents referenced by the message are sent without first being copied together.
+        std::vector<asio::const_buffer> buffers;
+        buffers.reserve(_msgToSend.segments().size() + 1);
+        buffers.push_back(asio::buffer(_msgToSend.buf(), _msgToSend.headSize()));
+        for (const auto& segment : _msgToSend.segments()) {
+            buffers.push_back(asio::buffer(segment.data, segment.size));
+        }
+        session->write(isSync(), buffers, [this](const std::error_code& ec, size_t size) {
+            _sinkCallback(ec, size);
+        });
+        return;
+    }
+
     session->write(isSync(),
 	   asio::buffer(_msgToSend.buf(), _msgToSend.size()),
 	   //ݳɹcallbackص
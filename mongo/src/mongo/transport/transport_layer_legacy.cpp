@@ -163,7 +163,14 @@ Ticket TransportLayerLegacy::sinkMessage(const SessionHandle& session,
                                          Date_t expiration) {
     auto sinkCb = [&message](AbstractMessagingPort* amp) -> Status {
         try {
-            amp->say(message);
+            if (message.isSegmented()) {
+                // Legacy ports send from a single buffer.
+                Message flat = message;
+                flat.flatten();
+                amp->say(flat);
+            } else {
+                amp->say(message);
+            }
             networkCounter.hitPhysicalOut(message.size());
 
             return Status::OK();
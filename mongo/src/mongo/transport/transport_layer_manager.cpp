@@ -35,6 +35,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/service_executor_adaptive.h"
+#include "mongo/transport/service_executor_reactor.h"
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer_asio.h"
@@ -154,7 +155,7 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
         transport::TransportLayerASIO::Options opts(config);
 
 		//ͬʽ첽ʽĬsynchronous
-        if (config->serviceExecutor == "adaptive") {
+        if (config->serviceExecutor == "adaptive" || config->serviceExecutor == "reactor") {
 			//̬̳߳ģ,Ҳ첽ģʽ
             opts.transportMode = transport::Mode::kAsynchronous;
         } else if (config->serviceExecutor == "synchronous") {
@@ -172,6 +173,9 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
 			//춯̬߳ģͶӦִServiceExecutorAdaptive
             ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorAdaptive>(
                 ctx, transportLayerASIO->getIOContext()));
+        } else if (config->serviceExecutor == "reactor") {
+            ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorReactor>(
+                ctx, transportLayerASIO->getIOContext()));
         } else if (config->serviceExecutor == "synchronous") { //ͬʽ
         	//һһ߳ģͶӦִServiceExecutorSynchronous
             ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorSynchronous>(ctx));
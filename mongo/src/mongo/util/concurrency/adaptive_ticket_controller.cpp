@@ -0,0 +1,77 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/adaptive_ticket_controller.h"
+
+#include <algorithm>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+constexpr double AdaptiveTicketController::kMinThroughputGain;
+constexpr double AdaptiveTicketController::kBackoffFraction;
+constexpr double AdaptiveTicketController::kGrowthFraction;
+
+AdaptiveTicketController::AdaptiveTicketController(int minTickets, int maxTickets)
+    : _minTickets(minTickets), _maxTickets(maxTickets) {
+    invariant(0 < _minTickets && _minTickets <= _maxTickets);
+}
+
+int AdaptiveTicketController::nextSize(int currentTickets, const Observation& observation) {
+    const long long throughput = observation.numReleased;
+    const long long lastThroughput = _lastThroughput;
+    const int sizeBeforeLastChange = _sizeBeforeLastChange;
+    _lastThroughput = throughput;
+    _sizeBeforeLastChange = 0;
+
+    int next = currentTickets;
+    if (observation.storagePressure) {
+        // Admitting fewer operations lets the storage engine catch up, rather than having every
+        // admitted operation help with eviction.
+        next -= std::max(1, static_cast<int>(currentTickets * kBackoffFraction));
+    } else if (sizeBeforeLastChange > 0 && lastThroughput >= 0 &&
+               throughput < lastThroughput * (1 + kMinThroughputGain)) {
+        // The last change did not pay off. Return to the previous size if it was smaller, and
+        // hold otherwise, since shrinking the pool is expected to lower throughput.
+        next = std::min(currentTickets, sizeBeforeLastChange);
+    } else if (observation.numWaiting > 0 && observation.numUsed >= currentTickets) {
+        // Every ticket is in use and operations are queued: probe with a larger pool.
+        next += std::max(1, static_cast<int>(currentTickets * kGrowthFraction));
+    }
+
+    next = std::max(_minTickets, std::min(_maxTickets, next));
+    if (next != currentTickets) {
+        _sizeBeforeLastChange = currentTickets;
+    }
+    return next;
+}
+
+}  // namespace mongo
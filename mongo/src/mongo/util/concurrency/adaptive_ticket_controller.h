@@ -0,0 +1,91 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+namespace mongo {
+
+/**
+ * Decides the size of a TicketHolder from what was observed while running with its current size,
+ * at regular intervals. Not thread-safe; meant to be driven by a single background thread.
+ *
+ * The controller grows the pool while operations queue for tickets and throughput keeps
+ * improving, and backs off when the storage engine reports pressure or when growing the pool did
+ * not make the admitted operations complete faster. By Little's law, more tickets without more
+ * throughput only means more latency for each operation.
+ */
+class AdaptiveTicketController {
+public:
+    /**
+     * What happened during the last interval.
+     */
+    struct Observation {
+        // Tickets released during the interval, i.e. operations completed.
+        long long numReleased = 0;
+
+        // Threads waiting for a ticket at the end of the interval.
+        int numWaiting = 0;
+
+        // Tickets in use at the end of the interval.
+        int numUsed = 0;
+
+        // Whether the storage engine is struggling to keep up, e.g. its cache needs eviction by
+        // application threads.
+        bool storagePressure = false;
+    };
+
+    // A change of size is kept only if throughput improved by at least this fraction.
+    static constexpr double kMinThroughputGain = 0.02;
+
+    // Fraction of the pool removed when backing off because of storage pressure.
+    static constexpr double kBackoffFraction = 0.25;
+
+    // Fraction of the pool added when operations are queued.
+    static constexpr double kGrowthFraction = 0.125;
+
+    AdaptiveTicketController(int minTickets, int maxTickets);
+
+    /**
+     * Returns the number of tickets to use for the next interval, given the number
+     * 'currentTickets' used during the interval described by 'observation'.
+     */
+    int nextSize(int currentTickets, const Observation& observation);
+
+private:
+    const int _minTickets;
+    const int _maxTickets;
+
+    // Throughput measured during the previous interval, or -1 if unknown.
+    long long _lastThroughput = -1;
+
+    // Number of tickets before the last change made by this controller, or 0 if the last interval
+    // did not change it.
+    int _sizeBeforeLastChange = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,90 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/adaptive_ticket_controller.h"
+
+namespace mongo {
+namespace {
+
+AdaptiveTicketController::Observation observe(long long numReleased,
+                                              int numWaiting,
+                                              int numUsed,
+                                              bool storagePressure = false) {
+    AdaptiveTicketController::Observation observation;
+    observation.numReleased = numReleased;
+    observation.numWaiting = numWaiting;
+    observation.numUsed = numUsed;
+    observation.storagePressure = storagePressure;
+    return observation;
+}
+
+TEST(AdaptiveTicketControllerTest, HoldsSizeWhenNothingIsQueued) {
+    AdaptiveTicketController controller(8, 512);
+    ASSERT_EQ(controller.nextSize(128, observe(1000, 0, 40)), 128);
+    ASSERT_EQ(controller.nextSize(128, observe(1200, 0, 128)), 128);
+}
+
+TEST(AdaptiveTicketControllerTest, GrowsWhileThroughputImproves) {
+    AdaptiveTicketController controller(8, 512);
+    ASSERT_EQ(controller.nextSize(128, observe(1000, 10, 128)), 144);
+    ASSERT_EQ(controller.nextSize(144, observe(1100, 10, 144)), 162);
+}
+
+TEST(AdaptiveTicketControllerTest, RevertsGrowthWhichDidNotImproveThroughput) {
+    AdaptiveTicketController controller(8, 512);
+    ASSERT_EQ(controller.nextSize(128, observe(1000, 10, 128)), 144);
+    ASSERT_EQ(controller.nextSize(144, observe(1000, 10, 144)), 128);
+
+    // Throughput dropped back after the revert, which must not trigger another change.
+    ASSERT_EQ(controller.nextSize(128, observe(990, 10, 128)), 128);
+}
+
+TEST(AdaptiveTicketControllerTest, BacksOffUnderStoragePressure) {
+    AdaptiveTicketController controller(8, 512);
+    ASSERT_EQ(controller.nextSize(128, observe(1000, 10, 128, true)), 96);
+    ASSERT_EQ(controller.nextSize(96, observe(800, 10, 96, true)), 72);
+
+    // Lower throughput after backing off is expected, and does not grow the pool back at once.
+    ASSERT_EQ(controller.nextSize(72, observe(700, 10, 72)), 72);
+}
+
+TEST(AdaptiveTicketControllerTest, StaysWithinBounds) {
+    AdaptiveTicketController controller(8, 130);
+    ASSERT_EQ(controller.nextSize(128, observe(1000, 10, 128)), 130);
+    ASSERT_EQ(controller.nextSize(130, observe(2000, 10, 130)), 130);
+
+    AdaptiveTicketController other(8, 512);
+    ASSERT_EQ(other.nextSize(9, observe(1000, 10, 9, true)), 8);
+    ASSERT_EQ(other.nextSize(8, observe(1000, 10, 8, true)), 8);
+}
+
+}  // namespace
+}  // namespace mongo
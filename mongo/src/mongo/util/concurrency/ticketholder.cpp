@@ -35,6 +35,7 @@
 
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -88,6 +89,15 @@ wiredtiger
 */
 //LockerImpl<IsForMMAPV1>::_lockGlobalBeginе
 void TicketHolder::waitForTicket() { 
+    if (tryAcquire())
+        return;
+
+    _numWaiting.fetchAndAdd(1);
+    _waitForTicket();
+    _numWaiting.subtractAndFetch(1);
+}
+
+void TicketHolder::_waitForTicket() {
     while (0 != sem_wait(&_sem)) {
         if (errno != EINTR)
             _check(-1);
@@ -100,6 +110,11 @@ bool TicketHolder::waitForTicketUntil(Date_t until) {
 
     ts.tv_sec = millisSinceEpoch / 1000;
     ts.tv_nsec = (millisSinceEpoch % 1000) * (1000 * 1000);
+    if (tryAcquire())
+        return true;
+
+    _numWaiting.fetchAndAdd(1);
+    ON_BLOCK_EXIT([&] { _numWaiting.subtractAndFetch(1); });
     while (0 != sem_timedwait(&_sem, &ts)) {
         if (errno == ETIMEDOUT)
             return false;
@@ -111,6 +126,11 @@ bool TicketHolder::waitForTicketUntil(Date_t until) {
 }
 
 void TicketHolder::release() {
+    _numReleased.fetchAndAdd(1);
+    _release();
+}
+
+void TicketHolder::_release() {
     _check(sem_post(&_sem));
 }
 
@@ -130,12 +150,12 @@ Status TicketHolder::resize(int newSize) {
                                     << newSize);
 
     while (_outof.load() < newSize) {
-        release();
+        _release();
         _outof.fetchAndAdd(1);
     }
 
     while (_outof.load() > newSize) {
-        waitForTicket();
+        _waitForTicket();
         _outof.subtractAndFetch(1);
     }
 
@@ -175,18 +195,29 @@ bool TicketHolder::tryAcquire() {
 void TicketHolder::waitForTicket() {
     stdx::unique_lock<stdx::mutex> lk(_mutex);
 
+    if (_tryAcquire())
+        return;
+
+    _numWaiting.fetchAndAdd(1);
     while (!_tryAcquire()) {
         _newTicket.wait(lk);
     }
+    _numWaiting.subtractAndFetch(1);
 }
 
 bool TicketHolder::waitForTicketUntil(Date_t until) {
     stdx::unique_lock<stdx::mutex> lk(_mutex);
 
+    if (_tryAcquire())
+        return true;
+
+    _numWaiting.fetchAndAdd(1);
+    ON_BLOCK_EXIT([&] { _numWaiting.subtractAndFetch(1); });
     return _newTicket.wait_until(lk, until.toSystemTimePoint(), [this] { return _tryAcquire(); });
 }
 
 void TicketHolder::release() {
+    _numReleased.fetchAndAdd(1);
     {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
         _num++;
@@ -239,4 +270,12 @@ bool TicketHolder::_tryAcquire() {
     return true;
 }
 #endif
+
+int TicketHolder::waiting() const {
+    return _numWaiting.load();
+}
+
+long long TicketHolder::numReleased() const {
+    return _numReleased.load();
+}
 }
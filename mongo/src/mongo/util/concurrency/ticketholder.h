@@ -63,8 +63,28 @@ public:
 
     int outof() const;
 
+    /**
+     * Number of threads blocked in waitForTicket() or waitForTicketUntil().
+     */
+    int waiting() const;
+
+    /**
+     * Number of tickets released since construction, that is how many operations completed while
+     * holding a ticket. Used to measure the throughput of the operations admitted by this holder.
+     * Tickets added by resize() are not counted.
+     */
+    long long numReleased() const;
+
 private:
+    AtomicInt32 _numWaiting;
+    AtomicInt64 _numReleased;
+
 #if defined(__linux__)
+    // Give and take tickets for resize(), which neither counts as a release nor as waiting, so
+    // that the counters only reflect the operations using the tickets.
+    void _release();
+    void _waitForTicket();
+
     //ź
     mutable sem_t _sem;
 
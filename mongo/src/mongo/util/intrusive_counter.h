@@ -35,6 +35,7 @@
 #include "mongo/base/string_data.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/util/allocator.h"
+#include "mongo/util/operation_arena.h"
 
 namespace mongo {
 
@@ -137,7 +138,7 @@ public:
 #pragma warning(push)
 #pragma warning(disable : 4291)
     void operator delete(void* ptr) {
-        free(ptr);
+        OperationArena::deallocate(ptr);
     }
 #pragma warning(pop)
 
@@ -145,7 +146,7 @@ private:
     // these can only be created by calling create()
     RCString(){};
     void* operator new(size_t objSize, size_t realSize) {
-        return mongoMalloc(realSize);
+        return OperationArena::allocate(realSize);
     }
 
     int _size;  // does NOT include trailing NUL byte.
@@ -30,6 +30,9 @@
 
 #include "mongo/util/net/message.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "mongo/platform/atomic_word.h"
 
 namespace mongo {
@@ -42,4 +45,85 @@ int32_t nextMessageId() {
     return NextMsgId.fetchAndAdd(1);
 }
 
+void Message::flatten() {
+    if (!isSegmented())
+        return;
+
+    const size_t total = size();
+    SharedBuffer flat = SharedBuffer::allocate(total);
+    char* out = flat.get();
+    const size_t head = headSize();
+    memcpy(out, _buf.get(), head);
+    out += head;
+    for (const auto& segment : _segments) {
+        memcpy(out, segment.data, segment.size);
+        out += segment.size;
+    }
+    invariant(out == flat.get() + total);
+
+    _buf = std::move(flat);
+    _segments.clear();
+    _segmentsSize = 0;
+}
+
+constexpr size_t MessageGatherBuilder::kMaxChunkSize;
+
+char* MessageGatherBuilder::_grow(size_t len) {
+    if (_chunkLen + len > _chunkCapacity) {
+        if (_chunkLen > 0 && _chunkLen + len > kMaxChunkSize) {
+            _finishChunk();
+        }
+
+        const size_t needed = _chunkLen + len;
+        const size_t doubled = std::max(_chunkCapacity * 2, _initialSize);
+        const size_t newCapacity = std::max(needed, std::min(doubled, kMaxChunkSize));
+        _chunk.realloc(newCapacity);
+        _chunkCapacity = newCapacity;
+    }
+
+    char* out = _chunk.get() + _chunkLen;
+    _chunkLen += len;
+    _len += len;
+    return out;
+}
+
+void MessageGatherBuilder::_finishChunk() {
+    if (!_head) {
+        // The first chunk holds the header and is never split, so it becomes the message buffer.
+        _head = std::move(_chunk);
+    } else if (_chunkLen > 0) {
+        const char* data = _chunk.get();
+        _segments.push_back({ConstSharedBuffer(std::move(_chunk)), data, _chunkLen});
+    }
+
+    _chunk = {};
+    _chunkLen = 0;
+    _chunkCapacity = 0;
+}
+
+void MessageGatherBuilder::appendReference(ConstSharedBuffer owner, const char* data, size_t len) {
+    invariant(_head || _chunkLen > 0);
+    if (!len)
+        return;
+
+    _finishChunk();
+    _segments.push_back({std::move(owner), data, len});
+    _len += len;
+}
+
+Message MessageGatherBuilder::release() {
+    _finishChunk();
+
+    Message msg(std::move(_head));
+    for (auto& segment : _segments) {
+        msg.appendSegment(std::move(segment));
+    }
+    invariant(static_cast<size_t>(msg.size()) == _len);
+
+    _head = {};
+    _segments.clear();
+    _len = 0;
+    return msg;
+}
+
 }  // namespace mongo
@@ -29,11 +29,13 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
 #include "mongo/base/encoded_value_storage.h"
 #include "mongo/base/static_assert.h"
+#include "mongo/util/shared_buffer.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -454,6 +456,17 @@ class Message {
 public:
     Message() = default;
     explicit Message(SharedBuffer data) : _buf(std::move(data)) {}
+
+    /**
+     * A read-only span of bytes which follows the contiguous head buffer on the wire. The span
+     * keeps its owning buffer alive, so reply documents can be sent straight out of the buffers
+     * that already hold them instead of being copied into the reply.
+     */
+    struct Segment {
+        ConstSharedBuffer owner;
+        const char* data;
+        size_t size;
+    };
     //ͷheader
     MsgData::View header() const {
         verify(!empty());
@@ -490,8 +503,46 @@ public:
     //buf
     void reset() {
         _buf = {};
+        _segments.clear();
+        _segmentsSize = 0;
+    }
+
+    /**
+     * A segmented message carries its header and leading bytes in buf() and the rest of its body
+     * in segments(), in order. The length in the header always covers the whole message. Only the
+     * transport send path writes segments out directly; any other code which needs the message
+     * body as a single buffer must call flatten() first.
+     */
+    bool isSegmented() const {
+        return !_segments.empty();
+    }
+
+    const std::vector<Segment>& segments() const {
+        return _segments;
+    }
+
+    /**
+     * Number of bytes held in buf(). Equal to size() unless the message is segmented.
+     */
+    size_t headSize() const {
+        return size() - _segmentsSize;
+    }
+
+    /**
+     * Appends a segment after the existing contents. The header length must already account for
+     * the segment's bytes.
+     */
+    void appendSegment(Segment segment) {
+        verify(!empty());
+        _segmentsSize += segment.size;
+        _segments.push_back(std::move(segment));
     }
 
+    /**
+     * Copies the head buffer and all segments into a single buffer. No-op if not segmented.
+     */
+    void flatten();
+
     // use to set first buffer if empty
     //_bufֱʹbufռ
     void setData(SharedBuffer buf) {
@@ -533,6 +584,80 @@ public:
 private:
     //Žݵbuf
     SharedBuffer _buf;
+
+    std::vector<Segment> _segments;
+    size_t _segmentsSize = 0;
+};
+
+/**
+ * Builds a message whose small pieces are copied into chunked head storage and whose large,
+ * already-owned pieces are referenced as segments. Copied bytes are never grown past
+ * kMaxChunkSize by reallocation; once a chunk is full a new one is started and appended as a
+ * segment, so building a large reply does not repeatedly copy what was already written.
+ *
+ * Usage mirrors BufBuilder: skip() the header, append the body, fill in the header through
+ * headerBuf() and then release() the finished Message.
+ */
+class MessageGatherBuilder {
+    MessageGatherBuilder(const MessageGatherBuilder&) = delete;
+    MessageGatherBuilder& operator=(const MessageGatherBuilder&) = delete;
+
+public:
+    static constexpr size_t kMaxChunkSize = 1024 * 1024;
+
+    explicit MessageGatherBuilder(size_t initialSize = 512) : _initialSize(initialSize) {}
+
+    /**
+     * Reserves 'n' copied bytes and returns a pointer to them.
+     */
+    char* skip(size_t n) {
+        return _grow(n);
+    }
+
+    void appendBuf(const void* src, size_t len) {
+        if (len)
+            memcpy(_grow(len), src, len);
+    }
+
+    /**
+     * Appends 'len' bytes at 'data' without copying them. 'owner' must hold 'data'.
+     */
+    void appendReference(ConstSharedBuffer owner, const char* data, size_t len);
+
+    /**
+     * Total number of bytes appended so far, copied and referenced.
+     */
+    int len() const {
+        return static_cast<int>(_len);
+    }
+
+    /**
+     * Start of the first chunk, where the message header lives once skip()ped.
+     */
+    char* headerBuf() {
+        return _head ? _head.get() : _chunk.get();
+    }
+
+    /**
+     * Returns the built message. The header length must have been set to len() beforehand. The
+     * builder is left empty.
+     */
+    Message release();
+
+private:
+    char* _grow(size_t len);
+    void _finishChunk();
+
+    const size_t _initialSize;
+
+    SharedBuffer _head;
+    std::vector<Message::Segment> _segments;
+
+    SharedBuffer _chunk;
+    size_t _chunkLen = 0;
+    size_t _chunkCapacity = 0;
+
+    size_t _len = 0;
 };
 
 /**
@@ -0,0 +1,115 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+namespace {
+
+const int kHeaderSize = MsgData::MsgDataHeaderSize;
+
+void setHeader(MessageGatherBuilder* builder) {
+    MsgData::View header = builder->headerBuf();
+    header.setLen(builder->len());
+    header.setOperation(dbMsg);
+}
+
+std::string messageBytes(Message msg) {
+    msg.flatten();
+    return std::string(msg.buf(), msg.size());
+}
+
+TEST(MessageGatherBuilder, SmallMessageIsContiguous) {
+    MessageGatherBuilder builder;
+    builder.skip(kHeaderSize);
+    builder.appendBuf("abc", 3);
+    setHeader(&builder);
+
+    auto msg = builder.release();
+    ASSERT_FALSE(msg.isSegmented());
+    ASSERT_EQ(msg.size(), kHeaderSize + 3);
+    ASSERT_EQ(std::string(msg.singleData().data(), 3), "abc");
+    ASSERT_EQ(builder.len(), 0);
+}
+
+TEST(MessageGatherBuilder, ReferencesAreNotCopied) {
+    auto owner = SharedBuffer::allocate(5);
+    memcpy(owner.get(), "hello", 5);
+
+    MessageGatherBuilder builder;
+    builder.skip(kHeaderSize);
+    builder.appendBuf("ab", 2);
+    builder.appendReference(owner, owner.get(), 5);
+    builder.appendBuf("cd", 2);
+    setHeader(&builder);
+
+    auto msg = builder.release();
+    ASSERT_TRUE(msg.isSegmented());
+    ASSERT_EQ(msg.segments().size(), 2U);
+    ASSERT_EQ(msg.segments()[0].data, owner.get());
+    ASSERT_EQ(msg.headSize(), static_cast<size_t>(kHeaderSize + 2));
+    ASSERT_EQ(msg.size(), kHeaderSize + 9);
+
+    auto bytes = messageBytes(msg);
+    ASSERT_EQ(bytes.substr(kHeaderSize), "abhellocd");
+
+    // Flattening a copy leaves the original untouched.
+    ASSERT_TRUE(msg.isSegmented());
+}
+
+TEST(MessageGatherBuilder, LargeCopiesAreChunked) {
+    const std::string piece(100 * 1024, 'x');
+    const size_t numPieces = 3 * MessageGatherBuilder::kMaxChunkSize / piece.size();
+
+    MessageGatherBuilder builder;
+    builder.skip(kHeaderSize);
+    for (size_t i = 0; i < numPieces; ++i) {
+        builder.appendBuf(piece.data(), piece.size());
+    }
+    setHeader(&builder);
+
+    auto msg = builder.release();
+    ASSERT_TRUE(msg.isSegmented());
+    ASSERT_LTE(msg.headSize(), MessageGatherBuilder::kMaxChunkSize);
+    for (const auto& segment : msg.segments()) {
+        ASSERT_LTE(segment.size, MessageGatherBuilder::kMaxChunkSize);
+    }
+
+    msg.flatten();
+    ASSERT_FALSE(msg.isSegmented());
+    ASSERT_EQ(static_cast<size_t>(msg.size()), kHeaderSize + numPieces * piece.size());
+    ASSERT_EQ(std::string(msg.singleData().data(), piece.size()), piece);
+}
+
+}  // namespace
+}  // namespace mongo
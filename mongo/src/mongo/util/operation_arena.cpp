@@ -0,0 +1,189 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/operation_arena.h"
+
+#include <cstdlib>
+#include <new>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/allocator.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+thread_local OperationArena* currentArena = nullptr;
+
+// Chunks, from all arenas, which have not been returned to the heap.
+AtomicInt64 liveChunkCount;
+
+// The owning arena's hold on a chunk. Frees can never outnumber the allocations of a chunk, so
+// while the arena holds the chunk its live count cannot drop to zero.
+const int64_t kArenaReference = int64_t(1) << 40;
+
+}  // namespace
+
+/**
+ * The header of each chunk. Allocations follow it in the same block of memory.
+ */
+class OperationArena::Chunk {
+public:
+    static Chunk* create() {
+        liveChunkCount.fetchAndAdd(1);
+        return new (mongoMalloc(kChunkBytes)) Chunk();
+    }
+
+    char* begin() {
+        return reinterpret_cast<char*>(this) + sizeof(Chunk);
+    }
+
+    char* end() {
+        return reinterpret_cast<char*>(this) + kChunkBytes;
+    }
+
+    /**
+     * Drops 'count' references and frees the chunk if none remain.
+     */
+    void release(int64_t count) {
+        if (_live.subtractAndFetch(count) == 0) {
+            this->~Chunk();
+            std::free(this);
+            liveChunkCount.fetchAndSubtract(1);
+        }
+    }
+
+private:
+    Chunk() : _live(kArenaReference) {}
+
+    AtomicInt64 _live;
+};
+
+/**
+ * Prefixes every allocation. 'chunk' is null for allocations that came from the heap.
+ */
+struct OperationArena::AllocationHeader {
+    Chunk* chunk;
+};
+
+OperationArena::Scope::Scope(OperationArena* arena) : _arena(arena), _previous(currentArena) {
+    if (_arena) {
+        currentArena = _arena;
+    }
+}
+
+OperationArena::Scope::~Scope() {
+    if (_arena) {
+        _arena->retireChunk();
+        currentArena = _previous;
+    }
+}
+
+OperationArena::HeapScope::HeapScope() : _previous(currentArena) {
+    currentArena = nullptr;
+}
+
+OperationArena::HeapScope::~HeapScope() {
+    currentArena = _previous;
+}
+
+OperationArena::~OperationArena() {
+    invariant(currentArena != this);
+    retireChunk();
+}
+
+OperationArena* OperationArena::current() {
+    return currentArena;
+}
+
+size_t OperationArena::numLiveChunks() {
+    return static_cast<size_t>(liveChunkCount.load());
+}
+
+void* OperationArena::allocate(size_t bytes) {
+    static_assert(sizeof(AllocationHeader) == kAlignment,
+                  "the allocation header must preserve alignment");
+
+    const size_t totalBytes = sizeof(AllocationHeader) + bytes;
+    if (currentArena && totalBytes <= kMaxArenaAllocationBytes) {
+        return currentArena->_allocate(totalBytes);
+    }
+
+    auto header = static_cast<AllocationHeader*>(mongoMalloc(totalBytes));
+    header->chunk = nullptr;
+    return header + 1;
+}
+
+void OperationArena::deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    auto header = static_cast<AllocationHeader*>(ptr) - 1;
+    if (header->chunk) {
+        header->chunk->release(1);
+    } else {
+        std::free(header);
+    }
+}
+
+void* OperationArena::_allocate(size_t totalBytes) {
+    totalBytes = (totalBytes + kAlignment - 1) & ~(kAlignment - 1);
+    if (static_cast<size_t>(_end - _next) < totalBytes) {
+        retireChunk();
+        _chunk = Chunk::create();
+        _next = _chunk->begin();
+        _end = _chunk->end();
+        ++_numChunksAllocated;
+    }
+
+    auto header = reinterpret_cast<AllocationHeader*>(_next);
+    header->chunk = _chunk;
+    _next += totalBytes;
+    ++_numAllocationsInChunk;
+    return header + 1;
+}
+
+void OperationArena::retireChunk() {
+    if (!_chunk) {
+        return;
+    }
+
+    // Trade the arena's reference for one per allocation made from the chunk.
+    Chunk* chunk = _chunk;
+    const int64_t numAllocations = _numAllocationsInChunk;
+    _chunk = nullptr;
+    _next = _end = nullptr;
+    _numAllocationsInChunk = 0;
+    chunk->release(kArenaReference - numAllocations);
+}
+
+}  // namespace mongo
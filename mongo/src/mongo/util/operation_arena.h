@@ -0,0 +1,155 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+/**
+ * A bump allocator for the small, short-lived objects an operation creates while it produces a
+ * batch of results, such as document storage, Value strings and arrays, and WorkingSetMembers.
+ *
+ * Memory is carved sequentially out of large chunks, and every allocation is prefixed with a
+ * pointer to the chunk it came from. Freeing an allocation does not make its memory reusable;
+ * instead, each chunk counts its live allocations and is returned to the heap as a whole once the
+ * arena has retired it and its last allocation has been freed. Objects created during a batch may
+ * outlive it, for example a document buffered by $group or a member of a cursor's WorkingSet, so
+ * a chunk holding such an object stays allocated until the object is destroyed.
+ *
+ * Types opt in by routing their operator new and operator delete through allocate() and
+ * deallocate(). These use the arena made current on the calling thread by a Scope, or the heap if
+ * there is none, so opted-in types behave as before outside of a Scope. Memory allocated from an
+ * arena may be freed on any thread, and after the arena itself has been destroyed.
+ *
+ * Since a single live object keeps its whole chunk allocated, code which builds up state that
+ * outlives the batch, such as the blocking phase of $group or $sort, should run under a HeapScope.
+ *
+ * Allocations are aligned to 8 bytes.
+ */
+class OperationArena {
+    MONGO_DISALLOW_COPYING(OperationArena);
+
+public:
+    // The size of each chunk, including its header.
+    static constexpr size_t kChunkBytes = 64 * 1024;
+
+    // Larger allocations always come from the heap, so that a single chunk holds many objects.
+    static constexpr size_t kMaxArenaAllocationBytes = 4 * 1024;
+
+    static constexpr size_t kAlignment = 8;
+
+    /**
+     * Makes an arena current on this thread for the lifetime of the Scope, and retires the
+     * arena's chunk when the Scope ends. A null 'arena' leaves allocations on the heap.
+     */
+    class Scope {
+        MONGO_DISALLOW_COPYING(Scope);
+
+    public:
+        explicit Scope(OperationArena* arena);
+        ~Scope();
+
+    private:
+        OperationArena* const _arena;
+        OperationArena* const _previous;
+    };
+
+    /**
+     * Makes allocations on this thread come from the heap for the lifetime of the HeapScope, even
+     * within a Scope.
+     */
+    class HeapScope {
+        MONGO_DISALLOW_COPYING(HeapScope);
+
+    public:
+        HeapScope();
+        ~HeapScope();
+
+    private:
+        OperationArena* const _previous;
+    };
+
+    OperationArena() = default;
+    ~OperationArena();
+
+    /**
+     * Allocates 'bytes' from the arena current on this thread, or from the heap.
+     */
+    static void* allocate(size_t bytes);
+
+    /**
+     * Frees memory returned by allocate().
+     */
+    static void deallocate(void* ptr);
+
+    /**
+     * Returns the arena current on this thread, or nullptr if there is none.
+     */
+    static OperationArena* current();
+
+    /**
+     * Stops allocating from the current chunk. Its memory is released once everything allocated
+     * from it has been freed.
+     */
+    void retireChunk();
+
+    /**
+     * Returns the number of chunks, from all arenas, which have not been returned to the heap.
+     */
+    static size_t numLiveChunks();
+
+    /**
+     * Returns the number of chunks this arena has allocated over its lifetime.
+     */
+    size_t numChunksAllocated() const {
+        return _numChunksAllocated;
+    }
+
+private:
+    class Chunk;
+    struct AllocationHeader;
+
+    void* _allocate(size_t bytes);
+
+    Chunk* _chunk = nullptr;
+    char* _next = nullptr;
+    char* _end = nullptr;
+
+    // Allocations made from '_chunk' since it was started. Only this arena allocates from its
+    // chunk, so this count is not shared and is settled with the chunk in retireChunk().
+    int64_t _numAllocationsInChunk = 0;
+
+    size_t _numChunksAllocated = 0;
+};
+
+}  // namespace mongo
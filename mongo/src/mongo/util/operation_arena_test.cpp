@@ -0,0 +1,194 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/operation_arena.h"
+
+#include <cstring>
+#include <vector>
+
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(OperationArenaTest, AllocatesFromHeapWithoutScope) {
+    OperationArena arena;
+    void* ptr = OperationArena::allocate(32);
+    ASSERT(ptr);
+    ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(ptr) % OperationArena::kAlignment);
+    OperationArena::deallocate(ptr);
+    ASSERT_EQ(0U, arena.numChunksAllocated());
+}
+
+TEST(OperationArenaTest, NullScopeIsNoOp) {
+    OperationArena::Scope scope(nullptr);
+    ASSERT_FALSE(OperationArena::current());
+    OperationArena::deallocate(OperationArena::allocate(16));
+}
+
+TEST(OperationArenaTest, AllocatesFromCurrentArena) {
+    OperationArena arena;
+    {
+        OperationArena::Scope scope(&arena);
+        ASSERT_EQ(&arena, OperationArena::current());
+
+        char* first = static_cast<char*>(OperationArena::allocate(13));
+        char* second = static_cast<char*>(OperationArena::allocate(8));
+        ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(second) % OperationArena::kAlignment);
+        ASSERT_GT(second, first);
+        ASSERT_EQ(1U, arena.numChunksAllocated());
+
+        memset(first, 'a', 13);
+        memset(second, 'b', 8);
+        OperationArena::deallocate(first);
+        OperationArena::deallocate(second);
+    }
+    ASSERT_FALSE(OperationArena::current());
+}
+
+TEST(OperationArenaTest, LargeAllocationsUseHeap) {
+    OperationArena arena;
+    OperationArena::Scope scope(&arena);
+    void* ptr = OperationArena::allocate(OperationArena::kMaxArenaAllocationBytes);
+    ASSERT_EQ(0U, arena.numChunksAllocated());
+    OperationArena::deallocate(ptr);
+}
+
+TEST(OperationArenaTest, StartsNewChunkWhenFull) {
+    OperationArena arena;
+    OperationArena::Scope scope(&arena);
+
+    std::vector<void*> allocations;
+    for (size_t i = 0; i < 2 * OperationArena::kChunkBytes / 1024; ++i) {
+        allocations.push_back(OperationArena::allocate(1024));
+    }
+    ASSERT_GTE(arena.numChunksAllocated(), 2U);
+
+    for (auto&& ptr : allocations) {
+        OperationArena::deallocate(ptr);
+    }
+}
+
+TEST(OperationArenaTest, AllocationsOutliveScopeAndArena) {
+    std::vector<char*> allocations;
+    {
+        OperationArena arena;
+        OperationArena::Scope scope(&arena);
+        for (int i = 0; i < 100; ++i) {
+            char* ptr = static_cast<char*>(OperationArena::allocate(64));
+            memset(ptr, i, 64);
+            allocations.push_back(ptr);
+        }
+    }
+
+    // The retired chunk stays allocated until its last allocation is freed, on any thread.
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(static_cast<char>(i), allocations[i][63]);
+    }
+    stdx::thread([&] {
+        for (auto&& ptr : allocations) {
+            OperationArena::deallocate(ptr);
+        }
+    }).join();
+}
+
+TEST(OperationArenaTest, HeapScopeSuspendsCurrentArena) {
+    OperationArena arena;
+    OperationArena::Scope scope(&arena);
+    {
+        OperationArena::HeapScope heapScope;
+        ASSERT_FALSE(OperationArena::current());
+        OperationArena::deallocate(OperationArena::allocate(16));
+        ASSERT_EQ(0U, arena.numChunksAllocated());
+    }
+    ASSERT_EQ(&arena, OperationArena::current());
+}
+
+TEST(OperationArenaTest, SurvivorKeepsItsChunkAlive) {
+    const size_t liveChunksBefore = OperationArena::numLiveChunks();
+    void* survivor;
+    {
+        OperationArena arena;
+        OperationArena::Scope scope(&arena);
+        survivor = OperationArena::allocate(64);
+        OperationArena::deallocate(OperationArena::allocate(64));
+    }
+    ASSERT_EQ(liveChunksBefore + 1, OperationArena::numLiveChunks());
+
+    OperationArena::deallocate(survivor);
+    ASSERT_EQ(liveChunksBefore, OperationArena::numLiveChunks());
+}
+
+TEST(OperationArenaTest, ChunksAreReclaimedWhenSurvivorsUseHeapScope) {
+    const size_t liveChunksBefore = OperationArena::numLiveChunks();
+    std::vector<char*> survivors;
+    {
+        OperationArena arena;
+        OperationArena::Scope scope(&arena);
+
+        // Spread a few long-lived objects over several chunks' worth of short-lived ones.
+        std::vector<void*> transients;
+        for (size_t i = 0; i < 4 * OperationArena::kChunkBytes / 1024; ++i) {
+            transients.push_back(OperationArena::allocate(1024));
+            if (i % 50 == 0) {
+                OperationArena::HeapScope heapScope;
+                survivors.push_back(static_cast<char*>(OperationArena::allocate(64)));
+                memset(survivors.back(), 'x', 64);
+            }
+        }
+        ASSERT_GTE(arena.numChunksAllocated(), 4U);
+
+        for (auto&& ptr : transients) {
+            OperationArena::deallocate(ptr);
+        }
+    }
+
+    // Every chunk went back to the heap even though the survivors are still alive.
+    ASSERT_EQ(liveChunksBefore, OperationArena::numLiveChunks());
+    for (auto&& ptr : survivors) {
+        ASSERT_EQ('x', ptr[63]);
+        OperationArena::deallocate(ptr);
+    }
+}
+
+TEST(OperationArenaTest, ScopesNest) {
+    OperationArena outer;
+    OperationArena inner;
+    OperationArena::Scope outerScope(&outer);
+    {
+        OperationArena::Scope innerScope(&inner);
+        ASSERT_EQ(&inner, OperationArena::current());
+    }
+    ASSERT_EQ(&outer, OperationArena::current());
+}
+
+}  // namespace
+}  // namespace mongo